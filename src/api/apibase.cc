@@ -7,33 +7,32 @@
 #include "apibase.h"
 
 void
-ApiBase::check_node (xmlNodePtr node)
+ApiBase::check_node (XmlReader& reader)
 {
-  if (!this->locally_cached
-      && !xmlStrcmp(node->name, (xmlChar const*)"currentTime"))
+  if (!this->locally_cached && reader.is_element("currentTime"))
   {
-    std::string text = this->get_node_text(node);
+    std::string text = this->get_node_text(reader);
     EveTime::init_from_eveapi_string(text);
   }
 
-  if (!xmlStrcmp(node->name, (xmlChar const*)"cachedUntil"))
+  if (reader.is_element("cachedUntil"))
   {
-    this->cached_until = this->get_node_text(node);
+    this->cached_until = this->get_node_text(reader);
     this->cached_until_t = EveTime::get_time_for_string(this->cached_until);
   }
 
-  if (!xmlStrcmp(node->name, (xmlChar const*)"error"))
+  if (reader.is_element("error"))
   {
     std::string error;
     std::string text;
 
     try
-    { error = this->get_property(node, "code"); }
+    { error = this->get_property(reader, "code"); }
     catch (...)
     { error = "<unknown>"; }
 
     try
-    { text = this->get_node_text(node); }
+    { text = this->get_node_text(reader); }
     catch (...)
     { text = "<unknown>"; }
 
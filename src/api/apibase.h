@@ -45,7 +45,7 @@ class ApiBase : public XmlBase
 
     /* Extracts some common information like errors,
      * the EVE time and the cache time. */
-    void check_node (xmlNodePtr node);
+    void check_node (XmlReader& reader);
 
     /* Sets cached_until and cached_until_t with respect
      * to min_cache_time to ensure a minimum cache time.
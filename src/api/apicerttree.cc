@@ -1,4 +1,3 @@
-#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -6,11 +5,35 @@
 #include "util/os.h"
 #include "util/helpers.h"
 #include "util/exception.h"
+#include "util/snapshot.h"
 #include "bits/config.h"
 #include "xml.h"
 #include "apicerttree.h"
 
 #define CERTTREE_FN "CertificateTree.xml"
+#define CERTTREE_SNAPSHOT_FN "CertificateTree.snapshot"
+/* Increment whenever the layout of the snapshot changes. */
+#define CERTTREE_SNAPSHOT_VERSION 1
+
+/*
+ * Sections of the certificate tree snapshot. Categories are stored as
+ * (ID, name), classes as (ID, name, category index) and certificates as
+ * (ID, grade, description, class index) followed by the ranges of their
+ * skill and certificate dependencies, which are (ID, level) pairs.
+ */
+enum CertTreeSnapshotSection
+{
+  CERTTREE_SNAP_CATEGORIES,
+  CERTTREE_SNAP_CLASSES,
+  CERTTREE_SNAP_CERTS,
+  CERTTREE_SNAP_SKILLDEPS,
+  CERTTREE_SNAP_CERTDEPS,
+  CERTTREE_SNAP_SECTIONS
+};
+
+#define CERTTREE_SNAP_CATEGORY_WORDS 2
+#define CERTTREE_SNAP_CLASS_WORDS 3
+#define CERTTREE_SNAP_CERT_WORDS 8
 
 ApiCertTreePtr ApiCertTree::instance;
 
@@ -21,8 +44,9 @@ ApiCertTree::request (void)
 {
   if (ApiCertTree::instance.get() == 0)
   {
-    ApiCertTree::instance = ApiCertTreePtr(new ApiCertTree);
-    ApiCertTree::instance->refresh();
+    ApiCertTreePtr tree(new ApiCertTree);
+    tree->refresh();
+    ApiCertTree::instance = tree;
   }
 
   return ApiCertTree::instance;
@@ -31,6 +55,7 @@ ApiCertTree::request (void)
 /* ---------------------------------------------------------------- */
 
 ApiCertTree::ApiCertTree (void)
+  : revision(0)
 {
 }
 
@@ -39,19 +64,38 @@ ApiCertTree::ApiCertTree (void)
 void
 ApiCertTree::refresh (void)
 {
+  /* The snapshot is used if it was created from the current XML file. */
   try
   {
-    this->parse_xml(this->get_filename());
+    this->load_snapshot(this->get_snapshot_filename());
     return;
   }
   catch (Exception& e)
   {
-    /* Parse error occured. Report this. */
-    std::cout << std::endl << "XML error: " << e << std::endl;
+    std::cout << "Snapshot: " CERTTREE_FN ": " << e << std::endl;
+  }
+
+  try
+  {
+    this->parse_xml(this->get_filename());
+  }
+  catch (Exception& e)
+  {
+    /* Parse error occured. The caller reports this. */
+    std::cout << std::endl;
+    throw Exception("Cannot load " CERTTREE_FN ": " + e);
   }
 
-  std::cout << "Seeking XML: " CERTTREE_FN " not found. EXIT!" << std::endl;
-  std::exit(EXIT_FAILURE);
+  /* Without a snapshot the XML file is parsed on the next start again. */
+  try
+  {
+    this->write_snapshot(this->get_snapshot_filename());
+  }
+  catch (Exception& e)
+  {
+    std::cout << "Snapshot: Cannot write " CERTTREE_SNAPSHOT_FN ": "
+        << e << std::endl;
+  }
 }
 
 /* ---------------------------------------------------------------- */
@@ -64,42 +108,220 @@ ApiCertTree::get_filename (void) const
 
 /* ---------------------------------------------------------------- */
 
+std::string
+ApiCertTree::get_snapshot_filename (void) const
+{
+  return Config::get_conf_dir() + "/" CERTTREE_SNAPSHOT_FN;
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 ApiCertTree::parse_xml (std::string const& filename)
 {
   /* Try to read the document. */
-  XmlDocumentPtr xml = XmlDocument::create_from_file(filename);
-  xmlNodePtr root = xml->get_root_element();
+  XmlReaderPtr reader = XmlReader::create_from_file(filename);
+  reader->read_root();
 
   std::cout << "Parsing XML: " CERTTREE_FN "... ";
   std::cout.flush();
 
-  /* Document was parsed. Reset information. */
+  /* Document was opened. Reset information. */
   this->certificates.clear();
   this->categories.clear();
   this->classes.clear();
 
-  this->parse_eveapi_tag(root);
+  this->parse_eveapi_tag(*reader);
+  reader->read_end();
+  this->update_name_index();
+
   std::cout << this->certificates.size() << " certs." << std::endl;
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_eveapi_tag (xmlNodePtr node)
+ApiCertTree::load_snapshot (std::string const& filename)
+{
+  Snapshot snapshot;
+  snapshot.open(filename, this->get_filename(),
+      CERTTREE_SNAPSHOT_VERSION, CERTTREE_SNAP_SECTIONS);
+
+  std::cout << "Loading snapshot: " CERTTREE_FN "... " << std::flush;
+
+  uint32_t const* categories = snapshot.get_section(CERTTREE_SNAP_CATEGORIES);
+  std::size_t category_amount = snapshot.get_section_size
+      (CERTTREE_SNAP_CATEGORIES) / CERTTREE_SNAP_CATEGORY_WORDS;
+  uint32_t const* classes = snapshot.get_section(CERTTREE_SNAP_CLASSES);
+  std::size_t class_amount = snapshot.get_section_size
+      (CERTTREE_SNAP_CLASSES) / CERTTREE_SNAP_CLASS_WORDS;
+  uint32_t const* certs = snapshot.get_section(CERTTREE_SNAP_CERTS);
+  std::size_t cert_amount = snapshot.get_section_size
+      (CERTTREE_SNAP_CERTS) / CERTTREE_SNAP_CERT_WORDS;
+  uint32_t const* skilldeps = snapshot.get_section(CERTTREE_SNAP_SKILLDEPS);
+  std::size_t skilldeps_size = snapshot.get_section_size
+      (CERTTREE_SNAP_SKILLDEPS);
+  uint32_t const* certdeps = snapshot.get_section(CERTTREE_SNAP_CERTDEPS);
+  std::size_t certdeps_size = snapshot.get_section_size
+      (CERTTREE_SNAP_CERTDEPS);
+
+  /* Snapshot is valid. Reset information. */
+  this->certificates.clear();
+  this->categories.clear();
+  this->classes.clear();
+
+  /* The rows refer to categories and classes by their position. */
+  std::vector<ApiCertCategory const*> category_list;
+  for (std::size_t i = 0; i < category_amount; ++i)
+  {
+    uint32_t const* row = categories + i * CERTTREE_SNAP_CATEGORY_WORDS;
+    ApiCertCategory category;
+    category.id = (int)row[0];
+    category.name = snapshot.get_string(row[1]);
+    ApiCertCategoryMap::iterator ins = this->categories.insert
+        (std::make_pair(category.id, category)).first;
+    category_list.push_back(&ins->second);
+  }
+
+  std::vector<ApiCertClass const*> class_list;
+  for (std::size_t i = 0; i < class_amount; ++i)
+  {
+    uint32_t const* row = classes + i * CERTTREE_SNAP_CLASS_WORDS;
+    if (row[2] >= category_list.size())
+      throw Exception("Invalid certificate class");
+
+    ApiCertClass certclass;
+    certclass.id = (int)row[0];
+    certclass.name = snapshot.get_string(row[1]);
+    certclass.cat_details = category_list[row[2]];
+    ApiCertClassMap::iterator ins = this->classes.insert
+        (std::make_pair(certclass.id, certclass)).first;
+    class_list.push_back(&ins->second);
+  }
+
+  for (std::size_t i = 0; i < cert_amount; ++i)
+  {
+    uint32_t const* row = certs + i * CERTTREE_SNAP_CERT_WORDS;
+    if (row[3] >= class_list.size()
+        || row[4] > row[5] || row[5] > skilldeps_size / 2
+        || row[6] > row[7] || row[7] > certdeps_size / 2)
+      throw Exception("Invalid certificate");
+
+    ApiCert certificate;
+    certificate.id = (int)row[0];
+    certificate.grade = (int)row[1];
+    certificate.desc = snapshot.get_string(row[2]);
+    certificate.class_details = class_list[row[3]];
+    for (uint32_t j = row[4]; j < row[5]; ++j)
+      certificate.skilldeps.push_back(std::make_pair
+          ((int)skilldeps[2 * j], (int)skilldeps[2 * j + 1]));
+    for (uint32_t j = row[6]; j < row[7]; ++j)
+      certificate.certdeps.push_back(std::make_pair
+          ((int)certdeps[2 * j], (int)certdeps[2 * j + 1]));
+
+    this->certificates.insert(this->certificates.end(),
+        std::make_pair(certificate.id, certificate));
+  }
+
+  this->update_name_index();
+
+  std::cout << this->certificates.size() << " certs." << std::endl;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCertTree::write_snapshot (std::string const& filename)
+{
+  SnapshotWriter writer(CERTTREE_SNAP_SECTIONS);
+
+  std::map<ApiCertCategory const*, uint32_t> category_pos;
+  for (ApiCertCategoryMap::iterator iter = this->categories.begin();
+      iter != this->categories.end(); iter++)
+  {
+    uint32_t pos = (uint32_t)category_pos.size();
+    category_pos[&iter->second] = pos;
+    writer.add(CERTTREE_SNAP_CATEGORIES, (uint32_t)iter->second.id);
+    writer.add(CERTTREE_SNAP_CATEGORIES,
+        writer.add_string(iter->second.name));
+  }
+
+  std::map<ApiCertClass const*, uint32_t> class_pos;
+  for (ApiCertClassMap::iterator iter = this->classes.begin();
+      iter != this->classes.end(); iter++)
+  {
+    uint32_t pos = (uint32_t)class_pos.size();
+    class_pos[&iter->second] = pos;
+    writer.add(CERTTREE_SNAP_CLASSES, (uint32_t)iter->second.id);
+    writer.add(CERTTREE_SNAP_CLASSES, writer.add_string(iter->second.name));
+    writer.add(CERTTREE_SNAP_CLASSES,
+        category_pos[iter->second.cat_details]);
+  }
+
+  uint32_t skilldeps_pos = 0;
+  uint32_t certdeps_pos = 0;
+  for (ApiCertMap::iterator iter = this->certificates.begin();
+      iter != this->certificates.end(); iter++)
+  {
+    ApiCert const& cert = iter->second;
+
+    uint32_t row[CERTTREE_SNAP_CERT_WORDS];
+    row[0] = (uint32_t)cert.id;
+    row[1] = (uint32_t)cert.grade;
+    row[2] = writer.add_string(cert.desc);
+    row[3] = class_pos[cert.class_details];
+    row[4] = skilldeps_pos;
+    skilldeps_pos += (uint32_t)cert.skilldeps.size();
+    row[5] = skilldeps_pos;
+    row[6] = certdeps_pos;
+    certdeps_pos += (uint32_t)cert.certdeps.size();
+    row[7] = certdeps_pos;
+    writer.add(CERTTREE_SNAP_CERTS, row, CERTTREE_SNAP_CERT_WORDS);
+
+    for (std::size_t j = 0; j < cert.skilldeps.size(); ++j)
+    {
+      writer.add(CERTTREE_SNAP_SKILLDEPS, (uint32_t)cert.skilldeps[j].first);
+      writer.add(CERTTREE_SNAP_SKILLDEPS, (uint32_t)cert.skilldeps[j].second);
+    }
+
+    for (std::size_t j = 0; j < cert.certdeps.size(); ++j)
+    {
+      writer.add(CERTTREE_SNAP_CERTDEPS, (uint32_t)cert.certdeps[j].first);
+      writer.add(CERTTREE_SNAP_CERTDEPS, (uint32_t)cert.certdeps[j].second);
+    }
+  }
+
+  writer.write(filename, this->get_filename(), CERTTREE_SNAPSHOT_VERSION);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCertTree::update_name_index (void)
+{
+  this->revision += 1;
+  this->name_index.clear();
+  for (ApiCertClassMap::iterator iter = this->classes.begin();
+      iter != this->classes.end(); iter++)
+    this->name_index.add(iter->first, iter->second.name);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCertTree::parse_eveapi_tag (XmlReader& reader)
 {
-  if (node->type != XML_ELEMENT_NODE
-      || xmlStrcmp(node->name, (xmlChar const*)"eveapi"))
+  if (!reader.is_element("eveapi"))
     throw Exception("Invalid tag. Expecting <eveapi> node");
 
   /* Look for the result tag. */
-  for (node = node->children; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"result"))
+    if (reader.is_element("result"))
     {
       //std::cout << "Found <result> tag" << std::endl;
-      this->parse_result_tag(node->children);
+      this->parse_result_tag(reader);
     }
   }
 }
@@ -107,16 +329,16 @@ ApiCertTree::parse_eveapi_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_result_tag (xmlNodePtr node)
+ApiCertTree::parse_result_tag (XmlReader& reader)
 {
   /* Look for the rowset tag. It's for the cert category rowset. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
       //std::cout << "Found <rowset> tag for cert categories" << std::endl;
-      this->parse_categories_rowset(node->children);
+      this->parse_categories_rowset(reader);
     }
   }
 }
@@ -124,22 +346,22 @@ ApiCertTree::parse_result_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_categories_rowset (xmlNodePtr node)
+ApiCertTree::parse_categories_rowset (XmlReader& reader)
 {
   /* Look for row tags. These are for the cert categories. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiCertCategory category;
-      category.name = this->get_property(node, "categoryName");
-      category.id = this->get_property_int(node, "categoryID");
+      category.name = this->get_property(reader, "categoryName");
+      category.id = this->get_property_int(reader, "categoryID");
 
       //std::cout << "Inserting category: " << category.name << std::endl;
       ApiCertCategoryMap::iterator ins = this->categories.insert
           (std::make_pair(category.id, category)).first;
-      this->parse_categories_row(&ins->second, node->children);
+      this->parse_categories_row(&ins->second, reader);
     }
   }
 }
@@ -147,16 +369,17 @@ ApiCertTree::parse_categories_rowset (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_categories_row (ApiCertCategory* category, xmlNodePtr node)
+ApiCertTree::parse_categories_row (ApiCertCategory* category,
+    XmlReader& reader)
 {
   /* Look for the rowset tag. It's for the classes rowset. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
       //std::cout << "Found <rowset> tag for classes" << std::endl;
-      this->parse_classes_rowset(category, node->children);
+      this->parse_classes_rowset(category, reader);
     }
   }
 }
@@ -164,23 +387,24 @@ ApiCertTree::parse_categories_row (ApiCertCategory* category, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_classes_rowset (ApiCertCategory* category, xmlNodePtr node)
+ApiCertTree::parse_classes_rowset (ApiCertCategory* category,
+    XmlReader& reader)
 {
   /* Look for row tags. These are for the cert classes. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiCertClass certclass;
-      certclass.name = this->get_property(node, "className");
-      certclass.id = this->get_property_int(node, "classID");
+      certclass.name = this->get_property(reader, "className");
+      certclass.id = this->get_property_int(reader, "classID");
       certclass.cat_details = category;
 
       //std::cout << "Inserting class: " << certclass.name << std::endl;
       ApiCertClassMap::iterator ins = this->classes.insert
           (std::make_pair(certclass.id, certclass)).first;
-      this->parse_classes_row(&ins->second, node->children);
+      this->parse_classes_row(&ins->second, reader);
     }
   }
 }
@@ -188,16 +412,16 @@ ApiCertTree::parse_classes_rowset (ApiCertCategory* category, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_classes_row (ApiCertClass* cclass, xmlNodePtr node)
+ApiCertTree::parse_classes_row (ApiCertClass* cclass, XmlReader& reader)
 {
   /* Look for the rowset tag. It's for the certificates rowset (at last!). */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
       //std::cout << "Found <rowset> tag for certificates" << std::endl;
-      this->parse_certificates_rowset(cclass, node->children);
+      this->parse_certificates_rowset(cclass, reader);
     }
   }
 }
@@ -205,24 +429,25 @@ ApiCertTree::parse_classes_row (ApiCertClass* cclass, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_certificates_rowset (ApiCertClass* cclass, xmlNodePtr node)
+ApiCertTree::parse_certificates_rowset (ApiCertClass* cclass,
+    XmlReader& reader)
 {
   /* Look for row tags. These are for the certificates. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiCert certificate;
       certificate.class_details = cclass;
-      certificate.id = this->get_property_int(node, "certificateID");
-      certificate.grade = this->get_property_int(node, "grade");
-      certificate.desc = this->get_property(node, "description");
+      certificate.id = this->get_property_int(reader, "certificateID");
+      certificate.grade = this->get_property_int(reader, "grade");
+      certificate.desc = this->get_property(reader, "description");
 
       //std::cout << "Inserting certificate: " << certificate.id << std::endl;
       ApiCertMap::iterator ins = this->certificates.insert
           (std::make_pair(certificate.id, certificate)).first;
-      this->parse_certificate_row(&ins->second, node->children);
+      this->parse_certificate_row(&ins->second, reader);
     }
   }
 }
@@ -230,39 +455,38 @@ ApiCertTree::parse_certificates_rowset (ApiCertClass* cclass, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCertTree::parse_certificate_row (ApiCert* cert, xmlNodePtr node)
+ApiCertTree::parse_certificate_row (ApiCert* cert, XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE
-        || xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (!reader.is_element("rowset"))
       continue;
 
-    std::string name = this->get_property(node, "name");
+    std::string name = this->get_property(reader, "name");
+    int rowset_depth = reader.get_depth();
 
     if (name == "requiredSkills")
     {
-      for (xmlNodePtr cnode = node->children; cnode != 0; cnode = cnode->next)
+      while (reader.next_child(rowset_depth))
       {
-        if (node->type != XML_ELEMENT_NODE
-            || xmlStrcmp(cnode->name, (xmlChar const*)"row"))
+        if (!reader.is_element("row"))
           continue;
 
-        int skill_id = this->get_property_int(cnode, "typeID");
-        int skill_level = this->get_property_int(cnode, "level");
+        int skill_id = this->get_property_int(reader, "typeID");
+        int skill_level = this->get_property_int(reader, "level");
         cert->skilldeps.push_back(std::make_pair(skill_id, skill_level));
       }
     }
     else if (name == "requiredCertificates")
     {
-      for (xmlNodePtr cnode = node->children; cnode != 0; cnode = cnode->next)
+      while (reader.next_child(rowset_depth))
       {
-        if (cnode->type != XML_ELEMENT_NODE
-            || xmlStrcmp(cnode->name, (xmlChar const*)"row"))
+        if (!reader.is_element("row"))
           continue;
 
-        int cert_id = this->get_property_int(cnode, "certificateID");
-        int cert_grade = this->get_property_int(cnode, "grade");
+        int cert_id = this->get_property_int(reader, "certificateID");
+        int cert_grade = this->get_property_int(reader, "grade");
         cert->certdeps.push_back(std::make_pair(cert_id, cert_grade));
       }
     }
@@ -16,9 +16,9 @@
 #include <vector>
 #include <string>
 #include <map>
-#include <libxml/parser.h>
 
 #include "util/ref_ptr.h"
+#include "util/searchindex.h"
 #include "apibase.h"
 
 struct ApiCertCategory
@@ -70,17 +70,23 @@ class ApiCertTree : public ApiBase
   private:
     static ApiCertTreePtr instance;
 
+    /* The class names for the certificate browser filter. */
+    SearchIndex name_index;
+
   protected:
     ApiCertTree (void);
     void parse_xml (std::string const& filename);
-    void parse_eveapi_tag (xmlNodePtr node);
-    void parse_result_tag (xmlNodePtr node);
-    void parse_categories_rowset (xmlNodePtr node);
-    void parse_categories_row (ApiCertCategory* category, xmlNodePtr node);
-    void parse_classes_rowset (ApiCertCategory* category, xmlNodePtr node);
-    void parse_classes_row (ApiCertClass* cclass, xmlNodePtr node);
-    void parse_certificates_rowset (ApiCertClass* cclass, xmlNodePtr node);
-    void parse_certificate_row (ApiCert* cert, xmlNodePtr node);
+    void load_snapshot (std::string const& filename);
+    void write_snapshot (std::string const& filename);
+    void update_name_index (void);
+    void parse_eveapi_tag (XmlReader& reader);
+    void parse_result_tag (XmlReader& reader);
+    void parse_categories_rowset (XmlReader& reader);
+    void parse_categories_row (ApiCertCategory* category, XmlReader& reader);
+    void parse_classes_rowset (ApiCertCategory* category, XmlReader& reader);
+    void parse_classes_row (ApiCertClass* cclass, XmlReader& reader);
+    void parse_certificates_rowset (ApiCertClass* cclass, XmlReader& reader);
+    void parse_certificate_row (ApiCert* cert, XmlReader& reader);
 
   public:
     std::string filename;
@@ -88,15 +94,25 @@ class ApiCertTree : public ApiBase
     ApiCertCategoryMap categories;
     ApiCertClassMap classes;
 
+    /* Incremented whenever the tree is reloaded. Allows consumers
+     * to cheaply detect stale pointers to certificates. */
+    unsigned int revision;
+
   public:
+    /* Loads the tree on first use. Throws if it cannot be loaded. */
     static ApiCertTreePtr request (void);
+    /* Loads the snapshot or parses the XML file, or throws. */
     void refresh (void);
     std::string get_filename (void) const;
+    std::string get_snapshot_filename (void) const;
 
     ApiCertClass const* get_class_for_id (int id) const;
     ApiCertCategory const* get_category_for_id (int id) const;
     ApiCert const* get_certificate_for_id (int id) const;
 
+    /* Returns the index over the class names, reporting class IDs. */
+    SearchIndex const& get_name_index (void) const;
+
     static char const* get_name_for_grade (int grade);
     static int get_grade_index (int grade);
 
@@ -111,4 +127,10 @@ ApiCert::get_type (void) const
   return API_ELEM_CERT;
 }
 
+inline SearchIndex const&
+ApiCertTree::get_name_index (void) const
+{
+  return this->name_index;
+}
+
 #endif /* API_CERT_TREE_HEADER */
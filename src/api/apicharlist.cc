@@ -1,6 +1,4 @@
 #include <iostream>
-#include <libxml/xmlmemory.h>
-#include <libxml/parser.h>
 
 #include "util/exception.h"
 #include "xml.h"
@@ -12,73 +10,66 @@ ApiCharacterList::parse_xml (void)
   this->chars.clear();
 
   std::cout << "Parsing XML: Characters.xml ..." << std::endl;
-  XmlDocumentPtr xml = XmlDocument::create
+  XmlReaderPtr reader = XmlReader::create
       (&this->http_data->data[0], this->http_data->data.size());
-  xmlNodePtr root = xml->get_root_element();
-  this->parse_eveapi_tag(root);
+  reader->read_root();
+  this->parse_eveapi_tag(*reader);
+  reader->read_end();
 }
 
-/* ---------------------------------------------------------------- */
 
 void
-ApiCharacterList::parse_eveapi_tag (xmlNodePtr node)
+ApiCharacterList::parse_eveapi_tag (XmlReader& reader)
 {
-  if (node->type != XML_ELEMENT_NODE
-      || xmlStrcmp(node->name, (xmlChar const*)"eveapi"))
+  if (!reader.is_element("eveapi"))
     throw Exception("Invalid XML root. Expecting <eveapi> node.");
 
-  for (node = node->children; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
     /* Let the base class know of some fields. */
-    this->check_node(node);
+    this->check_node(reader);
 
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"result"))
+    if (reader.is_element("result"))
     {
       //std::cout << "Found <result> tag" << std::endl;
-      this->parse_result_tag(node->children);
+      this->parse_result_tag(reader);
     }
   }
 }
 
-/* ---------------------------------------------------------------- */
 
 void
-ApiCharacterList::parse_result_tag (xmlNodePtr node)
+ApiCharacterList::parse_result_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
-      std::string name = this->get_property(node, "name");
+      std::string name = this->get_property(reader, "name");
       if (name == "characters")
-        this->parse_characters(node->children);
+        this->parse_characters(reader);
     }
   }
 }
 
-/* ---------------------------------------------------------------- */
 
 void
-ApiCharacterList::parse_characters (xmlNodePtr node)
+ApiCharacterList::parse_characters (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       try
       {
         ApiCharListEntry entry;
-        entry.name = this->get_property(node, "name");
-        entry.char_id = this->get_property(node, "characterID");
-        entry.corp = this->get_property(node, "corporationName");
-        entry.corp_id = this->get_property(node, "corporationID");
+        entry.name = this->get_property(reader, "name");
+        entry.char_id = this->get_property(reader, "characterID");
+        entry.corp = this->get_property(reader, "corporationName");
+        entry.corp_id = this->get_property(reader, "corporationID");
         this->chars.push_back(entry);
       }
       catch (Exception& e)
@@ -41,9 +41,9 @@ class ApiCharacterList : public ApiBase
   protected:
     ApiCharacterList (void);
     void parse_xml (void);
-    void parse_eveapi_tag (xmlNodePtr node);
-    void parse_result_tag (xmlNodePtr node);
-    void parse_characters (xmlNodePtr node);
+    void parse_eveapi_tag (XmlReader& reader);
+    void parse_result_tag (XmlReader& reader);
+    void parse_characters (XmlReader& reader);
 
   /* Publicly available collection of gathered data. */
   public:
@@ -1,7 +1,5 @@
 #include <cmath>
 #include <iostream>
-#include <libxml/xmlmemory.h>
-#include <libxml/parser.h>
 
 #include "util/exception.h"
 #include "util/helpers.h"
@@ -13,6 +11,27 @@
 
 void
 ApiCharSheet::set_api_data (EveApiData const& data)
+{
+  this->parse_api_data(data);
+  this->resolve_details();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCharSheet::set_parsed_sheet (ApiCharSheet const& sheet)
+{
+  /* Keep the revision increasing for consumers of this sheet. */
+  unsigned int revision = this->revision;
+  *this = sheet;
+  this->revision = revision;
+  this->resolve_details();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCharSheet::parse_api_data (EveApiData const& data)
 {
   this->valid = false;
   this->ApiBase::set_api_data(data);
@@ -31,7 +50,13 @@ ApiCharSheet::set_api_data (EveApiData const& data)
 
   /* Find bonus attributes for skills. */
   this->total = this->base + this->implant;
+}
+
+/* ---------------------------------------------------------------- */
 
+void
+ApiCharSheet::resolve_details (void)
+{
   /* Calculate start SP, destination SP and completed. */
   ApiSkillTreePtr stree = ApiSkillTree::request();
   for (std::size_t i = 0; i < this->skills.size(); ++i)
@@ -64,6 +89,9 @@ ApiCharSheet::set_api_data (EveApiData const& data)
     this->skills_at[cskill.level] += 1;
   }
 
+  /* Index skills for fast lookup. */
+  this->build_skill_index();
+
   /* Update certificate field "details". */
   ApiCertTreePtr ctree = ApiCertTree::request();
   for (unsigned int i = 0; i < this->certs.size(); ++i)
@@ -83,6 +111,7 @@ ApiCharSheet::set_api_data (EveApiData const& data)
   }
 
   //this->debug_dump();
+  this->revision += 1;
   this->valid = true;
 }
 
@@ -94,31 +123,31 @@ ApiCharSheet::parse_xml (void)
   this->skills.clear();
 
   std::cout << "Parsing XML: CharacterSheet.xml ..." << std::endl;
-  XmlDocumentPtr xml = XmlDocument::create
+  XmlReaderPtr reader = XmlReader::create
       (&this->http_data->data[0], this->http_data->data.size());
-  xmlNodePtr root = xml->get_root_element();
-  this->parse_eveapi_tag(root);
+  reader->read_root();
+  this->parse_eveapi_tag(*reader);
+  reader->read_end();
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_eveapi_tag (xmlNodePtr node)
+ApiCharSheet::parse_eveapi_tag (XmlReader& reader)
 {
-  if (node->type != XML_ELEMENT_NODE
-      || xmlStrcmp(node->name, (xmlChar const*)"eveapi"))
+  if (!reader.is_element("eveapi"))
     throw Exception("Invalid XML root. Expecting <eveapi> node.");
 
-  for (node = node->children; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
     /* Let the base class know of some fields. */
-    this->check_node(node);
+    this->check_node(reader);
 
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"result"))
+    if (reader.is_element("result"))
     {
       //std::cout << "Found <result> tag" << std::endl;
-      this->parse_result_tag(node->children);
+      this->parse_result_tag(reader);
     }
   }
 }
@@ -126,42 +155,39 @@ ApiCharSheet::parse_eveapi_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_result_tag (xmlNodePtr node)
+ApiCharSheet::parse_result_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    this->set_string_if_node_text(node, "characterID", this->char_id);
-    this->set_string_if_node_text(node, "name", this->name);
-    this->set_string_if_node_text(node, "race", this->race);
-    this->set_string_if_node_text(node, "bloodLine", this->bloodline);
-    this->set_string_if_node_text(node, "gender", this->gender);
-    this->set_string_if_node_text(node, "corporationName", this->corp);
-    this->set_string_if_node_text(node, "balance", this->balance);
-
-    this->set_string_if_node_text(node, "cloneName", this->clone_name);
-    this->set_uint_if_node_text(node, "cloneSkillPoints", this->clone_sp);
-    this->set_uint_if_node_text(node, "freeSkillPoints", this->free_sp);
-    this->set_string_if_node_text(node, "lastRespecDate", this->last_respec);
-    this->set_string_if_node_text(node, "lastTimedRespec", this->last_timed_respec);
-    this->set_uint_if_node_text(node, "freeRespecs", this->free_respecs);
-    this->set_string_if_node_text(node, "cloneJumpDate", this->last_clone_jump);
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"attributes"))
-      this->parse_attribute_tag(node->children);
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"attributeEnhancers"))
-      this->parse_attrib_enhancers_tag(node->children);
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    this->set_string_if_node_text(reader, "characterID", this->char_id);
+    this->set_string_if_node_text(reader, "name", this->name);
+    this->set_string_if_node_text(reader, "race", this->race);
+    this->set_string_if_node_text(reader, "bloodLine", this->bloodline);
+    this->set_string_if_node_text(reader, "gender", this->gender);
+    this->set_string_if_node_text(reader, "corporationName", this->corp);
+    this->set_string_if_node_text(reader, "balance", this->balance);
+
+    this->set_string_if_node_text(reader, "cloneName", this->clone_name);
+    this->set_uint_if_node_text(reader, "cloneSkillPoints", this->clone_sp);
+    this->set_uint_if_node_text(reader, "freeSkillPoints", this->free_sp);
+    this->set_string_if_node_text(reader, "lastRespecDate", this->last_respec);
+    this->set_string_if_node_text(reader, "lastTimedRespec", this->last_timed_respec);
+    this->set_uint_if_node_text(reader, "freeRespecs", this->free_respecs);
+    this->set_string_if_node_text(reader, "cloneJumpDate", this->last_clone_jump);
+
+    /* The nested elements are consumed by the tag parsers. */
+    if (reader.is_element("attributes"))
+      this->parse_attribute_tag(reader);
+    else if (reader.is_element("attributeEnhancers"))
+      this->parse_attrib_enhancers_tag(reader);
+    else if (reader.is_element("rowset"))
     {
-      std::string name = this->get_property(node, "name");
+      std::string name = this->get_property(reader, "name");
       if (name == "skills")
-        this->parse_skills_tag(node->children);
+        this->parse_skills_tag(reader);
       else if (name == "certificates")
-        this->parse_certificates_tag(node->children);
+        this->parse_certificates_tag(reader);
     }
   }
 }
@@ -169,50 +195,44 @@ ApiCharSheet::parse_result_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_attribute_tag (xmlNodePtr node)
+ApiCharSheet::parse_attribute_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    this->set_double_if_node_text(node, "intelligence", this->base.intl);
-    this->set_double_if_node_text(node, "memory", this->base.mem);
-    this->set_double_if_node_text(node, "charisma", this->base.cha);
-    this->set_double_if_node_text(node, "perception", this->base.per);
-    this->set_double_if_node_text(node, "willpower", this->base.wil);
+    this->set_double_if_node_text(reader, "intelligence", this->base.intl);
+    this->set_double_if_node_text(reader, "memory", this->base.mem);
+    this->set_double_if_node_text(reader, "charisma", this->base.cha);
+    this->set_double_if_node_text(reader, "perception", this->base.per);
+    this->set_double_if_node_text(reader, "willpower", this->base.wil);
   }
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_attrib_enhancers_tag (xmlNodePtr node)
+ApiCharSheet::parse_attrib_enhancers_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    this->find_implant_bonus(node, "memoryBonus", this->implant.mem);
-    this->find_implant_bonus(node, "willpowerBonus", this->implant.wil);
-    this->find_implant_bonus(node, "perceptionBonus", this->implant.per);
-    this->find_implant_bonus(node, "intelligenceBonus", this->implant.intl);
-    this->find_implant_bonus(node, "charismaBonus", this->implant.cha);
+    this->find_implant_bonus(reader, "memoryBonus", this->implant.mem);
+    this->find_implant_bonus(reader, "willpowerBonus", this->implant.wil);
+    this->find_implant_bonus(reader, "perceptionBonus", this->implant.per);
+    this->find_implant_bonus(reader, "intelligenceBonus", this->implant.intl);
+    this->find_implant_bonus(reader, "charismaBonus", this->implant.cha);
   }
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_skills_tag (xmlNodePtr node)
+ApiCharSheet::parse_skills_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       /* Prepare a new skill to append. */
       ApiCharSheetSkill skill;
@@ -221,9 +241,9 @@ ApiCharSheet::parse_skills_tag (xmlNodePtr node)
       try
       {
         skill.id = Helpers::get_int_from_string
-            (this->get_property(node, "typeID"));
+            (this->get_property(reader, "typeID"));
         skill.points = Helpers::get_int_from_string
-            (this->get_property(node, "skillpoints"));
+            (this->get_property(reader, "skillpoints"));
       }
       catch (Exception& e)
       {
@@ -235,7 +255,7 @@ ApiCharSheet::parse_skills_tag (xmlNodePtr node)
       try
       {
         skill.level = Helpers::get_int_from_string
-            (this->get_property(node, "level"));
+            (this->get_property(reader, "level"));
 
         /* Add skill to list. */
         this->skills.push_back(skill);
@@ -252,21 +272,19 @@ ApiCharSheet::parse_skills_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::parse_certificates_tag (xmlNodePtr node)
+ApiCharSheet::parse_certificates_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiCharSheetCert cert;
 
       try
       {
         cert.id = Helpers::get_int_from_string
-            (this->get_property(node, "certificateID"));
+            (this->get_property(reader, "certificateID"));
         this->certs.push_back(cert);
       }
       catch (Exception& e)
@@ -280,17 +298,14 @@ ApiCharSheet::parse_certificates_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiCharSheet::find_implant_bonus (xmlNodePtr node, char const* name, double& v)
+ApiCharSheet::find_implant_bonus (XmlReader& reader, char const* name,
+    double& v)
 {
-  if (node->type == XML_ELEMENT_NODE
-      && !xmlStrcmp(node->name, (xmlChar const*)name))
+  if (reader.is_element(name))
   {
-    node = node->children;
-    while (node != 0)
-    {
-      this->set_double_if_node_text(node, "augmentatorValue", v);
-      node = node->next;
-    }
+    int depth = reader.get_depth();
+    while (reader.next_child(depth))
+      this->set_double_if_node_text(reader, "augmentatorValue", v);
   }
 }
 
@@ -338,6 +353,7 @@ ApiCharSheet::add_char_skill (int skill_id, int level)
     new_cskill.details = skill;
 
     this->skills.push_back(new_cskill);
+    this->insert_skill_index(this->skills.size() - 1);
     this->skills_at[level] += 1;
     this->total_sp += skill_start_sp;
   }
@@ -365,6 +381,8 @@ ApiCharSheet::add_char_skill (int skill_id, int level)
     this->total_sp -= old_points;
     this->total_sp += skill_start_sp;
   }
+
+  this->revision += 1;
 }
 
 /* ---------------------------------------------------------------- */
@@ -372,9 +390,9 @@ ApiCharSheet::add_char_skill (int skill_id, int level)
 int
 ApiCharSheet::get_level_for_skill (int id) const
 {
-  for (std::size_t i = 0; i < this->skills.size(); ++i)
-    if (this->skills[i].id == id)
-      return this->skills[i].level;
+  int pos = this->find_skill_index(id);
+  if (pos >= 0)
+    return this->skills[pos].level;
 
   /* Return level 0 if skill is not in the list. */
   return 0;
@@ -385,15 +403,38 @@ ApiCharSheet::get_level_for_skill (int id) const
 ApiCharSheetSkill*
 ApiCharSheet::get_skill_for_id (int id)
 {
-  for (std::size_t i = 0; i < this->skills.size(); ++i)
-    if (this->skills[i].id == id)
-      return &this->skills[i];
+  int pos = this->find_skill_index(id);
+  if (pos >= 0)
+    return &this->skills[pos];
 
   return 0;
 }
 
 /* ---------------------------------------------------------------- */
 
+ApiSkillLevels const&
+ApiCharSheet::get_known_levels (void)
+{
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+  if (this->known_levels_size == tree->get_skill_amount()
+      && this->known_levels_revision == this->revision)
+    return this->known_levels;
+
+  this->known_levels.clear(tree->get_skill_amount());
+  for (std::size_t i = 0; i < this->skills.size(); ++i)
+  {
+    ApiSkill const* skill = tree->get_skill_for_id(this->skills[i].id);
+    if (skill != 0)
+      this->known_levels.set_level(skill->index, this->skills[i].level);
+  }
+
+  this->known_levels_revision = this->revision;
+  this->known_levels_size = tree->get_skill_amount();
+  return this->known_levels;
+}
+
+/* ---------------------------------------------------------------- */
+
 ApiCharSheetCert*
 ApiCharSheet::get_cert_for_id (int id)
 {
@@ -427,13 +468,23 @@ unsigned int
 ApiCharSheet::get_spph_for_skill (ApiSkill const* skill,
     ApiCharAttribs const& attribs)
 {
-  double pri;
-  double sec;
-
   if (skill == 0)
     return 0;
 
-  switch (skill->primary)
+  return ApiCharSheet::get_spph_for_attribs(skill->primary,
+      skill->secondary, attribs);
+}
+
+/* ---------------------------------------------------------------- */
+
+unsigned int
+ApiCharSheet::get_spph_for_attribs (ApiAttrib primary, ApiAttrib secondary,
+    ApiCharAttribs const& attribs)
+{
+  double pri;
+  double sec;
+
+  switch (primary)
   {
     case API_ATTRIB_INTELLIGENCE: pri = attribs.intl; break;
     case API_ATTRIB_MEMORY:       pri = attribs.mem; break;
@@ -443,7 +494,7 @@ ApiCharSheet::get_spph_for_skill (ApiSkill const* skill,
     default: pri = 0.0;
   }
 
-  switch (skill->secondary)
+  switch (secondary)
   {
     case API_ATTRIB_INTELLIGENCE: sec = attribs.intl; break;
     case API_ATTRIB_MEMORY:       sec = attribs.mem; break;
@@ -503,12 +554,73 @@ ApiCharSheet::debug_dump (void)
 bool
 ApiCharSheet::is_skill_known (int id)
 {
-  for (size_t i = 0; i < skills.size(); i++)
+  return this->find_skill_index(id) >= 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+/* Hashes the skill ID to a slot in the index. The index size
+ * is always a power of two, so the lower bits are used. */
+static inline std::size_t
+skill_index_slot (int id, std::size_t size)
+{
+  unsigned int hash = (unsigned int)id * 2654435761u;
+  return (std::size_t)(hash ^ (hash >> 16)) & (size - 1);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCharSheet::build_skill_index (void)
+{
+  /* Keep the load factor below 1/2 for short probe sequences. */
+  std::size_t size = 16;
+  while (size < 2 * this->skills.size())
+    size *= 2;
+
+  this->skill_index.clear();
+  this->skill_index.resize(size, -1);
+  for (std::size_t i = 0; i < this->skills.size(); ++i)
+    this->insert_skill_index(i);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiCharSheet::insert_skill_index (std::size_t pos)
+{
+  if (this->skill_index.size() < 2 * (this->skills.size()))
   {
-    if (skills[i].id == id)
-      return true;
+    this->build_skill_index();
+    return;
   }
-  return false;
+
+  std::size_t size = this->skill_index.size();
+  std::size_t slot = skill_index_slot(this->skills[pos].id, size);
+  while (this->skill_index[slot] >= 0)
+    slot = (slot + 1) & (size - 1);
+  this->skill_index[slot] = (int)pos;
+}
+
+/* ---------------------------------------------------------------- */
+
+int
+ApiCharSheet::find_skill_index (int id) const
+{
+  std::size_t size = this->skill_index.size();
+  if (size == 0)
+    return -1;
+
+  for (std::size_t slot = skill_index_slot(id, size);
+      this->skill_index[slot] >= 0; slot = (slot + 1) & (size - 1))
+  {
+    int pos = this->skill_index[slot];
+    if ((std::size_t)pos < this->skills.size()
+        && this->skills[pos].id == id)
+      return pos;
+  }
+
+  return -1;
 }
 
 /* ---------------------------------------------------------------- */
@@ -74,6 +74,9 @@ struct ApiCharAttribs
   ApiCharAttribs operator/ (double const& value) const;
 
   ApiCharAttribs& operator= (double const& value);
+
+  bool operator== (ApiCharAttribs const& atts) const;
+  bool operator!= (ApiCharAttribs const& atts) const;
 };
 
 /* ---------------------------------------------------------------- */
@@ -87,21 +90,43 @@ class ApiCharSheet : public ApiBase
   protected:
     ApiCharSheet (void);
 
+    /* Looks up the skills and certificates in the trees. */
+    void resolve_details (void);
+
     void parse_xml (void);
-    void parse_eveapi_tag (xmlNodePtr node);
-    void parse_result_tag (xmlNodePtr node);
-    void parse_attribute_tag (xmlNodePtr node);
-    void parse_attrib_enhancers_tag (xmlNodePtr node);
-    void parse_skills_tag (xmlNodePtr node);
-    void parse_certificates_tag (xmlNodePtr node);
-
-    void find_implant_bonus (xmlNodePtr node, char const* name, double& var);
+    void parse_eveapi_tag (XmlReader& reader);
+    void parse_result_tag (XmlReader& reader);
+    void parse_attribute_tag (XmlReader& reader);
+    void parse_attrib_enhancers_tag (XmlReader& reader);
+    void parse_skills_tag (XmlReader& reader);
+    void parse_certificates_tag (XmlReader& reader);
+
+    void find_implant_bonus (XmlReader& reader, char const* name,
+        double& var);
     void debug_dump (void);
 
+    /* Hash index from skill ID to the position in the skills vector.
+     * Slots use open addressing and contain the position or -1. */
+    std::vector<int> skill_index;
+
+    void build_skill_index (void);
+    void insert_skill_index (std::size_t pos);
+    int find_skill_index (int id) const;
+
+    /* Known skill levels over the skill tree indices, rebuilt
+     * on demand when the revision changed. */
+    ApiSkillLevels known_levels;
+    unsigned int known_levels_revision;
+    std::size_t known_levels_size;
+
   /* Publicly available collection of gathered data. */
   public:
     bool valid;
 
+    /* Incremented whenever the skill data changes. Allows
+     * consumers to cheaply detect stale cached calculations. */
+    unsigned int revision;
+
     /* Basic char information. */
     std::string char_id;
     std::string name;
@@ -137,13 +162,22 @@ class ApiCharSheet : public ApiBase
     static ApiCharSheetPtr create (void);
     void set_api_data (EveApiData const& data);
 
+    /* Parses the data without using the skill and certificate trees,
+     * which allows parsing on other threads. The parsed sheet is
+     * completed by passing it to set_parsed_sheet() of another sheet. */
+    void parse_api_data (EveApiData const& data);
+    void set_parsed_sheet (ApiCharSheet const& sheet);
+
     /* Check whether the character knows this skill */
     bool is_skill_known (int id);
 
-    /* Lookup methods for skills. This is expensive. */
+    /* Lookup methods for skills. These use a hash index. */
     ApiCharSheetSkill* get_skill_for_id (int id);
     int get_level_for_skill (int id) const;
 
+    /* Returns the known skill levels for prerequisite checks. */
+    ApiSkillLevels const& get_known_levels (void);
+
     /* Lookup methods for certificates. This is expensive. */
     ApiCharSheetCert* get_cert_for_id (int id);
     int get_grade_for_class (int class_id) const;
@@ -157,6 +191,8 @@ class ApiCharSheet : public ApiBase
     unsigned int get_spph_for_skill (ApiSkill const* skill);
     unsigned int get_spph_for_skill (ApiSkill const* skill,
         ApiCharAttribs const& attribs);
+    static unsigned int get_spph_for_attribs (ApiAttrib primary,
+        ApiAttrib secondary, ApiCharAttribs const& attribs);
 
     /* Generic calculation of skill start and destination SP.
      * This is character independent. */
@@ -181,8 +217,23 @@ ApiCharAttribs::ApiCharAttribs (double value)
   this->wil = value;
 }
 
+inline bool
+ApiCharAttribs::operator== (ApiCharAttribs const& atts) const
+{
+  return this->intl == atts.intl && this->mem == atts.mem
+      && this->cha == atts.cha && this->per == atts.per
+      && this->wil == atts.wil;
+}
+
+inline bool
+ApiCharAttribs::operator!= (ApiCharAttribs const& atts) const
+{
+  return !(*this == atts);
+}
+
 inline
-ApiCharSheet::ApiCharSheet (void) : valid(false)
+ApiCharSheet::ApiCharSheet (void)
+  : known_levels_revision(0), known_levels_size(0), valid(false), revision(0)
 {
 }
 
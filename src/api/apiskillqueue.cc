@@ -55,33 +55,31 @@ void
 ApiSkillQueue::parse_xml (void)
 {
   std::cout << "Parsing XML: SkillQueue.xml ..." << std::endl;
-  XmlDocumentPtr xml = XmlDocument::create
+  XmlReaderPtr reader = XmlReader::create
       (&this->http_data->data[0], this->http_data->data.size());
-  xmlNodePtr root = xml->get_root_element();
-  this->parse_eveapi_tag(root);
+  reader->read_root();
+  this->parse_eveapi_tag(*reader);
+  reader->read_end();
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillQueue::parse_eveapi_tag (xmlNodePtr node)
+ApiSkillQueue::parse_eveapi_tag (XmlReader& reader)
 {
-  if (node->type != XML_ELEMENT_NODE
-      || xmlStrcmp(node->name, (xmlChar const*)"eveapi"))
+  if (!reader.is_element("eveapi"))
     throw Exception("Invalid XML root. Expecting <eveapi> node.");
 
-  for (node = node->children; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
     /* Let the base class know of some fields. */
-    this->check_node(node);
+    this->check_node(reader);
 
-    if (!xmlStrcmp(node->name, (xmlChar const*)"result"))
+    if (reader.is_element("result"))
     {
       //std::cout << "Found <result> tag" << std::endl;
-      this->parse_result_tag(node->children);
+      this->parse_result_tag(reader);
     }
   }
 }
@@ -89,18 +87,16 @@ ApiSkillQueue::parse_eveapi_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillQueue::parse_result_tag (xmlNodePtr node)
+ApiSkillQueue::parse_result_tag (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
-      std::string name = this->get_property(node, "name");
+      std::string name = this->get_property(reader, "name");
       if (name == "skillqueue")
-        this->parse_queue_rowset(node->children);
+        this->parse_queue_rowset(reader);
     }
   }
 }
@@ -108,24 +104,22 @@ ApiSkillQueue::parse_result_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillQueue::parse_queue_rowset (xmlNodePtr node)
+ApiSkillQueue::parse_queue_rowset (XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
-      std::string pos = this->get_property(node, "queuePosition");
-      std::string type_id = this->get_property(node, "typeID");
-      std::string level = this->get_property(node, "level");
-      std::string startsp = this->get_property(node, "startSP");
-      std::string endsp = this->get_property(node, "endSP");
+      std::string pos = this->get_property(reader, "queuePosition");
+      std::string type_id = this->get_property(reader, "typeID");
+      std::string level = this->get_property(reader, "level");
+      std::string startsp = this->get_property(reader, "startSP");
+      std::string endsp = this->get_property(reader, "endSP");
 
       ApiSkillQueueItem item;
-      item.start_time = this->get_property(node, "startTime");
-      item.end_time = this->get_property(node, "endTime");
+      item.start_time = this->get_property(reader, "startTime");
+      item.end_time = this->get_property(reader, "endTime");
       item.queue_pos = Helpers::get_int_from_string(pos);
       item.skill_id = Helpers::get_int_from_string(type_id);
       item.to_level = Helpers::get_int_from_string(level);
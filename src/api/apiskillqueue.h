@@ -49,9 +49,9 @@ class ApiSkillQueue : public ApiBase
     ApiSkillQueue (void);
 
     void parse_xml (void);
-    void parse_eveapi_tag (xmlNodePtr node);
-    void parse_result_tag (xmlNodePtr node);
-    void parse_queue_rowset (xmlNodePtr node);
+    void parse_eveapi_tag (XmlReader& reader);
+    void parse_result_tag (XmlReader& reader);
+    void parse_queue_rowset (XmlReader& reader);
 
   /* Publicly available collection of gathered data. */
   public:
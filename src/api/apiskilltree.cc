@@ -1,15 +1,39 @@
-#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
 #include "util/helpers.h"
 #include "util/exception.h"
+#include "util/snapshot.h"
 #include "bits/config.h"
 #include "xml.h"
 #include "apiskilltree.h"
 
 #define SKILLTREE_FN "SkillTree.xml"
+#define SKILLTREE_SNAPSHOT_FN "SkillTree.snapshot"
+/* Increment whenever the layout of the snapshot changes. */
+#define SKILLTREE_SNAPSHOT_VERSION 1
+
+/*
+ * Sections of the skill tree snapshot. Groups are stored as (ID, name),
+ * skills in dense index order as (ID, group, rank, published, primary,
+ * secondary, name, description) followed by the ranges of their entries
+ * in the dependency and the edge section. Dependencies are (ID, level)
+ * pairs as in the XML file, edges are the resolved (index, level) pairs.
+ * The prerequisite bitsets are stored for every skill.
+ */
+enum SkillTreeSnapshotSection
+{
+  SKILLTREE_SNAP_GROUPS,
+  SKILLTREE_SNAP_SKILLS,
+  SKILLTREE_SNAP_DEPS,
+  SKILLTREE_SNAP_EDGES,
+  SKILLTREE_SNAP_PREREQS,
+  SKILLTREE_SNAP_SECTIONS
+};
+
+#define SKILLTREE_SNAP_GROUP_WORDS 2
+#define SKILLTREE_SNAP_SKILL_WORDS 12
 
 ApiSkillTreePtr ApiSkillTree::instance;
 
@@ -20,8 +44,9 @@ ApiSkillTree::request (void)
 {
   if (ApiSkillTree::instance.get() == 0)
   {
-    ApiSkillTree::instance = ApiSkillTreePtr(new ApiSkillTree);
-    ApiSkillTree::instance->refresh();
+    ApiSkillTreePtr tree(new ApiSkillTree);
+    tree->refresh();
+    ApiSkillTree::instance = tree;
   }
 
   return ApiSkillTree::instance;
@@ -30,6 +55,7 @@ ApiSkillTree::request (void)
 /* ---------------------------------------------------------------- */
 
 ApiSkillTree::ApiSkillTree (void)
+  : revision(0)
 {
 }
 
@@ -38,19 +64,38 @@ ApiSkillTree::ApiSkillTree (void)
 void
 ApiSkillTree::refresh (void)
 {
+  /* The snapshot is used if it was created from the current XML file. */
   try
   {
-    this->parse_xml(this->get_filename());
+    this->load_snapshot(this->get_snapshot_filename());
     return;
   }
   catch (Exception& e)
   {
-    /* Parse error occured. Report this. */
-    std::cout << std::endl << "XML error: " << e << std::endl;
+    std::cout << "Snapshot: " SKILLTREE_FN ": " << e << std::endl;
   }
 
-  std::cout << "Seeking XML: " SKILLTREE_FN " not found. EXIT!" << std::endl;
-  std::exit(EXIT_FAILURE);
+  try
+  {
+    this->parse_xml(this->get_filename());
+  }
+  catch (Exception& e)
+  {
+    /* Parse error occured. The caller reports this. */
+    std::cout << std::endl;
+    throw Exception("Cannot load " SKILLTREE_FN ": " + e);
+  }
+
+  /* Without a snapshot the XML file is parsed on the next start again. */
+  try
+  {
+    this->write_snapshot(this->get_snapshot_filename());
+  }
+  catch (Exception& e)
+  {
+    std::cout << "Snapshot: Cannot write " SKILLTREE_SNAPSHOT_FN ": "
+        << e << std::endl;
+  }
 }
 
 /* ---------------------------------------------------------------- */
@@ -63,41 +108,293 @@ ApiSkillTree::get_filename (void) const
 
 /* ---------------------------------------------------------------- */
 
+std::string
+ApiSkillTree::get_snapshot_filename (void) const
+{
+  return Config::get_conf_dir() + "/" SKILLTREE_SNAPSHOT_FN;
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 ApiSkillTree::parse_xml (std::string const& filename)
 {
   /* Try to read the document. */
-  XmlDocumentPtr xml = XmlDocument::create_from_file(filename);
-  xmlNodePtr root = xml->get_root_element();
+  XmlReaderPtr reader = XmlReader::create_from_file(filename);
+  reader->read_root();
 
   std::cout << "Parsing XML: " SKILLTREE_FN "... " << std::flush;
 
-  /* Document was parsed. Reset information. */
+  /* Document was opened. Reset information. */
   this->skills.clear();
   this->groups.clear();
-  this->parse_eveapi_tag(root);
+  this->parse_eveapi_tag(*reader);
+  reader->read_end();
+  this->build_dependency_graph();
+  this->update_name_index();
+
   std::cout << this->skills.size() << " skills." << std::endl;
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_eveapi_tag (xmlNodePtr node)
+ApiSkillTree::load_snapshot (std::string const& filename)
 {
-  if (node->type != XML_ELEMENT_NODE
-      || xmlStrcmp(node->name, (xmlChar const*)"eveapi"))
+  Snapshot snapshot;
+  snapshot.open(filename, this->get_filename(),
+      SKILLTREE_SNAPSHOT_VERSION, SKILLTREE_SNAP_SECTIONS);
+
+  std::cout << "Loading snapshot: " SKILLTREE_FN "... " << std::flush;
+
+  uint32_t const* groups = snapshot.get_section(SKILLTREE_SNAP_GROUPS);
+  std::size_t group_amount = snapshot.get_section_size
+      (SKILLTREE_SNAP_GROUPS) / SKILLTREE_SNAP_GROUP_WORDS;
+  uint32_t const* skills = snapshot.get_section(SKILLTREE_SNAP_SKILLS);
+  std::size_t amount = snapshot.get_section_size
+      (SKILLTREE_SNAP_SKILLS) / SKILLTREE_SNAP_SKILL_WORDS;
+  uint32_t const* deps = snapshot.get_section(SKILLTREE_SNAP_DEPS);
+  std::size_t deps_size = snapshot.get_section_size(SKILLTREE_SNAP_DEPS);
+  uint32_t const* edges = snapshot.get_section(SKILLTREE_SNAP_EDGES);
+  std::size_t edges_size = snapshot.get_section_size(SKILLTREE_SNAP_EDGES);
+  uint32_t const* prereqs = snapshot.get_section(SKILLTREE_SNAP_PREREQS);
+  std::size_t prereq_words = 5 * ((amount + 31) / 32);
+  if (snapshot.get_section_size(SKILLTREE_SNAP_PREREQS)
+      != amount * prereq_words)
+    throw Exception("Invalid prerequisites");
+
+  /* Snapshot is valid. Reset information. */
+  this->skills.clear();
+  this->groups.clear();
+  this->skill_list.clear();
+  this->skill_list.resize(amount, 0);
+  this->dep_skills.clear();
+  this->dep_skills.resize(amount);
+  this->enabled_skills.clear();
+  this->enabled_skills.resize(amount);
+  this->prerequisites.clear();
+  this->prerequisites.resize(amount);
+
+  for (std::size_t i = 0; i < group_amount; ++i)
+  {
+    uint32_t const* row = groups + i * SKILLTREE_SNAP_GROUP_WORDS;
+    ApiSkillGroup group;
+    group.id = (int)row[0];
+    group.name = snapshot.get_string(row[1]);
+    this->groups.insert(std::make_pair(group.id, group));
+  }
+
+  /* Skills are stored in ID order, which is also the map order. */
+  for (std::size_t i = 0; i < amount; ++i)
+  {
+    uint32_t const* row = skills + i * SKILLTREE_SNAP_SKILL_WORDS;
+    if (row[8] > row[9] || row[9] > deps_size / 2
+        || row[10] > row[11] || row[11] > edges_size / 2)
+      throw Exception("Invalid skill dependencies");
+
+    ApiSkill skill;
+    skill.index = (int)i;
+    skill.id = (int)row[0];
+    skill.group = (int)row[1];
+    skill.rank = (int)row[2];
+    skill.published = (int)row[3];
+    skill.primary = (ApiAttrib)row[4];
+    skill.secondary = (ApiAttrib)row[5];
+    skill.name = snapshot.get_string(row[6]);
+    skill.desc = snapshot.get_string(row[7]);
+    for (uint32_t j = row[8]; j < row[9]; ++j)
+      skill.deps.push_back(std::make_pair
+          ((int)deps[2 * j], (int)deps[2 * j + 1]));
+
+    if (i > 0 && skill.id <= this->skill_list[i - 1]->id)
+      throw Exception("Invalid skill order");
+
+    ApiSkillMap::iterator ins = this->skills.insert
+        (this->skills.end(), std::make_pair(skill.id, skill));
+    this->skill_list[i] = &ins->second;
+    this->prerequisites[i].set_bits(amount, prereqs + i * prereq_words);
+  }
+
+  /* Restore the prerequisite graph from the resolved edges. */
+  for (std::size_t i = 0; i < amount; ++i)
+  {
+    uint32_t const* row = skills + i * SKILLTREE_SNAP_SKILL_WORDS;
+    for (uint32_t j = row[10]; j < row[11]; ++j)
+    {
+      std::size_t dep_index = edges[2 * j];
+      int level = (int)edges[2 * j + 1];
+      if (dep_index >= amount)
+        throw Exception("Invalid skill dependencies");
+
+      this->dep_skills[i].push_back(std::make_pair
+          (this->skill_list[dep_index], level));
+      this->enabled_skills[dep_index].push_back(std::make_pair
+          (this->skill_list[i], level));
+    }
+  }
+
+  this->update_name_index();
+
+  std::cout << this->skills.size() << " skills." << std::endl;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillTree::write_snapshot (std::string const& filename)
+{
+  SnapshotWriter writer(SKILLTREE_SNAP_SECTIONS);
+
+  for (ApiSkillGroupMap::iterator iter = this->groups.begin();
+      iter != this->groups.end(); iter++)
+  {
+    writer.add(SKILLTREE_SNAP_GROUPS, (uint32_t)iter->second.id);
+    writer.add(SKILLTREE_SNAP_GROUPS, writer.add_string(iter->second.name));
+  }
+
+  uint32_t deps_pos = 0;
+  uint32_t edges_pos = 0;
+  for (std::size_t i = 0; i < this->skill_list.size(); ++i)
+  {
+    ApiSkill const& skill = *this->skill_list[i];
+    ApiSkillDepList const& edges = this->dep_skills[i];
+
+    uint32_t row[SKILLTREE_SNAP_SKILL_WORDS];
+    row[0] = (uint32_t)skill.id;
+    row[1] = (uint32_t)skill.group;
+    row[2] = (uint32_t)skill.rank;
+    row[3] = (uint32_t)skill.published;
+    row[4] = (uint32_t)skill.primary;
+    row[5] = (uint32_t)skill.secondary;
+    row[6] = writer.add_string(skill.name);
+    row[7] = writer.add_string(skill.desc);
+    row[8] = deps_pos;
+    deps_pos += (uint32_t)skill.deps.size();
+    row[9] = deps_pos;
+    row[10] = edges_pos;
+    edges_pos += (uint32_t)edges.size();
+    row[11] = edges_pos;
+    writer.add(SKILLTREE_SNAP_SKILLS, row, SKILLTREE_SNAP_SKILL_WORDS);
+
+    for (std::size_t j = 0; j < skill.deps.size(); ++j)
+    {
+      writer.add(SKILLTREE_SNAP_DEPS, (uint32_t)skill.deps[j].first);
+      writer.add(SKILLTREE_SNAP_DEPS, (uint32_t)skill.deps[j].second);
+    }
+
+    for (std::size_t j = 0; j < edges.size(); ++j)
+    {
+      writer.add(SKILLTREE_SNAP_EDGES, (uint32_t)edges[j].first->index);
+      writer.add(SKILLTREE_SNAP_EDGES, (uint32_t)edges[j].second);
+    }
+
+    std::vector<uint32_t> const& bits = this->prerequisites[i].get_bits();
+    writer.add(SKILLTREE_SNAP_PREREQS, &bits[0], bits.size());
+  }
+
+  writer.write(filename, this->get_filename(), SKILLTREE_SNAPSHOT_VERSION);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillTree::update_name_index (void)
+{
+  this->revision += 1;
+  this->name_index.clear();
+  for (ApiSkillMap::iterator iter = this->skills.begin();
+      iter != this->skills.end(); iter++)
+    this->name_index.add(iter->first, iter->second.name);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillTree::build_dependency_graph (void)
+{
+  /* Assign dense indices in skill ID order. */
+  this->skill_list.clear();
+  for (ApiSkillMap::iterator iter = this->skills.begin();
+      iter != this->skills.end(); iter++)
+  {
+    iter->second.index = (int)this->skill_list.size();
+    this->skill_list.push_back(&iter->second);
+  }
+
+  /* Resolve the direct dependencies and add the reverse edges. Unknown
+   * skills and skills requiring themselves are left out. */
+  std::size_t amount = this->skill_list.size();
+  this->dep_skills.clear();
+  this->dep_skills.resize(amount);
+  this->enabled_skills.clear();
+  this->enabled_skills.resize(amount);
+  for (std::size_t i = 0; i < amount; ++i)
+  {
+    ApiSkill const* skill = this->skill_list[i];
+    for (std::size_t j = 0; j < skill->deps.size(); ++j)
+    {
+      ApiSkill const* dep = this->get_skill_for_id(skill->deps[j].first);
+      if (dep == 0 || dep == skill)
+        continue;
+
+      int level = skill->deps[j].second;
+      this->dep_skills[i].push_back(std::make_pair(dep, level));
+      this->enabled_skills[(std::size_t)dep->index]
+          .push_back(std::make_pair(skill, level));
+    }
+  }
+
+  /* Calculate the transitive prerequisites in dependency order. */
+  this->prerequisites.clear();
+  this->prerequisites.resize(amount);
+  std::vector<int> state(amount, 0);
+  for (std::size_t i = 0; i < amount; ++i)
+    this->build_prerequisites(i, state);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillTree::build_prerequisites (std::size_t index, std::vector<int>& state)
+{
+  /* The state is 0 for new skills, 1 while visiting and 2 when done.
+   * Visiting skills again means the data has a cycle, which is cut. */
+  if (state[index] != 0)
+    return;
+
+  state[index] = 1;
+  ApiSkillLevels& prereqs = this->prerequisites[index];
+  prereqs.clear(this->skill_list.size());
+
+  ApiSkillDepList const& deps = this->dep_skills[index];
+  for (std::size_t i = 0; i < deps.size(); ++i)
+  {
+    std::size_t dep_index = (std::size_t)deps[i].first->index;
+    this->build_prerequisites(dep_index, state);
+    prereqs.set_level((int)dep_index, deps[i].second);
+    if (state[dep_index] == 2)
+      prereqs.merge(this->prerequisites[dep_index]);
+  }
+
+  state[index] = 2;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillTree::parse_eveapi_tag (XmlReader& reader)
+{
+  if (!reader.is_element("eveapi"))
     throw Exception("Invalid tag. Expecting <eveapi> node");
 
   /* Look for the result tag. */
-  for (node = node->children; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"result"))
+    if (reader.is_element("result"))
     {
       //std::cout << "Found <result> tag" << std::endl;
-      this->parse_result_tag(node->children);
+      this->parse_result_tag(reader);
     }
   }
 }
@@ -105,18 +402,16 @@ ApiSkillTree::parse_eveapi_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_result_tag (xmlNodePtr node)
+ApiSkillTree::parse_result_tag (XmlReader& reader)
 {
   /* Look for the rowset tag. It's for the skill group rowset. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
       //std::cout << "Found <rowset> tag for skillgroups" << std::endl;
-      this->parse_groups_rowset(node->children);
+      this->parse_groups_rowset(reader);
     }
   }
 }
@@ -124,22 +419,22 @@ ApiSkillTree::parse_result_tag (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_groups_rowset (xmlNodePtr node)
+ApiSkillTree::parse_groups_rowset (XmlReader& reader)
 {
   /* Look for row tags. These are for the skill groups. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiSkillGroup group;
-      group.name = this->get_property(node, "groupName");
-      group.id = this->get_property_int(node, "groupID");
+      group.name = this->get_property(reader, "groupName");
+      group.id = this->get_property_int(reader, "groupID");
 
       //std::cout << "Inserting group: " << group.name << std::endl;
       this->groups.insert(std::make_pair(group.id, group));
 
-      this->parse_groups_row(node->children);
+      this->parse_groups_row(reader);
     }
   }
 }
@@ -147,16 +442,16 @@ ApiSkillTree::parse_groups_rowset (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_groups_row (xmlNodePtr node)
+ApiSkillTree::parse_groups_row (XmlReader& reader)
 {
   /* Look for the rowset tag. It's forthe skills rowset. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"rowset"))
+    if (reader.is_element("rowset"))
     {
       //std::cout << "Found <rowset> tag for skills" << std::endl;
-      this->parse_skills_rowset(node->children);
+      this->parse_skills_rowset(reader);
     }
   }
 }
@@ -164,24 +459,24 @@ ApiSkillTree::parse_groups_row (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_skills_rowset (xmlNodePtr node)
+ApiSkillTree::parse_skills_rowset (XmlReader& reader)
 {
   /* Look for row tags. These are for the skills. */
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE
-        && !xmlStrcmp(node->name, (xmlChar const*)"row"))
+    if (reader.is_element("row"))
     {
       ApiSkill skill;
-      skill.name = this->get_property(node, "typeName");
-      skill.group = this->get_property_int(node, "groupID");
-      skill.id = this->get_property_int(node, "typeID");
-      skill.published = this->get_property_int(node, "published");
+      skill.name = this->get_property(reader, "typeName");
+      skill.group = this->get_property_int(reader, "groupID");
+      skill.id = this->get_property_int(reader, "typeID");
+      skill.published = this->get_property_int(reader, "published");
       skill.rank = 0;
       skill.primary = API_ATTRIB_UNKNOWN;
       skill.secondary = API_ATTRIB_UNKNOWN;
 
-      this->parse_skills_row(skill, node->children);
+      this->parse_skills_row(skill, reader);
 
       //std::cout << "Inserting skill:   " << skill.name << std::endl;
       this->skills.insert(std::make_pair(skill.id, skill));
@@ -192,44 +487,41 @@ ApiSkillTree::parse_skills_rowset (xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_skills_row (ApiSkill& skill, xmlNodePtr node)
+ApiSkillTree::parse_skills_row (ApiSkill& skill, XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type != XML_ELEMENT_NODE)
-      continue;
+    this->set_string_if_node_text(reader, "description", skill.desc);
+    this->set_int_if_node_text(reader, "rank", skill.rank);
 
-    this->set_string_if_node_text(node, "description", skill.desc);
-    this->set_int_if_node_text(node, "rank", skill.rank);
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset")
-        && this->get_property(node, "name") == "requiredSkills")
-      this->parse_skill_requirements(skill, node->children);
-
-    if (!xmlStrcmp(node->name, (xmlChar const*)"rowset")
-        && this->get_property(node, "name") == "skillBonusCollection")
-      this->parse_extra_skill_requirements(skill, node->children);
+    if (reader.is_element("rowset"))
+    {
+      std::string name = this->get_property(reader, "name");
+      if (name == "requiredSkills")
+        this->parse_skill_requirements(skill, reader);
+      else if (name == "skillBonusCollection")
+        this->parse_extra_skill_requirements(skill, reader);
+    }
 
-    if (!xmlStrcmp(node->name, (xmlChar const*)"requiredAttributes"))
-      this->parse_skill_attribs(skill, node->children);
+    if (reader.is_element("requiredAttributes"))
+      this->parse_skill_attribs(skill, reader);
   }
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_skill_requirements (ApiSkill& skill, xmlNodePtr node)
+ApiSkillTree::parse_skill_requirements (ApiSkill& skill, XmlReader& reader)
 {
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE)
+    if (reader.is_element("row"))
     {
-      if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
-      {
-        int type_id = this->get_property_int(node, "typeID");
-        int level = this->get_property_int(node, "skillLevel");
-        skill.deps.push_back(std::make_pair(type_id, level));
-      }
+      int type_id = this->get_property_int(reader, "typeID");
+      int level = this->get_property_int(reader, "skillLevel");
+      skill.deps.push_back(std::make_pair(type_id, level));
     }
   }
 }
@@ -237,27 +529,26 @@ ApiSkillTree::parse_skill_requirements (ApiSkill& skill, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_extra_skill_requirements (ApiSkill& skill, xmlNodePtr node)
+ApiSkillTree::parse_extra_skill_requirements (ApiSkill& skill,
+    XmlReader& reader)
 {
   std::map<std::string,int> data;
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE)
+    if (reader.is_element("row"))
     {
-      if (!xmlStrcmp(node->name, (xmlChar const*)"row"))
-      {
-        std::string bonusType = this->get_property(node, "bonusType");
-        int value = this->get_property_int(node, "bonusValue");
-        data[bonusType] = value;
-        std::string suffix = bonusType.substr(bonusType.size() - 5, bonusType.size());
-        std::string basename = bonusType.substr(0, bonusType.size() - 5);
-        // check whether the other value was already inserted
-        if(data.count(bonusType + "Level") == 1 || data.count(basename) == 1) {
-          if(suffix == "Level") {
-            skill.deps.push_back(std::make_pair(data[basename], value));
-          } else {
-            skill.deps.push_back(std::make_pair(value, data[bonusType + "Level"]));
-          }
+      std::string bonusType = this->get_property(reader, "bonusType");
+      int value = this->get_property_int(reader, "bonusValue");
+      data[bonusType] = value;
+      std::string suffix = bonusType.substr(bonusType.size() - 5, bonusType.size());
+      std::string basename = bonusType.substr(0, bonusType.size() - 5);
+      // check whether the other value was already inserted
+      if(data.count(bonusType + "Level") == 1 || data.count(basename) == 1) {
+        if(suffix == "Level") {
+          skill.deps.push_back(std::make_pair(data[basename], value));
+        } else {
+          skill.deps.push_back(std::make_pair(value, data[bonusType + "Level"]));
         }
       }
     }
@@ -267,18 +558,16 @@ ApiSkillTree::parse_extra_skill_requirements (ApiSkill& skill, xmlNodePtr node)
 /* ---------------------------------------------------------------- */
 
 void
-ApiSkillTree::parse_skill_attribs (ApiSkill& skill, xmlNodePtr node)
+ApiSkillTree::parse_skill_attribs (ApiSkill& skill, XmlReader& reader)
 {
   std::string primary;
   std::string secondary;
 
-  for (; node != 0; node = node->next)
+  int depth = reader.get_depth();
+  while (reader.next_child(depth))
   {
-    if (node->type == XML_ELEMENT_NODE)
-    {
-      this->set_string_if_node_text(node, "primaryAttribute", primary);
-      this->set_string_if_node_text(node, "secondaryAttribute", secondary);
-    }
+    this->set_string_if_node_text(reader, "primaryAttribute", primary);
+    this->set_string_if_node_text(reader, "secondaryAttribute", secondary);
   }
 
   this->set_attribute(skill.primary, primary);
@@ -395,6 +684,49 @@ ApiSkillTree::count_total_skills (void) const
 }
 /* ---------------------------------------------------------------- */
 
+void
+ApiSkillLevels::clear (std::size_t skill_amount)
+{
+  this->words = (skill_amount + 31) / 32;
+  this->bits.clear();
+  this->bits.resize(5 * this->words, 0);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillLevels::merge (ApiSkillLevels const& other)
+{
+  for (std::size_t i = 0; i < this->bits.size() && i < other.bits.size(); ++i)
+    this->bits[i] |= other.bits[i];
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ApiSkillLevels::set_bits (std::size_t skill_amount, uint32_t const* bits)
+{
+  this->words = (skill_amount + 31) / 32;
+  this->bits.assign(bits, bits + 5 * this->words);
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+ApiSkillLevels::contains (ApiSkillLevels const& other) const
+{
+  for (std::size_t i = 0; i < other.bits.size(); ++i)
+  {
+    uint32_t mine = (i < this->bits.size() ? this->bits[i] : 0);
+    if (other.bits[i] & ~mine)
+      return false;
+  }
+
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 ApiSkill::debug (void) const
 {
@@ -16,8 +16,10 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <stdint.h>
 
 #include "util/ref_ptr.h"
+#include "util/searchindex.h"
 #include "apibase.h"
 
 enum ApiAttrib
@@ -43,6 +45,8 @@ struct ApiSkillGroup
 class ApiSkill : public ApiElement
 {
   public:
+    /* Dense index of the skill, assigned by the skill tree. */
+    int index;
     int id;
     int group;
     int rank;
@@ -62,46 +66,123 @@ class ApiSkill : public ApiElement
 
 /* ---------------------------------------------------------------- */
 
+/*
+ * A set of skill levels over the dense skill indices. There is a bitset
+ * for every level containing the skills with at least that level, so
+ * set operations are simple word-wise bit operations.
+ */
+class ApiSkillLevels
+{
+  private:
+    std::size_t words;
+    std::vector<uint32_t> bits;
+
+  public:
+    ApiSkillLevels (void);
+
+    /* Removes all skills and resizes the set for the amount of skills. */
+    void clear (std::size_t skill_amount);
+    /* Raises the level of a skill, lower levels are ignored. */
+    void set_level (int index, int level);
+    int get_level (int index) const;
+    bool has_level (int index, int level) const;
+
+    /* Adds all skill levels of the other set to this set. */
+    void merge (ApiSkillLevels const& other);
+    /* Checks if every skill level of the other set is in this set. */
+    bool contains (ApiSkillLevels const& other) const;
+
+    /* Access to the bitsets for the skill tree snapshot. */
+    std::vector<uint32_t> const& get_bits (void) const;
+    void set_bits (std::size_t skill_amount, uint32_t const* bits);
+};
+
+/* ---------------------------------------------------------------- */
+
 class ApiSkillTree;
 typedef ref_ptr<ApiSkillTree> ApiSkillTreePtr;
 typedef std::map<int, ApiSkill> ApiSkillMap;
 typedef std::map<int, ApiSkillGroup> ApiSkillGroupMap;
+typedef std::vector<std::pair<ApiSkill const*, int> > ApiSkillDepList;
 
 class ApiSkillTree : public ApiBase
 {
   private:
     static ApiSkillTreePtr instance;
 
+    /* The prerequisite graph over the dense skill indices. Edges point
+     * to the required skills and back to the skills that require them.
+     * The transitive prerequisites are stored with the highest level
+     * required along any path. */
+    std::vector<ApiSkill const*> skill_list;
+    std::vector<ApiSkillDepList> dep_skills;
+    std::vector<ApiSkillDepList> enabled_skills;
+    std::vector<ApiSkillLevels> prerequisites;
+
+    /* The skill names for the skill browser filter. */
+    SearchIndex name_index;
+
   protected:
     ApiSkillTree (void);
     void parse_xml (std::string const& filename);
-    void parse_eveapi_tag (xmlNodePtr node);
-    void parse_result_tag (xmlNodePtr node);
-    void parse_groups_rowset (xmlNodePtr node);
-    void parse_groups_row (xmlNodePtr node);
-    void parse_skills_rowset (xmlNodePtr node);
-    void parse_skills_row (ApiSkill& skill, xmlNodePtr node);
-    void parse_skill_requirements (ApiSkill& skill, xmlNodePtr node);
-    void parse_extra_skill_requirements (ApiSkill& skill, xmlNodePtr node);
-    void parse_skill_attribs (ApiSkill& skill, xmlNodePtr node);
+    void load_snapshot (std::string const& filename);
+    void write_snapshot (std::string const& filename);
+    void update_name_index (void);
+    void parse_eveapi_tag (XmlReader& reader);
+    void parse_result_tag (XmlReader& reader);
+    void parse_groups_rowset (XmlReader& reader);
+    void parse_groups_row (XmlReader& reader);
+    void parse_skills_rowset (XmlReader& reader);
+    void parse_skills_row (ApiSkill& skill, XmlReader& reader);
+    void parse_skill_requirements (ApiSkill& skill, XmlReader& reader);
+    void parse_extra_skill_requirements (ApiSkill& skill,
+        XmlReader& reader);
+    void parse_skill_attribs (ApiSkill& skill, XmlReader& reader);
 
     void set_attribute (ApiAttrib& var, std::string const& str);
 
+    void build_dependency_graph (void);
+    void build_prerequisites (std::size_t index, std::vector<int>& state);
+
   public:
     std::string filename;
     ApiSkillMap skills;
     ApiSkillGroupMap groups;
 
+    /* Incremented whenever the tree is reloaded. Allows consumers
+     * to cheaply detect stale pointers to skills and groups. */
+    unsigned int revision;
+
   public:
+    /* Loads the tree on first use. Throws if it cannot be loaded. */
     static ApiSkillTreePtr request (void);
+    /* Loads the snapshot or parses the XML file, or throws. */
     void refresh (void);
     std::string get_filename (void) const;
+    std::string get_snapshot_filename (void) const;
 
     int count_total_skills (void) const;
     ApiSkill const* get_skill_for_id (int id) const;
     ApiSkill const* get_skill_for_name (std::string const& name) const;
     ApiSkillGroup const* get_group_for_id (int id) const;
 
+    /* Queries on the prerequisite graph. These are cheap. */
+    std::size_t get_skill_amount (void) const;
+    ApiSkill const* get_skill_for_index (int index) const;
+    /* Returns the skills that are directly required. */
+    ApiSkillDepList const& get_dependencies (ApiSkill const* skill) const;
+    /* Returns the skills that directly require the skill. */
+    ApiSkillDepList const& get_enabled_skills (ApiSkill const* skill) const;
+    /* Returns all skills that are required, directly or indirectly. */
+    ApiSkillLevels const& get_prerequisites (ApiSkill const* skill) const;
+    int get_required_level (ApiSkill const* skill,
+        ApiSkill const* prereq) const;
+    bool has_prerequisites (ApiSkill const* skill,
+        ApiSkillLevels const& known) const;
+
+    /* Returns the index over the skill names, reporting skill IDs. */
+    SearchIndex const& get_name_index (void) const;
+
     static char const* get_attrib_name (ApiAttrib const& attrib);
     static char const* get_attrib_short_name (ApiAttrib const& attrib);
 };
@@ -114,4 +195,95 @@ ApiSkill::get_type (void) const
   return API_ELEM_SKILL;
 }
 
+inline
+ApiSkillLevels::ApiSkillLevels (void)
+  : words(0)
+{
+}
+
+inline void
+ApiSkillLevels::set_level (int index, int level)
+{
+  for (int i = 0; i < level && i < 5; ++i)
+    this->bits[(std::size_t)i * this->words + (std::size_t)index / 32]
+        |= (uint32_t)1 << (index % 32);
+}
+
+inline bool
+ApiSkillLevels::has_level (int index, int level) const
+{
+  if (level <= 0)
+    return true;
+  if (level > 5)
+    return false;
+  return (this->bits[(std::size_t)(level - 1) * this->words
+      + (std::size_t)index / 32] >> (index % 32)) & 1;
+}
+
+inline int
+ApiSkillLevels::get_level (int index) const
+{
+  int level = 0;
+  while (level < 5 && this->has_level(index, level + 1))
+    level += 1;
+  return level;
+}
+
+inline std::vector<uint32_t> const&
+ApiSkillLevels::get_bits (void) const
+{
+  return this->bits;
+}
+
+inline std::size_t
+ApiSkillTree::get_skill_amount (void) const
+{
+  return this->skill_list.size();
+}
+
+inline ApiSkill const*
+ApiSkillTree::get_skill_for_index (int index) const
+{
+  return this->skill_list[(std::size_t)index];
+}
+
+inline SearchIndex const&
+ApiSkillTree::get_name_index (void) const
+{
+  return this->name_index;
+}
+
+inline ApiSkillDepList const&
+ApiSkillTree::get_dependencies (ApiSkill const* skill) const
+{
+  return this->dep_skills[(std::size_t)skill->index];
+}
+
+inline ApiSkillDepList const&
+ApiSkillTree::get_enabled_skills (ApiSkill const* skill) const
+{
+  return this->enabled_skills[(std::size_t)skill->index];
+}
+
+inline ApiSkillLevels const&
+ApiSkillTree::get_prerequisites (ApiSkill const* skill) const
+{
+  return this->prerequisites[(std::size_t)skill->index];
+}
+
+inline int
+ApiSkillTree::get_required_level (ApiSkill const* skill,
+    ApiSkill const* prereq) const
+{
+  return this->prerequisites[(std::size_t)skill->index]
+      .get_level(prereq->index);
+}
+
+inline bool
+ApiSkillTree::has_prerequisites (ApiSkill const* skill,
+    ApiSkillLevels const& known) const
+{
+  return known.contains(this->prerequisites[(std::size_t)skill->index]);
+}
+
 #endif /* API_SKILL_TREE_HEADER */
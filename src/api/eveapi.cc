@@ -126,28 +126,15 @@ EveApiFetcher::async_reply (AsyncHttpData data)
 void
 EveApiFetcher::process_caching (EveApiData& data)
 {
-  /* Generate filename to use as cache. */
   std::string xmlname = this->get_doc_name();
   std::string path = Config::get_conf_dir();
   path += "/sheets";
-  std::string file = path;
-  file += "/";
-  switch (this->type)
+  std::string file = this->get_cache_filename();
+  if (file.empty())
   {
-    case API_DOCTYPE_CHARLIST:
-      file += this->auth.user_id;
-      break;
-    case API_DOCTYPE_SKILLQUEUE:
-    case API_DOCTYPE_INTRAINING:
-    case API_DOCTYPE_CHARSHEET:
-      file += this->auth.char_id;
-      break;
-    default:
-      std::cout << "Error: Invalid API document type!" << std::endl;
-      return;
+    std::cout << "Error: Invalid API document type!" << std::endl;
+    return;
   }
-  file += "_";
-  file += xmlname;
 
   if (!data.exception.empty())
     std::cout << "Warning: " << data.exception << std::endl;
@@ -183,31 +170,69 @@ EveApiFetcher::process_caching (EveApiData& data)
   {
     /* Read unsuccessful requests from cache if available. */
     //std::cout << "Should read from cache: " << file << std::endl;
-    bool file_exists = OS::file_exists(file.c_str());
-    if (!file_exists)
+    if (!this->load_from_cache(data))
     {
       std::cout << "Warning: No cache file for " << xmlname << std::endl;
       return;
     }
 
-    /* Read from file. */
-    std::string input;
-    std::ifstream in(file.c_str());
-    while (!in.eof())
-    {
-      std::string line;
-      std::getline(in, line);
-      input += line;
-    }
-    in.close();
+    std::cout << "Warning: Using " << xmlname << " from cache!" << std::endl;
+  }
+}
 
-    data.data = HttpData::create();
-    data.data->data.resize(input.size() + 1);
-    data.locally_cached = true;
-    ::memcpy(&data.data->data[0], input.c_str(), input.size() + 1);
+/* ---------------------------------------------------------------- */
 
-    std::cout << "Warning: Using " << xmlname << " from cache!" << std::endl;
+bool
+EveApiFetcher::load_from_cache (EveApiData& data)
+{
+  std::string file = this->get_cache_filename();
+  if (file.empty() || !OS::file_exists(file.c_str()))
+    return false;
+
+  /* Read from file. */
+  std::string input;
+  std::ifstream in(file.c_str());
+  while (!in.eof())
+  {
+    std::string line;
+    std::getline(in, line);
+    input += line;
   }
+  in.close();
+
+  data.data = HttpData::create();
+  data.data->data.resize(input.size() + 1);
+  data.locally_cached = true;
+  ::memcpy(&data.data->data[0], input.c_str(), input.size() + 1);
+
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
+std::string
+EveApiFetcher::get_cache_filename (void)
+{
+  /* Generate filename to use as cache. */
+  std::string file = Config::get_conf_dir();
+  file += "/sheets/";
+  switch (this->type)
+  {
+    case API_DOCTYPE_CHARLIST:
+      file += this->auth.user_id;
+      break;
+    case API_DOCTYPE_SKILLQUEUE:
+    case API_DOCTYPE_INTRAINING:
+    case API_DOCTYPE_CHARSHEET:
+      file += this->auth.char_id;
+      break;
+    default:
+      return std::string();
+  }
+  file += "_";
+  file += this->get_doc_name();
+
+  return file;
 }
 
 /* ---------------------------------------------------------------- */
@@ -78,6 +78,7 @@ class EveApiFetcher
     AsyncHttp* setup_fetcher (void);
     void async_reply (AsyncHttpData data);
     void process_caching (EveApiData& data);
+    std::string get_cache_filename (void);
     char const* get_doc_name (void);
 
   public:
@@ -91,6 +92,10 @@ class EveApiFetcher
     void request (void);
     void async_request (void);
 
+    /* Reads the document from the local cache without requesting it.
+     * Returns false if the document has not been cached yet. */
+    bool load_from_cache (EveApiData& data);
+
     sigc::signal<void, EveApiData>& signal_done (void);
     bool is_busy (void);
 };
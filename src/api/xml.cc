@@ -51,6 +51,179 @@ XmlDocument::get_root_element (void)
 
 /* ================================================================ */
 
+XmlReaderPtr
+XmlReader::create_from_file (std::string const& filename)
+{
+  XmlReaderPtr reader = XmlReaderPtr(new XmlReader);
+  Helpers::read_file(filename, &reader->contents, true);
+  reader->open(reader->contents.c_str(), reader->contents.size());
+  return reader;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlReader::open (char const* data, std::size_t size)
+{
+  /* HTTP data is NUL terminated, which the reader takes as content. */
+  if (size > 0 && data[size - 1] == '\0')
+    size -= 1;
+
+  this->reader = xmlReaderForMemory(data, (int)size, 0, 0, 0);
+  if (this->reader == 0)
+    throw Exception("Document not parsed successfully!");
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlReader::read (void)
+{
+  int ret = xmlTextReaderRead(this->reader);
+  if (ret < 0)
+    throw Exception("Document not parsed successfully!");
+
+  return ret == 1;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlReader::read_root (void)
+{
+  while (this->read())
+    if (xmlTextReaderNodeType(this->reader) == XML_READER_TYPE_ELEMENT)
+      return;
+
+  throw Exception("Document has no root element!");
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlReader::next_child (int depth)
+{
+  /* Empty elements have no children and no end tag. */
+  if (xmlTextReaderNodeType(this->reader) == XML_READER_TYPE_ELEMENT
+      && xmlTextReaderDepth(this->reader) == depth
+      && xmlTextReaderIsEmptyElement(this->reader))
+    return false;
+
+  while (this->read())
+  {
+    int node_depth = xmlTextReaderDepth(this->reader);
+    if (node_depth <= depth)
+      return false;
+
+    if (node_depth == depth + 1
+        && xmlTextReaderNodeType(this->reader) == XML_READER_TYPE_ELEMENT)
+      return true;
+  }
+
+  return false;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlReader::read_end (void)
+{
+  while (this->read())
+    ;
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlReader::is_element (char const* name)
+{
+  return xmlTextReaderNodeType(this->reader) == XML_READER_TYPE_ELEMENT
+      && !xmlStrcmp(xmlTextReaderConstLocalName(this->reader),
+      (xmlChar const*)name);
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlReader::get_attribute (char const* name, std::string& value)
+{
+  xmlChar* text = xmlTextReaderGetAttribute(this->reader,
+      (xmlChar const*)name);
+  if (text == 0)
+    return false;
+  value = (char const*)text;
+  xmlFree(text);
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlReader::get_text (std::string& text)
+{
+  if (xmlTextReaderNodeType(this->reader) != XML_READER_TYPE_ELEMENT)
+    return false;
+
+  /* Elements without text have no content string. */
+  xmlChar* content = xmlTextReaderReadString(this->reader);
+  if (content == 0)
+  {
+    text.clear();
+    return true;
+  }
+  text = (char const*)content;
+  xmlFree(content);
+  return true;
+}
+
+/* ================================================================ */
+
+void
+XmlParserSink::open (void)
+{
+  if (this->context != 0)
+    xmlFreeParserCtxt(this->context);
+
+  /* Without callbacks the parser only checks the document. */
+  xmlSAXHandler sax;
+  std::memset(&sax, 0, sizeof(sax));
+  this->context = xmlCreatePushParserCtxt(&sax, 0, 0, 0, 0);
+  if (this->context == 0)
+    throw Exception("Cannot create XML parser");
+  xmlCtxtUseOptions(this->context,
+      XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_NONET);
+  this->is_valid = true;
+
+  this->target->open();
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+XmlParserSink::write (char const* data, std::size_t size)
+{
+  if (this->is_valid && xmlParseChunk(this->context, data, (int)size, 0) != 0)
+    this->is_valid = false;
+
+  return this->target->write(data, size);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlParserSink::close (bool success)
+{
+  if (success && this->is_valid
+      && xmlParseChunk(this->context, 0, 0, 1) != 0)
+    this->is_valid = false;
+
+  this->target->close(success && this->is_valid);
+  if (success && !this->is_valid)
+    throw Exception("Document not parsed successfully!");
+}
+
+/* ================================================================ */
+
 std::string
 XmlBase::get_node_text (xmlNodePtr node)
 {
@@ -133,3 +306,74 @@ XmlBase::set_bool_if_node_text (xmlNodePtr node, char const* node_name,
   if (!xmlStrcmp(node->name, (xmlChar const*)node_name))
     target = (bool)Helpers::get_int_from_string(this->get_node_text(node));
 }
+
+/* ---------------------------------------------------------------- */
+
+std::string
+XmlBase::get_node_text (XmlReader& reader)
+{
+  std::string text;
+  if (!reader.get_text(text))
+    throw Exception("Could not retrieve error node text");
+  return text;
+}
+
+/* ---------------------------------------------------------------- */
+
+std::string
+XmlBase::get_property (XmlReader& reader, char const* name)
+{
+  std::string value;
+  if (!reader.get_attribute(name, value))
+    throw Exception(std::string("Could not find property \"") + name + "\"");
+  return value;
+}
+
+/* ---------------------------------------------------------------- */
+
+int
+XmlBase::get_property_int (XmlReader& reader, char const* name)
+{
+  std::string prop_str = this->get_property(reader, name);
+  return Helpers::get_int_from_string(prop_str);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlBase::set_string_if_node_text (XmlReader& reader, char const* node_name,
+    std::string& target)
+{
+  if (reader.is_element(node_name))
+    target = this->get_node_text(reader);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlBase::set_int_if_node_text (XmlReader& reader, char const* node_name,
+    int& target)
+{
+  if (reader.is_element(node_name))
+    target = Helpers::get_int_from_string(this->get_node_text(reader));
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlBase::set_uint_if_node_text (XmlReader& reader, char const* node_name,
+    unsigned int& target)
+{
+  if (reader.is_element(node_name))
+    target = Helpers::get_uint_from_string(this->get_node_text(reader));
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+XmlBase::set_double_if_node_text (XmlReader& reader, char const* node_name,
+    double& target)
+{
+  if (reader.is_element(node_name))
+    target = Helpers::get_double_from_string(this->get_node_text(reader));
+}
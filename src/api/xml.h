@@ -16,8 +16,10 @@
 #include <string>
 #include <libxml/xmlmemory.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 
 #include "util/ref_ptr.h"
+#include "net/httpsink.h"
 
 class XmlDocument;
 typedef ref_ptr<XmlDocument> XmlDocumentPtr;
@@ -45,6 +47,76 @@ class XmlDocument
 
 /* ---------------------------------------------------------------- */
 
+class XmlReader;
+typedef ref_ptr<XmlReader> XmlReaderPtr;
+
+/*
+ * Streaming access to a document, which is read once without building
+ * the document tree. The reader is positioned on one node at a time.
+ * The children of an element are visited with next_child(), which skips
+ * all nodes the caller did not descend into. The data passed to create()
+ * must stay valid while the reader is used.
+ */
+class XmlReader
+{
+  private:
+    xmlTextReaderPtr reader;
+    std::string contents;
+
+  protected:
+    XmlReader (void);
+    void open (char const* data, std::size_t size);
+    bool read (void);
+
+  public:
+    static XmlReaderPtr create (char const* data, std::size_t size);
+    static XmlReaderPtr create_from_file (std::string const& filename);
+    ~XmlReader (void);
+
+    /* Moves to the root element. */
+    void read_root (void);
+    /* Moves to the next child element of the element at the given depth.
+     * Returns false at the end of that element. */
+    bool next_child (int depth);
+    /* Reads the rest of the document to detect errors after the data. */
+    void read_end (void);
+
+    int get_depth (void);
+    bool is_element (char const* name);
+    bool get_attribute (char const* name, std::string& value);
+    bool get_text (std::string& text);
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Checks that a HTTP body is a well-formed document while it is
+ * transferred and passes the body on to the target sink. The parser
+ * builds no document tree. If the document is not well-formed, the
+ * target sink is closed without success and the close throws.
+ */
+class XmlParserSink : public HttpSink
+{
+  private:
+    HttpSinkPtr target;
+    xmlParserCtxtPtr context;
+    bool is_valid;
+
+  protected:
+    XmlParserSink (HttpSinkPtr target);
+
+  public:
+    static HttpSinkPtr create (HttpSinkPtr target);
+    ~XmlParserSink (void);
+
+    void open (void);
+    void reserve (std::size_t size);
+    bool write (char const* data, std::size_t size);
+    void close (bool success);
+};
+
+/* ---------------------------------------------------------------- */
+
 class XmlBase
 {
   protected:
@@ -63,6 +135,20 @@ class XmlBase
         double& target);
     void set_bool_if_node_text (xmlNodePtr node, char const* node_name,
         bool& target);
+
+    /* The same helpers for the element at the reader position. */
+    std::string get_property (XmlReader& reader, char const* name);
+    int get_property_int (XmlReader& reader, char const* name);
+    std::string get_node_text (XmlReader& reader);
+
+    void set_string_if_node_text (XmlReader& reader, char const* node_name,
+        std::string& target);
+    void set_int_if_node_text (XmlReader& reader, char const* node_name,
+        int& target);
+    void set_uint_if_node_text (XmlReader& reader, char const* node_name,
+        unsigned int& target);
+    void set_double_if_node_text (XmlReader& reader, char const* node_name,
+        double& target);
 };
 
 /* ---------------------------------------------------------------- */
@@ -109,4 +195,56 @@ XmlDocument::~XmlDocument (void)
   xmlFreeDoc(this->doc);
 }
 
+inline
+XmlReader::XmlReader (void)
+{
+  this->reader = 0;
+}
+
+inline XmlReaderPtr
+XmlReader::create (char const* data, std::size_t size)
+{
+  XmlReaderPtr reader = XmlReaderPtr(new XmlReader);
+  reader->open(data, size);
+  return reader;
+}
+
+inline
+XmlReader::~XmlReader (void)
+{
+  if (this->reader != 0)
+    xmlFreeTextReader(this->reader);
+}
+
+inline int
+XmlReader::get_depth (void)
+{
+  return xmlTextReaderDepth(this->reader);
+}
+
+inline
+XmlParserSink::XmlParserSink (HttpSinkPtr target)
+  : target(target), context(0), is_valid(false)
+{
+}
+
+inline HttpSinkPtr
+XmlParserSink::create (HttpSinkPtr target)
+{
+  return HttpSinkPtr(new XmlParserSink(target));
+}
+
+inline
+XmlParserSink::~XmlParserSink (void)
+{
+  if (this->context != 0)
+    xmlFreeParserCtxt(this->context);
+}
+
+inline void
+XmlParserSink::reserve (std::size_t size)
+{
+  this->target->reserve(size);
+}
+
 #endif /* XML_HEADER */
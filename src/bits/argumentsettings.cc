@@ -9,6 +9,7 @@ int ArgumentSettings::argc = 0;
 char** ArgumentSettings::argv = 0;
 bool ArgumentSettings::start_minimized = false;
 std::string ArgumentSettings::config_dir = "";
+bool ArgumentSettings::startup_profile = false;
 
 /* ---------------------------------------------------------------- */
 
@@ -20,6 +21,8 @@ ArgumentSettings::show_help (void)
       << "  -c DIR, --config-dir DIR  Use DIR as config directory" << std::endl
       << "  -h, --help                Display this helpful text" << std::endl
       << "  -m, --start-minimized     Start gtkevemon minimized" << std::endl
+      << "  --startup-profile         Print the time spent during startup"
+      << std::endl
       << "  -v, --version             Display version and exit" << std::endl;
 }
 
@@ -40,6 +43,10 @@ ArgumentSettings::init (int argc, char** argv)
     {
       ArgumentSettings::start_minimized = true;
     }
+    else if (sw == "--startup-profile")
+    {
+      ArgumentSettings::startup_profile = true;
+    }
     else if (sw == "-h" || sw == "--help")
     {
       ArgumentSettings::show_help();
@@ -26,6 +26,7 @@ class ArgumentSettings
 
     static bool start_minimized;
     static std::string config_dir;
+    static bool startup_profile;
 
   public:
     static void init (int argc, char** argv);
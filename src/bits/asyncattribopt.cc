@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "util/os.h"
+#include "asyncattribopt.h"
+
+class AttribOptWorker : public Thread
+{
+  private:
+    AsyncAttribOpt* owner;
+  protected:
+    void* run (void);
+  public:
+    AttribOptWorker (AsyncAttribOpt* owner);
+};
+
+/* ---------------------------------------------------------------- */
+
+AttribOptWorker::AttribOptWorker (AsyncAttribOpt* owner)
+    : owner(owner)
+{
+}
+
+void*
+AttribOptWorker::run (void)
+{
+  this->owner->process_slices();
+  return 0;
+}
+
+/* ================================================================ */
+
+AsyncAttribOpt::AsyncAttribOpt (AttribOptimizer const& optimizer,
+    ApiCharAttribs const& base, ApiCharAttribs const& implant)
+  : optimizer(optimizer), base(base), implant(implant)
+{
+  this->next_slice = 0;
+  this->finished_slices = 0;
+  this->finished_workers = 0;
+  this->cancelled = false;
+
+  this->sig_dispatch_progress.connect(sigc::mem_fun
+      (*this, &AsyncAttribOpt::dispatch_progress));
+  this->sig_dispatch_done.connect(sigc::mem_fun
+      (*this, &AsyncAttribOpt::dispatch_done));
+}
+
+/* ---------------------------------------------------------------- */
+
+AsyncAttribOpt::~AsyncAttribOpt (void)
+{
+  for (std::size_t i = 0; i < this->workers.size(); ++i)
+    delete this->workers[i];
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncAttribOpt::start (void)
+{
+  /* Every slice starts with the original attributes. */
+  AttribOptResult initial = this->optimizer.get_initial_result
+      (this->base, this->implant);
+  this->slices.resize((std::size_t)AttribOptimizer::get_slice_amount(),
+      initial);
+
+  /* All workers are created before the first one runs because the
+   * workers use the amount of workers to detect the last one. */
+  std::size_t num_workers = std::min((std::size_t)OS::get_num_processors(),
+      this->slices.size());
+  for (std::size_t i = 0; i < num_workers; ++i)
+    this->workers.push_back(new AttribOptWorker(this));
+  for (std::size_t i = 0; i < num_workers; ++i)
+    this->workers[i]->pt_create();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncAttribOpt::cancel (void)
+{
+  this->mutex.wait();
+  this->cancelled = true;
+  this->mutex.post();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncAttribOpt::process_slices (void)
+{
+  while (true)
+  {
+    /* Fetch the next slice that has not been searched yet. */
+    this->mutex.wait();
+    if (this->cancelled || this->next_slice == this->slices.size())
+    {
+      this->finished_workers += 1;
+      bool last_worker = (this->finished_workers == this->workers.size());
+      this->mutex.post();
+
+      if (last_worker)
+        this->sig_dispatch_done.emit();
+      return;
+    }
+    std::size_t slice = this->next_slice;
+    this->next_slice += 1;
+    this->mutex.post();
+
+    /* Every slice has its own result, no locking required. */
+    this->optimizer.optimize_slice(this->base, this->implant,
+        (int)slice, this->slices[slice]);
+
+    this->mutex.wait();
+    this->finished_slices += 1;
+    this->mutex.post();
+
+    this->sig_dispatch_progress.emit();
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncAttribOpt::dispatch_progress (void)
+{
+  this->mutex.wait();
+  bool cancelled = this->cancelled;
+  double fraction = (double)this->finished_slices
+      / (double)this->slices.size();
+  this->mutex.post();
+
+  if (!cancelled)
+    this->sig_progress.emit(fraction);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncAttribOpt::dispatch_done (void)
+{
+  for (std::size_t i = 0; i < this->workers.size(); ++i)
+    this->workers[i]->pt_join();
+
+  /* Merging the slices in order gives the same tie-breaking as the
+   * serial search, independent of the order the workers finished. */
+  if (!this->cancelled)
+  {
+    AttribOptResult result = this->slices[0];
+    for (std::size_t i = 1; i < this->slices.size(); ++i)
+      AttribOptimizer::merge_result(result, this->slices[i]);
+    this->sig_done.emit(result);
+  }
+
+  delete this;
+}
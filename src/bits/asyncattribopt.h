@@ -0,0 +1,102 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASYNC_ATTRIB_OPT_HEADER
+#define ASYNC_ATTRIB_OPT_HEADER
+
+#include <vector>
+#include <glibmm/dispatcher.h>
+
+#include "util/thread.h"
+#include "attriboptimizer.h"
+
+class AttribOptWorker;
+
+/* Class for running the attribute optimizer in the background. The
+ * slices of the search are distributed to a pool of worker threads,
+ * one thread per processor. Instructions:
+ * - Create class with create()
+ * - Connect to the progress and done signals
+ * - Run start()
+ * - The result is delivered to all done signal subscribers
+ * - Call cancel() if not interested anymore, no signals are emitted then
+ * - No need to free, automatic deletion if all threads are finished
+ */
+class AsyncAttribOpt
+{
+  friend class AttribOptWorker;
+
+  private:
+    AttribOptimizer optimizer;
+    ApiCharAttribs base;
+    ApiCharAttribs implant;
+
+    std::vector<AttribOptResult> slices;
+    std::vector<AttribOptWorker*> workers;
+
+    /* Protects the counters and the cancel flag. */
+    Semaphore mutex;
+    std::size_t next_slice;
+    std::size_t finished_slices;
+    std::size_t finished_workers;
+    bool cancelled;
+
+    Glib::Dispatcher sig_dispatch_progress;
+    Glib::Dispatcher sig_dispatch_done;
+    sigc::signal<void, double> sig_progress;
+    sigc::signal<void, AttribOptResult> sig_done;
+
+  protected:
+    AsyncAttribOpt (AttribOptimizer const& optimizer,
+        ApiCharAttribs const& base, ApiCharAttribs const& implant);
+    ~AsyncAttribOpt (void);
+
+    /* Executed by the worker threads. */
+    void process_slices (void);
+
+    void dispatch_progress (void);
+    void dispatch_done (void);
+
+  public:
+    static AsyncAttribOpt* create (AttribOptimizer const& optimizer,
+        ApiCharAttribs const& base, ApiCharAttribs const& implant);
+
+    void start (void);
+    void cancel (void);
+
+    /* The progress is reported as fraction between 0 and 1. */
+    sigc::signal<void, double>& signal_progress (void);
+    sigc::signal<void, AttribOptResult>& signal_done (void);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline AsyncAttribOpt*
+AsyncAttribOpt::create (AttribOptimizer const& optimizer,
+    ApiCharAttribs const& base, ApiCharAttribs const& implant)
+{
+  return new AsyncAttribOpt(optimizer, base, implant);
+}
+
+inline sigc::signal<void, double>&
+AsyncAttribOpt::signal_progress (void)
+{
+  return this->sig_progress;
+}
+
+inline sigc::signal<void, AttribOptResult>&
+AsyncAttribOpt::signal_done (void)
+{
+  return this->sig_done;
+}
+
+#endif /* ASYNC_ATTRIB_OPT_HEADER */
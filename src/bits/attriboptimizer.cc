@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <limits>
+
+#include "attriboptimizer.h"
+
+AttribOptimizer::AttribOptimizer (void)
+{
+  this->clear();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::clear (void)
+{
+  this->skills.clear();
+  this->used_pairs.clear();
+  for (int i = 0; i < ATTRIB_PAIR_AMOUNT; ++i)
+    this->pair_sp[i] = 0.0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::add_skill (ApiSkill const* skill, int remaining_sp)
+{
+  int pair = AttribOptimizer::get_pair_index(skill);
+  this->skills.push_back(std::make_pair(pair, remaining_sp));
+
+  bool used = false;
+  for (std::size_t i = 0; i < this->used_pairs.size() && !used; ++i)
+    used = (this->used_pairs[i] == pair);
+  if (!used)
+    this->used_pairs.push_back(pair);
+
+  this->pair_sp[pair] += (double)remaining_sp;
+}
+
+/* ---------------------------------------------------------------- */
+
+double
+AttribOptimizer::get_total_sp (void) const
+{
+  double total = 0.0;
+  for (std::size_t i = 0; i < this->used_pairs.size(); ++i)
+    total += this->pair_sp[this->used_pairs[i]];
+  return total;
+}
+
+/* ---------------------------------------------------------------- */
+
+double
+AttribOptimizer::get_pair_time (ApiCharAttribs const& attribs) const
+{
+  double time = 0.0;
+  for (std::size_t i = 0; i < this->used_pairs.size(); ++i)
+  {
+    int pair = this->used_pairs[i];
+    unsigned int spph = ApiCharSheet::get_spph_for_attribs
+        ((ApiAttrib)(pair / (API_ATTRIB_UNKNOWN + 1)),
+        (ApiAttrib)(pair % (API_ATTRIB_UNKNOWN + 1)), attribs);
+    time += this->pair_sp[pair] / (spph / 3600.0);
+  }
+
+  return time;
+}
+
+/* ---------------------------------------------------------------- */
+
+time_t
+AttribOptimizer::get_exact_time (ApiCharAttribs const& attribs) const
+{
+  return this->get_exact_time(attribs, 0, this->skills.size());
+}
+
+/* ---------------------------------------------------------------- */
+
+time_t
+AttribOptimizer::get_exact_time (ApiCharAttribs const& attribs,
+    std::size_t begin, std::size_t end) const
+{
+  /* Every skill duration is rounded individually, as in the planner. */
+  double spps[ATTRIB_PAIR_AMOUNT];
+  for (std::size_t i = 0; i < this->used_pairs.size(); ++i)
+  {
+    int pair = this->used_pairs[i];
+    unsigned int spph = ApiCharSheet::get_spph_for_attribs
+        ((ApiAttrib)(pair / (API_ATTRIB_UNKNOWN + 1)),
+        (ApiAttrib)(pair % (API_ATTRIB_UNKNOWN + 1)), attribs);
+    spps[pair] = spph / 3600.0;
+  }
+
+  time_t time = 0;
+  for (std::size_t i = begin; i < end; ++i)
+    time += (time_t)((double)this->skills[i].second
+        / spps[this->skills[i].first]);
+
+  return time;
+}
+
+/* ---------------------------------------------------------------- */
+
+AttribOptResult
+AttribOptimizer::get_initial_result (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant) const
+{
+  AttribOptResult result;
+  result.base = base;
+  result.total = base + implant;
+  result.orig_time = this->get_exact_time(result.total);
+  result.best_time = result.orig_time;
+  return result;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::add_distributions (ApiCharAttribs const& base, int intl,
+    std::vector<ApiCharAttribs>& result)
+{
+  /* Calculate the maximum number of points that can be assigned to each
+   * attribute. */
+  int max_points_per_att = MAXIMUM_VALUE_PER_ATTRIB
+      - MINIMUM_VALUE_PER_ATTRIB;
+
+  /* Calculate the total number of base attribute points to distribute if it
+   * changes in the future. */
+  int total_base_atts = (int)base.cha + (int)base.intl
+      + (int)base.mem + (int)base.per
+      + (int)base.wil - (MINIMUM_VALUE_PER_ATTRIB * 5);
+
+  /* Go through all combinations. This algorithm has been found in EVEMon. */
+  int max_mem = total_base_atts - intl;
+  for (int mem = 0; mem <= max_points_per_att && mem <= max_mem; mem++)
+  {
+    int max_cha = max_mem - mem;
+    for (int cha = 0; cha <= max_points_per_att && cha <= max_cha; cha++)
+    {
+      int max_per = max_cha - cha;
+      for (int per = 0; per <= max_points_per_att && per <= max_per; per++)
+      {
+        int wil = max_per - per;
+        if (wil > max_points_per_att)
+          continue;
+
+        ApiCharAttribs cur_base_atts;
+        cur_base_atts.intl = intl + MINIMUM_VALUE_PER_ATTRIB;
+        cur_base_atts.mem = mem + MINIMUM_VALUE_PER_ATTRIB;
+        cur_base_atts.cha = cha + MINIMUM_VALUE_PER_ATTRIB;
+        cur_base_atts.per = per + MINIMUM_VALUE_PER_ATTRIB;
+        cur_base_atts.wil = wil + MINIMUM_VALUE_PER_ATTRIB;
+        result.push_back(cur_base_atts);
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::optimize_slice (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant, int intl, AttribOptResult& result) const
+{
+  /* The first pass scores all candidates on the per-pair SP table. */
+  std::vector<ApiCharAttribs> candidates;
+  AttribOptimizer::add_distributions(base, intl, candidates);
+
+  std::vector<double> scores(candidates.size());
+  double best_score = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+  {
+    scores[i] = this->get_pair_time(candidates[i] + implant);
+    if (scores[i] < best_score)
+      best_score = scores[i];
+  }
+
+  /* Rounding each skill duration changes the total by less than one
+   * second per skill. Only candidates within that margin of the best
+   * score can win and are evaluated exactly, in enumeration order. */
+  double margin = 2.0 * (double)this->skills.size() + 1.0;
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+  {
+    if (scores[i] > best_score + margin)
+      continue;
+
+    ApiCharAttribs cur_total_atts = candidates[i] + implant;
+    time_t cur_total_time = this->get_exact_time(cur_total_atts);
+    if (cur_total_time < result.best_time)
+    {
+      result.best_time = cur_total_time;
+      result.base = candidates[i];
+      result.total = cur_total_atts;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+AttribOptResult
+AttribOptimizer::optimize (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant) const
+{
+  AttribOptResult result = this->get_initial_result(base, implant);
+  for (int intl = 0; intl < AttribOptimizer::get_slice_amount(); ++intl)
+    this->optimize_slice(base, implant, intl, result);
+
+  return result;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::merge_result (AttribOptResult& result,
+    AttribOptResult const& slice)
+{
+  if (slice.best_time < result.best_time)
+  {
+    result.best_time = slice.best_time;
+    result.base = slice.base;
+    result.total = slice.total;
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::optimize_sweep (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant, bool backwards,
+    std::vector<AttribOptResult>& results) const
+{
+  std::size_t amount = this->skills.size();
+  results.clear();
+  results.resize(amount);
+  if (amount == 0)
+    return;
+
+  /* The SP per second for every candidate and used attribute pair. The
+   * current attributes are the first candidate. */
+  std::vector<ApiCharAttribs> candidates;
+  candidates.push_back(base);
+  for (int intl = 0; intl < AttribOptimizer::get_slice_amount(); ++intl)
+    AttribOptimizer::add_distributions(base, intl, candidates);
+
+  std::size_t pairs = this->used_pairs.size();
+  int pair_slot[ATTRIB_PAIR_AMOUNT];
+  for (std::size_t i = 0; i < pairs; ++i)
+    pair_slot[this->used_pairs[i]] = (int)i;
+
+  std::vector<double> spps(pairs * candidates.size());
+  for (std::size_t c = 0; c < candidates.size(); ++c)
+  {
+    ApiCharAttribs total = candidates[c] + implant;
+    for (std::size_t i = 0; i < pairs; ++i)
+    {
+      int pair = this->used_pairs[i];
+      unsigned int spph = ApiCharSheet::get_spph_for_attribs
+          ((ApiAttrib)(pair / (API_ATTRIB_UNKNOWN + 1)),
+          (ApiAttrib)(pair % (API_ATTRIB_UNKNOWN + 1)), total);
+      spps[i * candidates.size() + c] = spph / 3600.0;
+    }
+  }
+
+  /* Stream the skills and keep the exact, individually rounded training
+   * time of every candidate. Each step picks the best candidate like
+   * optimize(): in search order, only if strictly shorter than the
+   * current attributes. */
+  std::vector<time_t> cand_time(candidates.size(), 0);
+  for (std::size_t step = 0; step < amount; ++step)
+  {
+    std::size_t skill = (backwards ? amount - step - 1 : step);
+    double sp = (double)this->skills[skill].second;
+    double const* pair_spps = &spps[(std::size_t)pair_slot
+        [this->skills[skill].first] * candidates.size()];
+
+    std::size_t best = 0;
+    for (std::size_t c = 0; c < candidates.size(); ++c)
+    {
+      cand_time[c] += (time_t)(sp / pair_spps[c]);
+      if (cand_time[c] < cand_time[best])
+        best = c;
+    }
+
+    AttribOptResult& result = results[skill];
+    result.base = candidates[best];
+    result.total = candidates[best] + implant;
+    result.orig_time = cand_time[0];
+    result.best_time = cand_time[best];
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AttribOptimizer::get_remap_blocks (std::vector<std::size_t>& bounds) const
+{
+  /* Short plans have a block for every skill. Longer plans are split
+   * into blocks with about the same amount of SP. */
+  bounds.clear();
+  bounds.push_back(0);
+  std::size_t amount = this->skills.size();
+  if (amount <= REMAP_MAX_BLOCKS)
+  {
+    for (std::size_t i = 1; i <= amount; ++i)
+      bounds.push_back(i);
+    return;
+  }
+
+  double total_sp = this->get_total_sp();
+  double cur_sp = 0.0;
+  for (std::size_t i = 0; i < amount; ++i)
+  {
+    cur_sp += (double)this->skills[i].second;
+    double block_sp = total_sp * (double)bounds.size() / REMAP_MAX_BLOCKS;
+    if (cur_sp >= block_sp && i + 1 < amount)
+      bounds.push_back(i + 1);
+  }
+  bounds.push_back(amount);
+}
+
+/* ---------------------------------------------------------------- */
+
+AttribRemapResult
+AttribOptimizer::optimize_remaps (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant, unsigned int max_remaps,
+    unsigned int bonus_remaps, time_t since_remap) const
+{
+  AttribRemapResult result;
+  result.orig_time = this->get_exact_time(base + implant);
+  result.best_time = result.orig_time;
+
+  AttribRemapPoint current;
+  current.position = 0;
+  current.base = base;
+  current.total = base + implant;
+  current.duration = result.orig_time;
+  current.bonus = false;
+  current.remap = false;
+
+  if (this->skills.empty() || max_remaps == 0)
+  {
+    result.remaps.push_back(current);
+    return result;
+  }
+
+  /* Remaps are placed between blocks of skills. */
+  std::vector<std::size_t> bounds;
+  this->get_remap_blocks(bounds);
+  std::size_t blocks = bounds.size() - 1;
+
+  /* The SP per block and used attribute pair. */
+  std::size_t pairs = this->used_pairs.size();
+  int pair_slot[ATTRIB_PAIR_AMOUNT];
+  for (std::size_t i = 0; i < pairs; ++i)
+    pair_slot[this->used_pairs[i]] = (int)i;
+
+  std::vector<double> block_sp(blocks * pairs, 0.0);
+  for (std::size_t b = 0; b < blocks; ++b)
+    for (std::size_t i = bounds[b]; i < bounds[b + 1]; ++i)
+      block_sp[b * pairs + pair_slot[this->skills[i].first]]
+          += (double)this->skills[i].second;
+
+  /* The training time of every block for every candidate. */
+  std::vector<ApiCharAttribs> candidates;
+  for (int intl = 0; intl < AttribOptimizer::get_slice_amount(); ++intl)
+    AttribOptimizer::add_distributions(base, intl, candidates);
+  std::size_t amount = candidates.size();
+
+  std::vector<double> block_time(blocks * amount, 0.0);
+  for (std::size_t c = 0; c < amount; ++c)
+  {
+    ApiCharAttribs total = candidates[c] + implant;
+    for (std::size_t i = 0; i < pairs; ++i)
+    {
+      int pair = this->used_pairs[i];
+      unsigned int spph = ApiCharSheet::get_spph_for_attribs
+          ((ApiAttrib)(pair / (API_ATTRIB_UNKNOWN + 1)),
+          (ApiAttrib)(pair % (API_ATTRIB_UNKNOWN + 1)), total);
+      double secs_per_sp = 3600.0 / spph;
+      for (std::size_t b = 0; b < blocks; ++b)
+        block_time[b * amount + c] += block_sp[b * pairs + i] * secs_per_sp;
+    }
+  }
+
+  /* The training time before every boundary with the given attributes. */
+  std::vector<double> keep_time(blocks + 1, 0.0);
+  {
+    ApiCharAttribs total = base + implant;
+    for (std::size_t i = 0; i < pairs; ++i)
+    {
+      int pair = this->used_pairs[i];
+      unsigned int spph = ApiCharSheet::get_spph_for_attribs
+          ((ApiAttrib)(pair / (API_ATTRIB_UNKNOWN + 1)),
+          (ApiAttrib)(pair % (API_ATTRIB_UNKNOWN + 1)), total);
+      double secs_per_sp = 3600.0 / spph;
+      for (std::size_t b = 0; b < blocks; ++b)
+        keep_time[b + 1] += block_sp[b * pairs + i] * secs_per_sp;
+    }
+    for (std::size_t b = 0; b < blocks; ++b)
+      keep_time[b + 1] += keep_time[b];
+  }
+
+  /* Find the best candidate for every segment of blocks. Extending a
+   * segment by one block only adds that block's time per candidate. */
+  std::size_t stride = blocks + 1;
+  std::vector<double> seg_time(stride * stride, 0.0);
+  std::vector<std::size_t> seg_cand(stride * stride, 0);
+  std::vector<double> cand_time(amount);
+  for (std::size_t a = 0; a < blocks; ++a)
+  {
+    std::fill(cand_time.begin(), cand_time.end(), 0.0);
+    for (std::size_t b = a + 1; b <= blocks; ++b)
+    {
+      double const* time = &block_time[(b - 1) * amount];
+      double best = std::numeric_limits<double>::max();
+      std::size_t best_cand = 0;
+      for (std::size_t c = 0; c < amount; ++c)
+      {
+        cand_time[c] += time[c];
+        if (cand_time[c] < best)
+        {
+          best = cand_time[c];
+          best_cand = c;
+        }
+      }
+      seg_time[a * stride + b] = best;
+      seg_cand[a * stride + b] = best_cand;
+    }
+  }
+
+  /* Dynamic programming over the block boundaries. A state is the time
+   * to train everything before a boundary with "k" segments and "bo"
+   * bonus remaps, ready to remap at the boundary. Segments shorter than
+   * a year require a bonus remap at their end, which is conservative:
+   * the yearly remap is only used a year after any previous remap.
+   * The first remap is either placed before the plan, or deferred and
+   * the given attributes are kept until a later boundary. */
+  std::size_t max_bonus = std::min((std::size_t)bonus_remaps,
+      (std::size_t)max_remaps);
+  std::size_t states = (std::size_t)max_remaps * (max_bonus + 1) * stride;
+  std::vector<double> state_time(states, -1.0);
+  std::vector<std::size_t> state_prev(states, 0);
+  std::vector<std::size_t> state_prev_bonus(states, 0);
+  for (std::size_t i = 0; i < blocks; ++i)
+  {
+    double since = (double)since_remap + keep_time[i];
+    std::size_t bo = (since < REMAP_INTERVAL ? 1 : 0);
+    if (bo <= max_bonus)
+      state_time[bo * stride + i] = keep_time[i];
+  }
+
+  double best_time = std::numeric_limits<double>::max();
+  std::size_t best_k = 0;
+  std::size_t best_bo = 0;
+  std::size_t best_start = 0;
+  for (std::size_t k = 0; k < (std::size_t)max_remaps; ++k)
+    for (std::size_t bo = 0; bo <= max_bonus; ++bo)
+      for (std::size_t i = 0; i < blocks; ++i)
+      {
+        std::size_t state = (k * (max_bonus + 1) + bo) * stride + i;
+        if (state_time[state] < 0.0)
+          continue;
+
+        /* Finish the plan with a last segment. */
+        double time = state_time[state] + seg_time[i * stride + blocks];
+        if (time < best_time)
+        {
+          best_time = time;
+          best_k = k;
+          best_bo = bo;
+          best_start = i;
+        }
+
+        /* Or remap again at a later boundary. */
+        if (k + 1 == (std::size_t)max_remaps)
+          continue;
+        for (std::size_t j = i + 1; j < blocks; ++j)
+        {
+          double seg = seg_time[i * stride + j];
+          std::size_t next_bo = bo + (seg < REMAP_INTERVAL ? 1 : 0);
+          if (next_bo > max_bonus)
+            continue;
+
+          std::size_t next = ((k + 1) * (max_bonus + 1) + next_bo)
+              * stride + j;
+          double next_time = state_time[state] + seg;
+          if (state_time[next] < 0.0 || next_time < state_time[next])
+          {
+            state_time[next] = next_time;
+            state_prev[next] = i;
+            state_prev_bonus[next] = bo;
+          }
+        }
+      }
+
+  /* Walk back from the last segment to collect the remaps. The first
+   * state tells if the given attributes are kept before the remaps. */
+  std::vector<AttribRemapPoint> remaps;
+  std::size_t end = blocks;
+  std::size_t start = best_start;
+  std::size_t bo = best_bo;
+  for (std::size_t k = best_k + 1; k > 0; --k)
+  {
+    std::size_t state = ((k - 1) * (max_bonus + 1) + bo) * stride + start;
+    std::size_t prev_bo = (k > 1 ? state_prev_bonus[state] : 0);
+
+    AttribRemapPoint remap;
+    remap.position = bounds[start];
+    remap.base = candidates[seg_cand[start * stride + end]];
+    remap.total = remap.base + implant;
+    remap.duration = this->get_exact_time(remap.total,
+        bounds[start], bounds[end]);
+    remap.bonus = (bo != prev_bo);
+    remap.remap = true;
+    remaps.insert(remaps.begin(), remap);
+
+    end = start;
+    start = (k > 1 ? state_prev[state] : 0);
+    bo = prev_bo;
+  }
+
+  if (end > 0)
+  {
+    AttribRemapPoint keep = current;
+    keep.duration = this->get_exact_time(keep.total, 0, bounds[end]);
+    remaps.insert(remaps.begin(), keep);
+  }
+
+  time_t total_time = 0;
+  for (std::size_t i = 0; i < remaps.size(); ++i)
+    total_time += remaps[i].duration;
+
+  if (total_time < result.orig_time)
+  {
+    result.remaps = remaps;
+    result.best_time = total_time;
+  }
+  else
+  {
+    result.remaps.push_back(current);
+  }
+
+  return result;
+}
@@ -0,0 +1,199 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ATTRIB_OPTIMIZER_HEADER
+#define ATTRIB_OPTIMIZER_HEADER
+
+#include <ctime>
+#include <vector>
+
+#include "api/apiskilltree.h"
+#include "api/apicharsheet.h"
+
+/* The minimum number of points that have to be assigned to each attribute. */
+#define MINIMUM_VALUE_PER_ATTRIB 17
+/* The maximum number of points that can be assigned to each attribute. */
+#define MAXIMUM_VALUE_PER_ATTRIB 27
+
+/* The number of (primary, secondary) attribute pairs, including unknown. */
+#define ATTRIB_PAIR_AMOUNT ((API_ATTRIB_UNKNOWN + 1) * (API_ATTRIB_UNKNOWN + 1))
+
+/* The minimum time between two remaps without using a bonus remap. */
+#define REMAP_INTERVAL (365 * 24 * 60 * 60)
+/* Remaps are only placed at the boundaries of that many plan blocks. */
+#define REMAP_MAX_BLOCKS 128
+
+struct AttribOptResult
+{
+  ApiCharAttribs base;
+  ApiCharAttribs total;
+  time_t orig_time;
+  time_t best_time;
+};
+
+/* ---------------------------------------------------------------- */
+
+struct AttribRemapPoint
+{
+  /* The index of the first skill trained with the attributes. */
+  std::size_t position;
+  ApiCharAttribs base;
+  ApiCharAttribs total;
+  /* The training time until the next remap or the end of the plan. */
+  time_t duration;
+  /* Less than a year passed since the previous remap. */
+  bool bonus;
+  /* False if the current attributes are kept, i.e. no remap. */
+  bool remap;
+};
+
+struct AttribRemapResult
+{
+  std::vector<AttribRemapPoint> remaps;
+  time_t orig_time;
+  time_t best_time;
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Finds the base attribute distribution with the shortest training time
+ * for a sequence of skills. The training time only depends on the SP
+ * remaining for each (primary, secondary) attribute pair, so the skills
+ * are reduced to a per-pair SP table once and every candidate is scored
+ * in O(pairs). Only candidates that come close to the best score are
+ * evaluated per skill, which gives exactly the same result as summing
+ * the individually rounded skill durations.
+ */
+class AttribOptimizer
+{
+  private:
+    /* Pair index and remaining SP for every skill in order. */
+    std::vector<std::pair<int, int> > skills;
+    /* Remaining SP per attribute pair and the list of used pairs. */
+    double pair_sp[ATTRIB_PAIR_AMOUNT];
+    std::vector<int> used_pairs;
+
+  protected:
+    double get_pair_time (ApiCharAttribs const& attribs) const;
+    time_t get_exact_time (ApiCharAttribs const& attribs) const;
+    time_t get_exact_time (ApiCharAttribs const& attribs,
+        std::size_t begin, std::size_t end) const;
+    void get_remap_blocks (std::vector<std::size_t>& bounds) const;
+    void optimize_sweep (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant, bool backwards,
+        std::vector<AttribOptResult>& results) const;
+
+  public:
+    AttribOptimizer (void);
+
+    /* Adds a skill with the SP that remain to be trained. */
+    void add_skill (ApiSkill const* skill, int remaining_sp);
+    void clear (void);
+
+    /* Returns the total remaining SP of all skills. */
+    double get_total_sp (void) const;
+
+    /* Returns the training time of all skills with the given attributes. */
+    time_t get_training_time (ApiCharAttribs const& attribs) const;
+
+    /* Searches all legal base attribute distributions with the same
+     * amount of points as "base". The result is only changed from the
+     * given attributes if the training time is strictly shorter. */
+    AttribOptResult optimize (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant) const;
+
+    /* Calculates the same result as optimize() for every prefix of the
+     * skills in a single pass, i.e. results[i] is the optimum for the
+     * skills up to and including skill i. */
+    void optimize_prefixes (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant,
+        std::vector<AttribOptResult>& results) const;
+
+    /* Same as above for every suffix, i.e. results[i] is the optimum
+     * for the skills starting with skill i. */
+    void optimize_suffixes (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant,
+        std::vector<AttribOptResult>& results) const;
+
+    /* Searches up to "max_remaps" remap points along the plan and the
+     * best attributes for each segment between them. The first segment
+     * either keeps the given attributes or starts with a remap before
+     * the plan. Remaps less than a year after the previous one, where
+     * "since_remap" is the time between the last timed remap and the
+     * start of the plan, use one of the "bonus_remaps". Unless the time
+     * is strictly shorter, the result keeps the given attributes. */
+    AttribRemapResult optimize_remaps (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant, unsigned int max_remaps,
+        unsigned int bonus_remaps, time_t since_remap) const;
+
+    /* The search can also be split into independent slices, one for
+     * every amount of extra intelligence points. Each slice starts with
+     * the initial result and is searched with optimize_slice(). Merging
+     * the slices in order with merge_result() gives the same result as
+     * optimize(), including ties. Slices can be searched concurrently. */
+    AttribOptResult get_initial_result (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant) const;
+    void optimize_slice (ApiCharAttribs const& base,
+        ApiCharAttribs const& implant, int intl,
+        AttribOptResult& result) const;
+    static void merge_result (AttribOptResult& result,
+        AttribOptResult const& slice);
+    static int get_slice_amount (void);
+
+    /* Appends all legal base attribute distributions with the same
+     * amount of points as "base" and the given extra intelligence points
+     * in the order the optimizer searches them. */
+    static void add_distributions (ApiCharAttribs const& base, int intl,
+        std::vector<ApiCharAttribs>& result);
+
+    /* Returns the attribute pair index for a skill. */
+    static int get_pair_index (ApiSkill const* skill);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline int
+AttribOptimizer::get_pair_index (ApiSkill const* skill)
+{
+  return (int)skill->primary * (API_ATTRIB_UNKNOWN + 1) + (int)skill->secondary;
+}
+
+inline void
+AttribOptimizer::optimize_prefixes (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant,
+    std::vector<AttribOptResult>& results) const
+{
+  this->optimize_sweep(base, implant, false, results);
+}
+
+inline void
+AttribOptimizer::optimize_suffixes (ApiCharAttribs const& base,
+    ApiCharAttribs const& implant,
+    std::vector<AttribOptResult>& results) const
+{
+  this->optimize_sweep(base, implant, true, results);
+}
+
+inline int
+AttribOptimizer::get_slice_amount (void)
+{
+  return MAXIMUM_VALUE_PER_ATTRIB - MINIMUM_VALUE_PER_ATTRIB + 1;
+}
+
+inline time_t
+AttribOptimizer::get_training_time (ApiCharAttribs const& attribs) const
+{
+  return this->get_exact_time(attribs);
+}
+
+#endif /* ATTRIB_OPTIMIZER_HEADER */
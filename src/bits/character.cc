@@ -96,6 +96,40 @@ Character::on_sq_available (EveApiData data)
 
 /* ---------------------------------------------------------------- */
 
+void
+Character::set_cached_charsheet (ApiCharSheet const& sheet)
+{
+  if (this->cs->valid)
+    return;
+
+  bool yet_unnamed = this->cs->name.empty();
+  this->cs->set_parsed_sheet(sheet);
+
+  if (yet_unnamed && !this->cs->name.empty())
+    this->sig_name_available.emit(this->auth.char_id);
+
+  this->process_api_data();
+  this->sig_char_sheet_updated.emit();
+  this->sig_api_info_changed.emit();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+Character::set_cached_skillqueue (ApiSkillQueue const& sheet)
+{
+  if (this->sq->valid)
+    return;
+
+  *this->sq = sheet;
+
+  this->process_api_data();
+  this->sig_skill_queue_updated.emit();
+  this->sig_api_info_changed.emit();
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 Character::process_api_data (void)
 {
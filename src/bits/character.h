@@ -96,6 +96,11 @@ class Character
     void request_charsheet (void);
     void request_skillqueue (void);
 
+    /* Uses sheets that have been parsed from the local cache. The
+     * sheets are ignored if valid sheets are already available. */
+    void set_cached_charsheet (ApiCharSheet const& sheet);
+    void set_cached_skillqueue (ApiSkillQueue const& sheet);
+
     /* Updates the live information, typically called every second. */
     void update_live_info (void);
     /* Updates the character with completed skills from the queue. */
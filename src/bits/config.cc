@@ -57,7 +57,15 @@ char const* default_config =
     "[updater]\n"
     "  autocheck = true\n"
     "  check_interval = 604800\n"
-    "  last_update = 0\n";
+    "  last_update = 0\n"
+    "[updater.certtree]\n"
+    "  etag = \n"
+    "  file_mtime = 0\n"
+    "  last_modified = \n"
+    "[updater.skilltree]\n"
+    "  etag = \n"
+    "  file_mtime = 0\n"
+    "  last_modified = \n";
 
 /* The initial configuration is loaded once if the configuration
  * file is created for the first time. Thus it initializes the
@@ -0,0 +1,117 @@
+#include <vector>
+#include <algorithm>
+#include <glibmm/main.h>
+
+#include "api/evetime.h"
+#include "eventscheduler.h"
+
+/* Static members. */
+EventScheduler::EventMap EventScheduler::events;
+EventScheduler::DeadlineMap EventScheduler::deadlines;
+unsigned int EventScheduler::next_id = 1;
+sigc::connection EventScheduler::timeout;
+time_t EventScheduler::timeout_deadline = 0;
+EventScheduler::Clock EventScheduler::time_source = &EveTime::get_local_time;
+
+/* ---------------------------------------------------------------- */
+
+unsigned int
+EventScheduler::add (time_t deadline, sigc::slot<void> const& slot)
+{
+  unsigned int id = EventScheduler::next_id;
+  EventScheduler::next_id += 1;
+  if (EventScheduler::next_id == 0)
+    EventScheduler::next_id = 1;
+
+  EventScheduler::events.insert(std::make_pair
+      (EventKey(deadline, id), slot));
+  EventScheduler::deadlines.insert(std::make_pair(id, deadline));
+  EventScheduler::rearm();
+
+  return id;
+}
+
+/* ---------------------------------------------------------------- */
+
+unsigned int
+EventScheduler::add_after (time_t seconds, sigc::slot<void> const& slot)
+{
+  return EventScheduler::add(EventScheduler::time_source() + seconds, slot);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+EventScheduler::set_clock (Clock clock)
+{
+  EventScheduler::time_source = clock;
+  EventScheduler::timeout.disconnect();
+  EventScheduler::rearm();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+EventScheduler::remove (unsigned int id)
+{
+  DeadlineMap::iterator iter = EventScheduler::deadlines.find(id);
+  if (iter == EventScheduler::deadlines.end())
+    return;
+
+  EventScheduler::events.erase(EventKey(iter->second, id));
+  EventScheduler::deadlines.erase(iter);
+  EventScheduler::rearm();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+EventScheduler::rearm (void)
+{
+  if (EventScheduler::events.empty())
+  {
+    EventScheduler::timeout.disconnect();
+    return;
+  }
+
+  /* Keep the timeout if it already wakes up for the earliest event. */
+  time_t now = EventScheduler::time_source();
+  time_t deadline = EventScheduler::events.begin()->first.first;
+  deadline = std::min(deadline, now + SCHEDULER_MAX_SLEEP);
+  if (EventScheduler::timeout.connected()
+      && EventScheduler::timeout_deadline <= deadline)
+    return;
+
+  EventScheduler::timeout.disconnect();
+  EventScheduler::timeout_deadline = deadline;
+  EventScheduler::timeout = Glib::signal_timeout().connect_seconds
+      (sigc::ptr_fun(&EventScheduler::on_timeout),
+      (unsigned int)std::max(deadline - now, (time_t)0));
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+EventScheduler::on_timeout (void)
+{
+  /* This timeout is done, a new one is created on demand. */
+  EventScheduler::timeout = sigc::connection();
+
+  /* Take all due events first, the slots may add or remove events. */
+  time_t now = EventScheduler::time_source();
+  std::vector<sigc::slot<void> > due;
+  while (!EventScheduler::events.empty()
+      && EventScheduler::events.begin()->first.first <= now)
+  {
+    EventMap::iterator iter = EventScheduler::events.begin();
+    due.push_back(iter->second);
+    EventScheduler::deadlines.erase(iter->first.second);
+    EventScheduler::events.erase(iter);
+  }
+
+  for (std::size_t i = 0; i < due.size(); ++i)
+    due[i]();
+
+  EventScheduler::rearm();
+  return false;
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_SCHEDULER_HEADER
+#define EVENT_SCHEDULER_HEADER
+
+#include <ctime>
+#include <map>
+#include <utility>
+#include <sigc++/signal.h>
+
+/* The longest time in seconds the scheduler sleeps without checking the
+ * clock. This catches up with deadlines after suspend or clock changes. */
+#define SCHEDULER_MAX_SLEEP 300
+
+/*
+ * Central scheduler for events at absolute points in local time. The
+ * events are ordered by deadline and a single main loop timeout sleeps
+ * until the earliest one, so components don't need to poll. Events fire
+ * once. Repeating events schedule themselves again when they fire.
+ */
+class EventScheduler
+{
+  public:
+    typedef time_t (*Clock) (void);
+
+  private:
+    typedef std::pair<time_t, unsigned int> EventKey;
+    typedef std::map<EventKey, sigc::slot<void> > EventMap;
+    typedef std::map<unsigned int, time_t> DeadlineMap;
+
+    static EventMap events;
+    static DeadlineMap deadlines;
+    static unsigned int next_id;
+    static sigc::connection timeout;
+    static time_t timeout_deadline;
+    static Clock time_source;
+
+    static void rearm (void);
+    static bool on_timeout (void);
+
+  public:
+    /* Schedules the slot at the given local time. Returns the ID
+     * of the event, which is never zero. */
+    static unsigned int add (time_t deadline, sigc::slot<void> const& slot);
+    /* Schedules the slot in the given amount of seconds. */
+    static unsigned int add_after (time_t seconds,
+        sigc::slot<void> const& slot);
+    /* Cancels an event. Zero and IDs of fired events are ignored. */
+    static void remove (unsigned int id);
+    /* Returns the amount of pending events. */
+    static std::size_t get_amount (void);
+
+    /* Replaces the local time the deadlines are compared to, e.g. with
+     * a fake clock for testing. Pending events keep their deadlines. */
+    static void set_clock (Clock clock);
+    /* Fires all due events as if the timeout expired. */
+    static void run_due (void);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline std::size_t
+EventScheduler::get_amount (void)
+{
+  return EventScheduler::events.size();
+}
+
+inline void
+EventScheduler::run_due (void)
+{
+  EventScheduler::on_timeout();
+}
+
+#endif /* EVENT_SCHEDULER_HEADER */
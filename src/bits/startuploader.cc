@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <iostream>
+#include <libxml/parser.h>
+
+#include "util/os.h"
+#include "util/exception.h"
+#include "api/apiskilltree.h"
+#include "api/apicerttree.h"
+#include "characterlist.h"
+#include "startupprofile.h"
+#include "startuploader.h"
+
+class StartupLoaderWorker : public Thread
+{
+  private:
+    StartupLoader* owner;
+  protected:
+    void* run (void);
+  public:
+    StartupLoaderWorker (StartupLoader* owner);
+};
+
+/* ---------------------------------------------------------------- */
+
+StartupLoaderWorker::StartupLoaderWorker (StartupLoader* owner)
+    : owner(owner)
+{
+}
+
+void*
+StartupLoaderWorker::run (void)
+{
+  this->owner->process_jobs();
+  return 0;
+}
+
+/* ================================================================ */
+
+StartupLoader::StartupLoader (void)
+  : trees_loaded(0)
+{
+  this->sheet_amount = 0;
+  this->published_sheets = 0;
+  this->start_time = 0.0;
+  this->next_job = 0;
+
+  this->sig_dispatch_sheets.connect(sigc::mem_fun
+      (*this, &StartupLoader::dispatch_sheets));
+}
+
+/* ---------------------------------------------------------------- */
+
+StartupLoader::~StartupLoader (void)
+{
+  /* Sheets that have not been published are dropped. */
+  for (std::size_t i = 0; i < this->workers.size(); ++i)
+  {
+    this->workers[i]->pt_join();
+    delete this->workers[i];
+  }
+
+  for (std::size_t i = 0; i < this->jobs.size(); ++i)
+    delete this->jobs[i];
+  for (std::size_t i = 0; i < this->parsed_sheets.size(); ++i)
+    delete this->parsed_sheets[i];
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupLoader::start (void)
+{
+  this->start_time = StartupProfile::get_time();
+
+  /* The trees come first because every other part depends on them. */
+  StartupJob tree_job;
+  tree_job.type = STARTUP_JOB_SKILLTREE;
+  this->jobs.push_back(new StartupJob(tree_job));
+  tree_job.type = STARTUP_JOB_CERTTREE;
+  this->jobs.push_back(new StartupJob(tree_job));
+
+  CharacterListPtr clist = CharacterList::request();
+  for (std::size_t i = 0; i < clist->chars.size(); ++i)
+  {
+    CharacterPtr character = clist->chars[i];
+    StartupJob sheet_job;
+    sheet_job.auth = EveApiAuth(character->get_user_id(), "",
+        character->get_char_id());
+    sheet_job.type = STARTUP_JOB_CHARSHEET;
+    this->jobs.push_back(new StartupJob(sheet_job));
+    sheet_job.type = STARTUP_JOB_SKILLQUEUE;
+    this->jobs.push_back(new StartupJob(sheet_job));
+    this->sheet_amount += 2;
+  }
+
+  /* The parser must be initialized before it is used by threads. */
+  xmlInitParser();
+
+  /* All workers are created before the first one runs because the
+   * workers access the worker list. */
+  std::size_t num_workers = std::min((std::size_t)OS::get_num_processors(),
+      this->jobs.size());
+  for (std::size_t i = 0; i < num_workers; ++i)
+    this->workers.push_back(new StartupLoaderWorker(this));
+  for (std::size_t i = 0; i < num_workers; ++i)
+    this->workers[i]->pt_create();
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+StartupLoader::wait_for_trees (void)
+{
+  double start = StartupProfile::get_time();
+  this->trees_loaded.wait();
+  this->trees_loaded.wait();
+  StartupProfile::add_phase("Waiting for skill and certificate trees", start);
+
+  /* The workers only report the error, exiting is up to main(). */
+  this->mutex.wait();
+  std::string error = this->tree_error;
+  this->mutex.post();
+  if (!error.empty())
+  {
+    std::cout << "XML error: " << error << std::endl;
+    std::cout << "Cannot load the data files. EXIT!" << std::endl;
+    return false;
+  }
+
+  /* Without sheets the report is printed once the main loop runs. */
+  if (this->sheet_amount == 0)
+    this->sig_dispatch_sheets.emit();
+
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupLoader::process_jobs (void)
+{
+  while (true)
+  {
+    this->mutex.wait();
+    if (this->next_job == this->jobs.size())
+    {
+      this->mutex.post();
+      return;
+    }
+    StartupJob* job = this->jobs[this->next_job];
+    this->jobs[this->next_job] = 0;
+    this->next_job += 1;
+    this->mutex.post();
+
+    this->process_job(job);
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupLoader::process_job (StartupJob* job)
+{
+  double start = StartupProfile::get_time();
+
+  /* The main thread does not use the trees before wait_for_trees()
+   * returns. Reference counts are not thread safe, so no references
+   * to the trees are kept after the trees are loaded. */
+  switch (job->type)
+  {
+    case STARTUP_JOB_SKILLTREE:
+    case STARTUP_JOB_CERTTREE:
+      try
+      {
+        if (job->type == STARTUP_JOB_SKILLTREE)
+          ApiSkillTree::request();
+        else
+          ApiCertTree::request();
+      }
+      catch (Exception& e)
+      {
+        this->mutex.wait();
+        if (this->tree_error.empty())
+          this->tree_error = e;
+        this->mutex.post();
+      }
+      StartupProfile::add_phase(job->type == STARTUP_JOB_SKILLTREE
+          ? "Skill tree" : "Certificate tree", start);
+      delete job;
+      this->trees_loaded.post();
+      return;
+
+    case STARTUP_JOB_CHARSHEET:
+    case STARTUP_JOB_SKILLQUEUE:
+    default:
+      break;
+  }
+
+  EveApiDocType type = (job->type == STARTUP_JOB_CHARSHEET
+      ? API_DOCTYPE_CHARSHEET : API_DOCTYPE_SKILLQUEUE);
+  EveApiFetcher fetcher(job->auth, type);
+  EveApiData data;
+
+  if (fetcher.load_from_cache(data))
+  {
+    try
+    {
+      if (type == API_DOCTYPE_CHARSHEET)
+      {
+        job->cs = ApiCharSheet::create();
+        job->cs->parse_api_data(data);
+      }
+      else
+      {
+        job->sq = ApiSkillQueue::create();
+        job->sq->set_api_data(data);
+      }
+    }
+    catch (Exception& e)
+    {
+      std::cout << "Warning: Cannot parse cached sheet of "
+          << job->auth.char_id << ": " << e << std::endl;
+      job->cs.reset();
+      job->sq.reset();
+    }
+  }
+
+  /* The sheet holds the only reference when it is handed over. */
+  data.data.reset();
+
+  StartupProfile::add_phase(std::string(type == API_DOCTYPE_CHARSHEET
+      ? "CharacterSheet.xml" : "SkillQueue.xml") + " of "
+      + job->auth.char_id, start);
+
+  this->mutex.wait();
+  this->parsed_sheets.push_back(job);
+  this->mutex.post();
+
+  this->sig_dispatch_sheets.emit();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupLoader::dispatch_sheets (void)
+{
+  std::vector<StartupJob*> sheets;
+  this->mutex.wait();
+  sheets.swap(this->parsed_sheets);
+  this->mutex.post();
+
+  if (sheets.empty() && this->sheet_amount > 0)
+    return;
+
+  CharacterListPtr clist = CharacterList::request();
+  for (std::size_t i = 0; i < sheets.size(); ++i)
+  {
+    StartupJob* job = sheets[i];
+
+    /* The character may have been removed in the meantime. */
+    CharacterPtr character;
+    for (std::size_t j = 0; j < clist->chars.size(); ++j)
+      if (clist->chars[j]->get_char_id() == job->auth.char_id)
+        character = clist->chars[j];
+
+    if (character.get() != 0 && job->cs.get() != 0)
+      character->set_cached_charsheet(*job->cs);
+    if (character.get() != 0 && job->sq.get() != 0)
+      character->set_cached_skillqueue(*job->sq);
+
+    delete job;
+    this->published_sheets += 1;
+  }
+
+  if (this->published_sheets == this->sheet_amount)
+  {
+    StartupProfile::add_phase("Cached sheets until shown", this->start_time);
+    StartupProfile::print_report();
+  }
+}
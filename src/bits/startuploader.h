@@ -0,0 +1,97 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUP_LOADER_HEADER
+#define STARTUP_LOADER_HEADER
+
+#include <string>
+#include <vector>
+#include <glibmm/dispatcher.h>
+
+#include "util/thread.h"
+#include "api/eveapi.h"
+#include "api/apicharsheet.h"
+#include "api/apiskillqueue.h"
+
+enum StartupJobType
+{
+  STARTUP_JOB_SKILLTREE,
+  STARTUP_JOB_CERTTREE,
+  STARTUP_JOB_CHARSHEET,
+  STARTUP_JOB_SKILLQUEUE
+};
+
+/* ---------------------------------------------------------------- */
+
+/* A job is only accessed by one thread at a time. The sheets are
+ * created by the worker and handed over to the main thread. */
+struct StartupJob
+{
+  StartupJobType type;
+  EveApiAuth auth;
+  ApiCharSheetPtr cs;
+  ApiSkillQueuePtr sq;
+};
+
+/* ---------------------------------------------------------------- */
+
+class StartupLoaderWorker;
+
+/* Class for loading the data needed at startup on a pool of worker
+ * threads, one thread per processor. The skill and certificate trees
+ * are parsed in parallel with the cached sheets of all characters.
+ * Instructions:
+ * - Create the class after the configuration and data files are ready
+ * - Run start() and wait_for_trees() before the trees are used
+ * - If the trees cannot be loaded, the program exits from main()
+ * - The cached sheets are passed to the characters while the main
+ *   loop is running, in the order they have been parsed
+ * - The class must live until the main loop ends
+ */
+class StartupLoader
+{
+  friend class StartupLoaderWorker;
+
+  private:
+    std::vector<StartupLoaderWorker*> workers;
+    std::vector<StartupJob*> jobs;
+    std::vector<StartupJob*> parsed_sheets;
+    std::size_t sheet_amount;
+    std::size_t published_sheets;
+    double start_time;
+
+    /* Protects the job queue, the parsed sheets and the tree error. */
+    Semaphore mutex;
+    std::size_t next_job;
+    Semaphore trees_loaded;
+    std::string tree_error;
+
+    Glib::Dispatcher sig_dispatch_sheets;
+
+  protected:
+    /* Executed by the worker threads. */
+    void process_jobs (void);
+    void process_job (StartupJob* job);
+
+    void dispatch_sheets (void);
+
+  public:
+    StartupLoader (void);
+    ~StartupLoader (void);
+
+    void start (void);
+    /* Blocks until the skill and certificate trees are loaded.
+     * Returns false and reports the error if a tree cannot be loaded. */
+    bool wait_for_trees (void);
+};
+
+#endif /* STARTUP_LOADER_HEADER */
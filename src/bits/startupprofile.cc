@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "argumentsettings.h"
+#include "startupprofile.h"
+
+/* The timer starts running when it is constructed. */
+Glib::Timer StartupProfile::timer;
+Semaphore StartupProfile::mutex;
+std::vector<StartupPhase> StartupProfile::phases;
+
+/* ---------------------------------------------------------------- */
+
+bool
+startup_phase_less (StartupPhase const& a, StartupPhase const& b)
+{
+  return a.start < b.start;
+}
+
+/* ---------------------------------------------------------------- */
+
+double
+StartupProfile::get_time (void)
+{
+  return StartupProfile::timer.elapsed() * 1000.0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupProfile::add_phase (std::string const& name, double start)
+{
+  StartupPhase phase;
+  phase.name = name;
+  phase.start = start;
+  phase.end = StartupProfile::get_time();
+
+  StartupProfile::mutex.wait();
+  StartupProfile::phases.push_back(phase);
+  StartupProfile::mutex.post();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+StartupProfile::print_report (void)
+{
+  if (!ArgumentSettings::startup_profile)
+    return;
+
+  StartupProfile::mutex.wait();
+  std::vector<StartupPhase> phases(StartupProfile::phases);
+  StartupProfile::mutex.post();
+
+  /* Phases from the workers are added in the order they finish. */
+  std::stable_sort(phases.begin(), phases.end(), startup_phase_less);
+
+  std::cout << "Startup profile (times in milliseconds):" << std::endl
+      << "     Start       End  Duration  Phase" << std::endl
+      << std::fixed << std::setprecision(1);
+  for (std::size_t i = 0; i < phases.size(); ++i)
+  {
+    StartupPhase const& phase = phases[i];
+    std::cout << std::setw(10) << phase.start
+        << std::setw(10) << phase.end
+        << std::setw(10) << phase.end - phase.start
+        << "  " << phase.name << std::endl;
+  }
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << std::setprecision(6);
+}
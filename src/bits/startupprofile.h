@@ -0,0 +1,51 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUP_PROFILE_HEADER
+#define STARTUP_PROFILE_HEADER
+
+#include <string>
+#include <vector>
+#include <glibmm/timer.h>
+
+#include "util/thread.h"
+
+struct StartupPhase
+{
+  std::string name;
+  double start;
+  double end;
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Records the time spent in the phases of the startup. Phases may be
+ * added from any thread. The report is printed to the console if
+ * the --startup-profile argument has been given.
+ */
+class StartupProfile
+{
+  private:
+    static Glib::Timer timer;
+    static Semaphore mutex;
+    static std::vector<StartupPhase> phases;
+
+  public:
+    /* Returns the time in milliseconds since the start. */
+    static double get_time (void);
+    /* Adds a phase that started at the given time and ends now. */
+    static void add_phase (std::string const& name, double start);
+    static void print_report (void);
+};
+
+#endif /* STARTUP_PROFILE_HEADER */
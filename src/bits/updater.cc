@@ -6,6 +6,7 @@
 #include "api/evetime.h"
 #include "api/apicerttree.h"
 #include "api/apiskilltree.h"
+#include "api/xml.h"
 #include "bits/config.h"
 #include "util/os.h"
 #include "util/helpers.h"
@@ -24,17 +25,31 @@ UpdaterBase::UpdaterBase (void)
     file.server_host = "api.eveonline.com";
     file.server_path = "/eve/SkillTree.xml.aspx";
     file.local_path = conf_dir + "/" + file.file_name;
+    file.download_path = file.local_path + ".download";
+    file.conf_section = "updater.skilltree";
     this->files.push_back(file);
 
     file.file_name = "CertificateTree.xml";
     file.server_host = "api.eveonline.com";
     file.server_path = "/eve/CertificateTree.xml.aspx";
     file.local_path = conf_dir + "/" + file.file_name;
+    file.download_path = file.local_path + ".download";
+    file.conf_section = "updater.certtree";
     this->files.push_back(file);
 }
 
 /* ---------------------------------------------------------------- */
 
+void
+UpdaterBase::remove_downloads (void)
+{
+    for (std::size_t i = 0; i < this->files.size(); ++i)
+        if (OS::file_exists(this->files[i].download_path.c_str()))
+            OS::unlink(this->files[i].download_path.c_str());
+}
+
+/* ---------------------------------------------------------------- */
+
 Updater::~Updater (void)
 {
 }
@@ -63,6 +78,7 @@ Updater::background_check_intern (void)
     std::cout << "Updater: Interval expired, "
         << "downloading data files..." << std::endl;
     std::vector<HttpDataPtr> http_result;
+    std::vector<bool> is_conditional;
     for (std::size_t i = 0; i < this->files.size(); ++i)
     {
         /* AsyncHttp is used synchronously, so it doesn't delete itself. */
@@ -70,6 +86,18 @@ Updater::background_check_intern (void)
         Config::setup_http(fetcher, true);
         fetcher->set_host(this->files[i].server_host);
         fetcher->set_path(this->files[i].server_path);
+
+        /* Unchanged files are answered with 304 Not Modified. */
+        std::vector<std::string> headers
+            = Updater::get_conditional_headers(this->files[i]);
+        for (std::size_t j = 0; j < headers.size(); ++j)
+            fetcher->add_header(headers[j]);
+        is_conditional.push_back(!headers.empty());
+
+        /* The file is checked and written next to the local file. */
+        fetcher->set_sink(XmlParserSink::create
+            (HttpFileSink::create(this->files[i].download_path)));
+
         try
         {
             http_result.push_back(fetcher->request());
@@ -80,8 +108,23 @@ Updater::background_check_intern (void)
             std::cout << "Updater: Error downloading "
                 << this->files[i].file_name << ": " << e.what() << std::endl;
             delete fetcher;
+            this->remove_downloads();
+            return false;
+        }
+
+        HttpStatusCode code = http_result.back()->http_code;
+        if (code != 200 && code != 304)
+        {
+            std::cout << "Updater: Error downloading "
+                << this->files[i].file_name << ": HTTP status "
+                << code << std::endl;
+            this->remove_downloads();
             return false;
         }
+
+        if (code == 200)
+            Updater::print_transfer_size(this->files[i].file_name,
+                http_result.back());
     }
 
     /* Compare downloaded files with local files. */
@@ -90,32 +133,64 @@ Updater::background_check_intern (void)
     {
         std::string file_name = this->files[i].file_name;
         std::string file_path = this->files[i].local_path;
+        std::string download_path = this->files[i].download_path;
+
+        if (http_result[i]->http_code == 304)
+        {
+            std::cout << "Updater: " << file_name
+                << ": File not modified, ignoring." << std::endl;
+            continue;
+        }
 
-        if (!Updater::is_same_file(file_path, http_result[i]))
+        /* Changed validators mean a changed file. The contents are
+         * only compared if the server does not provide validators. */
+        bool is_changed = true;
+        if (!is_conditional[i] || !Updater::has_validators(http_result[i]))
+            is_changed = !Updater::is_same_file(file_path, download_path);
+
+        if (is_changed)
         {
+            /* Replace the local file with the downloaded file. */
+            if (!OS::rename(download_path.c_str(), file_path.c_str()))
+            {
+                std::cout << "Updater: " << file_name
+                    << ": Cannot replace file!" << std::endl;
+                OS::unlink(download_path.c_str());
+                continue;
+            }
+
             std::cout << "Updater: " << file_name
                 << ": File changed, updated!" << std::endl;
             same_files = false;
 
-            /* Write new HTTP contents to file. */
-            std::string new_contents;
-            new_contents.insert(new_contents.end(),
-                http_result[i]->data.begin(), http_result[i]->data.end());
-            Helpers::write_file(file_path, new_contents);
-
-            /* Update the corresponding sheet. */
-            if (ApiCertTree::request()->get_filename() == file_path)
-                ApiCertTree::request()->refresh();
-            else if (ApiSkillTree::request()->get_filename() == file_path)
-                ApiSkillTree::request()->refresh();
-            else
-                std::cout << "Updater: File association failed!" << std::endl;
+            /* Update the corresponding sheet and its snapshot. A file
+             * that cannot be loaded is removed and downloaded again on
+             * the next start. The error is passed to the caller. */
+            try
+            {
+                if (ApiCertTree::request()->get_filename() == file_path)
+                    ApiCertTree::request()->refresh();
+                else if (ApiSkillTree::request()->get_filename() == file_path)
+                    ApiSkillTree::request()->refresh();
+                else
+                    std::cout << "Updater: File association failed!"
+                        << std::endl;
+            }
+            catch (Exception&)
+            {
+                OS::unlink(file_path.c_str());
+                this->remove_downloads();
+                throw;
+            }
         }
         else
         {
             std::cout << "Updater: " << file_name
                 << ": File unchanged, ignoring." << std::endl;
+            OS::unlink(download_path.c_str());
         }
+
+        Updater::store_validators(this->files[i], http_result[i]);
     }
 
     Updater::set_last_update_now();
@@ -128,7 +203,20 @@ Updater::background_check_intern (void)
 void
 Updater::background_check (void)
 {
-    if (this->background_check_intern())
+    /* The main thread reports errors, this thread must not exit. */
+    bool changed = false;
+    try
+    {
+        changed = this->background_check_intern();
+    }
+    catch (Exception& e)
+    {
+        this->error = e;
+        this->sig_dispatch_files_failed.emit();
+        return;
+    }
+
+    if (changed)
         this->sig_dispatch_files_changed.emit();
     else
         this->sig_dispatch_files_unchanged.emit();
@@ -185,13 +273,88 @@ Updater::set_last_update_now (void)
 
 /* ---------------------------------------------------------------- */
 
+std::vector<std::string>
+Updater::get_conditional_headers (UpdaterDataFile const& file)
+{
+    std::vector<std::string> headers;
+
+    /* The file is not read, the modification time tells if the
+     * file is still the one the validators were stored for. */
+    char const* path = file.local_path.c_str();
+    int stored_mtime = Config::conf.get_value
+        (file.conf_section + ".file_mtime")->get_int();
+    if (!OS::file_exists(path) || stored_mtime == 0
+        || stored_mtime != (int)OS::file_mtime(path))
+        return headers;
+
+    std::string etag = Config::conf.get_value
+        (file.conf_section + ".etag")->get_string();
+    std::string last_modified = Config::conf.get_value
+        (file.conf_section + ".last_modified")->get_string();
+
+    if (!etag.empty())
+        headers.push_back("If-None-Match: " + etag);
+    if (!last_modified.empty())
+        headers.push_back("If-Modified-Since: " + last_modified);
+
+    return headers;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+Updater::store_validators (UpdaterDataFile const& file, HttpDataPtr data)
+{
+    /* A 304 response may omit validators, the stored ones stay valid. */
+    if (data->http_code == 304)
+        return;
+
+    int mtime = 0;
+    if (Updater::has_validators(data))
+        mtime = (int)OS::file_mtime(file.local_path.c_str());
+
+    Config::conf.get_value(file.conf_section + ".etag")
+        ->set(data->get_header("ETag"));
+    Config::conf.get_value(file.conf_section + ".last_modified")
+        ->set(data->get_header("Last-Modified"));
+    Config::conf.get_value(file.conf_section + ".file_mtime")->set(mtime);
+}
+
+/* ---------------------------------------------------------------- */
+
 bool
-Updater::is_same_file (std::string const& filename, HttpDataPtr data)
+Updater::has_validators (HttpDataPtr data)
 {
-    /* Read file. */
+    return !data->get_header("ETag").empty()
+        || !data->get_header("Last-Modified").empty();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+Updater::print_transfer_size (std::string const& name, HttpDataPtr data)
+{
+    std::cout << "Updater: " << name << ": Received "
+        << Helpers::get_string_from_float((float)data->wire_size / 1024.0f, 0)
+        << " KB, decoded "
+        << Helpers::get_string_from_float((float)data->body_size / 1024.0f, 0)
+        << " KB" << std::endl;
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+Updater::is_same_file (std::string const& filename,
+    std::string const& download)
+{
+    /* Read files. */
     std::string file_contents;
+    std::string download_contents;
     try
-    { Helpers::read_file(filename, &file_contents); }
+    {
+        Helpers::read_file(filename, &file_contents);
+        Helpers::read_file(download, &download_contents);
+    }
     catch (...)
     {
         std::cout << "File compare: Cannot read file!" << std::endl;
@@ -199,10 +362,10 @@ Updater::is_same_file (std::string const& filename, HttpDataPtr data)
     }
 
     /* Compare file size. */
-    if (file_contents.size() != data->data.size())
+    if (file_contents.size() != download_contents.size())
     {
         std::cout << "File compare: Size differs: "
-            << file_contents.size() << " vs " << data->data.size()
+            << file_contents.size() << " vs " << download_contents.size()
             << std::endl;
         return false;
     }
@@ -243,7 +406,7 @@ Updater::is_same_file (std::string const& filename, HttpDataPtr data)
         if (ignore_bytes)
             continue;
 
-        if (file_contents[i] != data->data[i])
+        if (file_contents[i] != download_contents[i])
             return false;
     }
 
@@ -25,6 +25,8 @@
  * the API host is "api.eveonline.com", the server path in case of SkillTree
  * is "eve/SkillTree.xml.aspx". The local path is generated from the
  * directory where the GtkEveMon config resides plus the file name.
+ * Downloads are written to the download path next to the local file.
+ * The config section keeps the HTTP validators of the local file.
  */
 struct UpdaterDataFile
 {
@@ -32,6 +34,8 @@ struct UpdaterDataFile
     std::string server_host;
     std::string server_path;
     std::string local_path;
+    std::string download_path;
+    std::string conf_section;
 };
 
 /* ---------------------------------------------------------------- */
@@ -47,6 +51,9 @@ public:
 
 protected:
     std::vector<UpdaterDataFile> files;
+
+    /* Removes the downloaded files that were not used. */
+    void remove_downloads (void);
 };
 
 /* ---------------------------------------------------------------- */
@@ -55,13 +62,16 @@ protected:
  * Updater that checks if update interval is expired and downloads
  * new data files from the EVE API. If the data files have changed,
  * the corresponding signal is fired. Otherwise, the no change signal
- * is fired.
+ * is fired. If an updated file cannot be loaded, the failed signal is
+ * fired and the error is available with get_error().
  */
 class Updater : public UpdaterBase, public Thread
 {
 private:
     Glib::Dispatcher sig_dispatch_files_changed;
     Glib::Dispatcher sig_dispatch_files_unchanged;
+    Glib::Dispatcher sig_dispatch_files_failed;
+    std::string error;
 
 protected:
     void* run (void);
@@ -95,12 +105,41 @@ public:
 
     /*
      * Checks whether the given filename has the same contents as
-     * the downloaded HTTP data.
+     * the downloaded file.
+     */
+    static bool is_same_file (std::string const& filename,
+        std::string const& download);
+
+    /*
+     * Returns If-None-Match and If-Modified-Since headers with the
+     * validators stored for the file. No headers are returned if the
+     * local file was replaced since the validators were stored.
+     */
+    static std::vector<std::string> get_conditional_headers
+        (UpdaterDataFile const& file);
+
+    /*
+     * Stores the ETag and Last-Modified validators of the HTTP data
+     * together with the modification time of the local file. The
+     * configuration is saved with the time of the last update.
+     */
+    static void store_validators (UpdaterDataFile const& file,
+        HttpDataPtr data);
+
+    /* Checks whether the HTTP data has an ETag or Last-Modified header. */
+    static bool has_validators (HttpDataPtr data);
+
+    /*
+     * Prints the size of a downloaded file on the wire and after
+     * decoding, which differ if the server compressed the file.
      */
-    static bool is_same_file (std::string const& filename, HttpDataPtr data);
+    static void print_transfer_size (std::string const& name,
+        HttpDataPtr data);
 
     Glib::Dispatcher& signal_files_changed (void);
     Glib::Dispatcher& signal_files_unchanged (void);
+    Glib::Dispatcher& signal_files_failed (void);
+    std::string const& get_error (void) const;
 };
 
 /* ---------------------------------------------------------------- */
@@ -117,4 +156,16 @@ Updater::signal_files_changed (void)
     return this->sig_dispatch_files_changed;
 }
 
+inline Glib::Dispatcher&
+Updater::signal_files_failed (void)
+{
+    return this->sig_dispatch_files_failed;
+}
+
+inline std::string const&
+Updater::get_error (void) const
+{
+    return this->error;
+}
+
 #endif /* UPDATER_HEADER */
@@ -21,6 +21,10 @@
 #include "bits/config.h"
 #include "bits/server.h"
 #include "bits/updater.h"
+#include "bits/startuploader.h"
+#include "bits/startupprofile.h"
+#include "net/httploop.h"
+#include "net/httppool.h"
 #include "gui/imagestore.h"
 #include "gui/maingui.h"
 
@@ -40,15 +44,23 @@ main (int argc, char* argv[])
     Glib::thread_init();
 #endif
 
+  double start = StartupProfile::get_time();
   Gtk::Main kit(&argc, &argv);
+  HttpHandlePool::init();
+  HttpLoop::init();
   ArgumentSettings::init(argc, argv);
   Config::init_defaults();
   Config::init_config_path();
   Config::init_user_config();
+  StartupProfile::add_phase("Toolkit and configuration", start);
 
+  start = StartupProfile::get_time();
   ImageStore::init();
+  StartupProfile::add_phase("Image store", start);
 
+  start = StartupProfile::get_time();
   Updater::check_data_files();
+  StartupProfile::add_phase("Data file check", start);
 
   ServerList::init_from_config();
   EveTime::init_from_config();
@@ -56,16 +68,29 @@ main (int argc, char* argv[])
   std::signal(SIGINT, signal_received);
   std::signal(SIGTERM, signal_received);
 
+  bool trees_loaded = false;
   {
-    MainGui gui;
-    kit.run();
+    /* The trees are parsed in parallel and the
+     * cached sheets are parsed while the GUI is set up. */
+    StartupLoader loader;
+    loader.start();
+    trees_loaded = loader.wait_for_trees();
+    if (trees_loaded)
+    {
+      start = StartupProfile::get_time();
+      MainGui gui;
+      StartupProfile::add_phase("Main window", start);
+      kit.run();
+    }
   }
 
   EveTime::store_to_config();
   ServerList::unload();
   ImageStore::unload();
+  HttpLoop::unload();
+  HttpHandlePool::unload();
 
   Config::unload();
 
-  return EXIT_SUCCESS;
+  return trees_loaded ? EXIT_SUCCESS : EXIT_FAILURE;
 }
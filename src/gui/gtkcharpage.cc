@@ -8,6 +8,7 @@
 // You should have received a copy of the GNU General Public License
 // along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -21,6 +22,7 @@
 #include "bits/config.h"
 #include "bits/notifier.h"
 #include "bits/characterlist.h"
+#include "bits/eventscheduler.h"
 
 #include "imagestore.h"
 #include "gtkdefines.h"
@@ -32,77 +34,116 @@
 GtkCharPage::GtkCharPage (CharacterPtr character)
   : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5),
     character(character),
-    info_display(INFO_STYLE_TOP_HSEP)
+    gui(0),
+    completion_event(0),
+    expiry_event(0),
+    duration_event(0),
+    page_mapped(false),
+    window_visible(true)
 {
+  /* Only the documents and notifications are handled until the page
+   * is shown the first time. The widgets are built by build_page(). */
+  this->character->signal_api_info_changed().connect
+      (sigc::mem_fun(*this, &GtkCharPage::api_info_changed));
+  this->character->signal_skill_completed().connect
+      (sigc::mem_fun(*this, &GtkCharPage::on_skill_completed));
+  this->character->signal_request_error().connect(sigc::bind
+      (sigc::mem_fun(*this, &GtkCharPage::on_api_error), false));
+  this->character->signal_cached_warning().connect(sigc::bind
+      (sigc::mem_fun(*this, &GtkCharPage::on_api_error), true));
+  this->character->signal_training_changed().connect
+      (sigc::mem_fun(*this, &GtkCharPage::update_training_details));
+
+  /* Request data update. */
+  this->request_documents();
+  this->schedule_expiry_check();
+  this->update_training_details();
+
+  /* The notebook only shows tabs for visible pages. */
+  this->show();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::build_page (void)
+{
+  if (this->gui != 0)
+    return;
+  this->gui = new GtkCharPageWidgets;
+
   /* Setup GUI. */
-  this->char_image.set_enable_clicks();
-
-  this->refresh_but.set_image_from_icon_name("view-refresh", Gtk::ICON_SIZE_MENU);
-  this->refresh_but.set_relief(Gtk::RELIEF_NONE);
-  this->refresh_but.set_focus_on_click(false);
-
-  this->info_but.set_image_from_icon_name("dialog-information", Gtk::ICON_SIZE_MENU);
-  this->info_but.set_relief(Gtk::RELIEF_NONE);
-
-  this->char_name_label.set_halign(Gtk::ALIGN_START);
-  this->char_info_label.set_halign(Gtk::ALIGN_START);
-  this->corp_label.set_halign(Gtk::ALIGN_START);
-  this->balance_label.set_halign(Gtk::ALIGN_START);
-  this->skill_points_label.set_halign(Gtk::ALIGN_START);
-  this->known_skills_label.set_halign(Gtk::ALIGN_START);
-  this->attr_cha_label.set_halign(Gtk::ALIGN_START);
-  this->attr_int_label.set_halign(Gtk::ALIGN_START);
-  this->attr_per_label.set_halign(Gtk::ALIGN_START);
-  this->attr_mem_label.set_halign(Gtk::ALIGN_START);
-  this->attr_wil_label.set_halign(Gtk::ALIGN_START);
-  this->training_label.set_halign(Gtk::ALIGN_START);
-  this->remaining_label.set_halign(Gtk::ALIGN_START);
-  this->finish_eve_label.set_halign(Gtk::ALIGN_START);
-  this->finish_local_label.set_halign(Gtk::ALIGN_START);
-  this->spph_label.set_halign(Gtk::ALIGN_END);
-  this->live_sp_label.set_halign(Gtk::ALIGN_END);
-
-  this->charsheet_info_label.set_halign(Gtk::ALIGN_END);
-  this->skillqueue_info_label.set_halign(Gtk::ALIGN_END);
+  this->gui->char_image.set_enable_clicks();
+
+  this->gui->refresh_but.set_image_from_icon_name("view-refresh",
+      Gtk::ICON_SIZE_MENU);
+  this->gui->refresh_but.set_relief(Gtk::RELIEF_NONE);
+  this->gui->refresh_but.set_focus_on_click(false);
+
+  this->gui->info_but.set_image_from_icon_name("dialog-information",
+      Gtk::ICON_SIZE_MENU);
+  this->gui->info_but.set_relief(Gtk::RELIEF_NONE);
+
+  this->gui->char_name_label.set_halign(Gtk::ALIGN_START);
+  this->gui->char_info_label.set_halign(Gtk::ALIGN_START);
+  this->gui->corp_label.set_halign(Gtk::ALIGN_START);
+  this->gui->balance_label.set_halign(Gtk::ALIGN_START);
+  this->gui->skill_points_label.set_halign(Gtk::ALIGN_START);
+  this->gui->known_skills_label.set_halign(Gtk::ALIGN_START);
+  this->gui->attr_cha_label.set_halign(Gtk::ALIGN_START);
+  this->gui->attr_int_label.set_halign(Gtk::ALIGN_START);
+  this->gui->attr_per_label.set_halign(Gtk::ALIGN_START);
+  this->gui->attr_mem_label.set_halign(Gtk::ALIGN_START);
+  this->gui->attr_wil_label.set_halign(Gtk::ALIGN_START);
+  this->gui->training_label.set_halign(Gtk::ALIGN_START);
+  this->gui->remaining_label.set_halign(Gtk::ALIGN_START);
+  this->gui->finish_eve_label.set_halign(Gtk::ALIGN_START);
+  this->gui->finish_local_label.set_halign(Gtk::ALIGN_START);
+  this->gui->spph_label.set_halign(Gtk::ALIGN_END);
+  this->gui->live_sp_label.set_halign(Gtk::ALIGN_END);
+
+  this->gui->charsheet_info_label.set_halign(Gtk::ALIGN_END);
+  this->gui->skillqueue_info_label.set_halign(Gtk::ALIGN_END);
 
   /* Setup skill list. */
   Gtk::TreeViewColumn* name_column = Gtk::manage(new Gtk::TreeViewColumn);
   name_column->set_title("Skill name (rank)");
-  name_column->pack_start(this->skill_cols.icon, false);
+  name_column->pack_start(this->gui->skill_cols.icon, false);
   #ifdef GLIBMM_PROPERTIES_ENABLED
   Gtk::CellRendererText* name_renderer = Gtk::manage(new Gtk::CellRendererText);
   name_column->pack_start(*name_renderer, true);
   name_column->add_attribute(name_renderer->property_markup(),
-      this->skill_cols.name);
+      this->gui->skill_cols.name);
   #else
   /* FIXME: Activate markup here. */
-  name_column->pack_start(this->skill_cols.name);
+  name_column->pack_start(this->gui->skill_cols.name);
   #endif
 
-  this->skill_store = Gtk::TreeStore::create(this->skill_cols);
-  this->skill_store->set_sort_column
-      (this->skill_cols.name, Gtk::SORT_ASCENDING);
-  this->skill_view.set_model(this->skill_store);
-  this->skill_view.set_rules_hint(true);
-  this->skill_view.append_column(*name_column);
-  this->skill_view.append_column("Level", this->skill_cols.level);
-  this->skill_view.append_column("Points", this->skill_cols.points);
-  this->skill_view.append_column("Max. Points", this->skill_cols.max_points);
-  this->skill_view.append_column("Pri.", this->skill_cols.primary);
-  this->skill_view.append_column("Sec.", this->skill_cols.secondary);
-  this->skill_view.get_column(0)->set_expand(true);
-  this->skill_view.get_column(2)->get_first_cell()
+  this->gui->skill_store = Gtk::TreeStore::create(this->gui->skill_cols);
+  this->gui->skill_store->set_sort_column
+      (this->gui->skill_cols.name, Gtk::SORT_ASCENDING);
+  this->gui->skill_view.set_model(this->gui->skill_store);
+  this->gui->skill_view.set_rules_hint(true);
+  this->gui->skill_view.append_column(*name_column);
+  this->gui->skill_view.append_column("Level", this->gui->skill_cols.level);
+  this->gui->skill_view.append_column("Points", this->gui->skill_cols.points);
+  this->gui->skill_view.append_column("Max. Points",
+      this->gui->skill_cols.max_points);
+  this->gui->skill_view.append_column("Pri.", this->gui->skill_cols.primary);
+  this->gui->skill_view.append_column("Sec.", this->gui->skill_cols.secondary);
+  this->gui->skill_view.get_column(0)->set_expand(true);
+  this->gui->skill_view.get_column(2)->get_first_cell()
       ->set_property("xalign", 1.0f);
-  this->skill_view.get_column(3)->get_first_cell()
+  this->gui->skill_view.get_column(3)->get_first_cell()
       ->set_property("xalign", 1.0f);
 
-  //this->skill_view.set_grid_lines(Gtk::TREE_VIEW_GRID_LINES_BOTH);
+  //this->gui->skill_view.set_grid_lines(Gtk::TREE_VIEW_GRID_LINES_BOTH);
 
   /* Build GUI elements. */
   Gtk::ScrolledWindow* scwin = Gtk::manage(new Gtk::ScrolledWindow);
   scwin->set_shadow_type(Gtk::SHADOW_ETCHED_IN);
   scwin->set_policy(Gtk::POLICY_AUTOMATIC, Gtk::POLICY_ALWAYS);
-  scwin->add(this->skill_view);
+  scwin->add(this->gui->skill_view);
   scwin->show_all();
 
   Gtk::Table* info_table = Gtk::manage(new Gtk::Table(5, 7));
@@ -133,26 +174,31 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
   Gtk::Box* char_buts_vbox = MK_VBOX(0);
   char_buts_vbox->pack_start(*close_but, false, false, 0);
   //char_buts_vbox->pack_start(*MK_HSEP, true, true, 0);
-  char_buts_vbox->pack_end(this->refresh_but, false, false, 0);
-  char_buts_vbox->pack_end(this->info_but, false, false, 0);
+  char_buts_vbox->pack_end(this->gui->refresh_but, false, false, 0);
+  char_buts_vbox->pack_end(this->gui->info_but, false, false, 0);
   Gtk::Box* char_buts_hbox = MK_HBOX(5);
   char_buts_hbox->pack_end(*char_buts_vbox, false, false, 0);
 
   /* Character SP */
   Gtk::Box* char_skillpoints_box = MK_HBOX(5);
-  char_skillpoints_box->pack_start(this->skill_points_label, false, false, 0);
+  char_skillpoints_box->pack_start(this->gui->skill_points_label,
+      false, false, 0);
 
-  info_table->attach(this->char_image, 0, 1, 0, 5, Gtk::SHRINK, Gtk::SHRINK);
-  info_table->attach(this->char_name_label, 1, 2, 0, 1, Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->char_image, 0, 1, 0, 5,
+      Gtk::SHRINK, Gtk::SHRINK);
+  info_table->attach(this->gui->char_name_label, 1, 2, 0, 1,
+      Gtk::FILL, Gtk::FILL);
   info_table->attach(*corp_desc, 1, 2, 1, 2, Gtk::FILL, Gtk::FILL);
   info_table->attach(*isk_desc, 1, 2, 2, 3, Gtk::FILL, Gtk::FILL);
   info_table->attach(*skillpoints_desc, 1, 2, 3, 4, Gtk::FILL, Gtk::FILL);
   info_table->attach(*knownskills_desc, 1, 2, 4, 5, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->char_info_label, 2, 3, 0, 1, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->corp_label, 2, 3, 1, 2, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->balance_label, 2, 3, 2, 3, Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->char_info_label, 2, 3, 0, 1,
+      Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->corp_label, 2, 3, 1, 2, Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->balance_label, 2, 3, 2, 3,
+      Gtk::FILL, Gtk::FILL);
   info_table->attach(*char_skillpoints_box, 2, 3, 3, 4, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->known_skills_label, 2, 3, 4, 5,
+  info_table->attach(this->gui->known_skills_label, 2, 3, 4, 5,
       Gtk::FILL, Gtk::FILL);
   info_table->attach(*MK_VSEP, 3, 4, 0, 5, Gtk::FILL, Gtk::FILL);
   info_table->attach(*attr_charisma_desc, 4, 5, 0, 1, Gtk::FILL, Gtk::FILL);
@@ -160,11 +206,16 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
   info_table->attach(*attr_perception_desc, 4, 5, 2, 3, Gtk::FILL, Gtk::FILL);
   info_table->attach(*attr_memory_desc, 4, 5, 3, 4, Gtk::FILL, Gtk::FILL);
   info_table->attach(*attr_willpower_desc, 4, 5, 4, 5, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->attr_cha_label, 5, 6, 0, 1, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->attr_int_label, 5, 6, 1, 2, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->attr_per_label, 5, 6, 2, 3, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->attr_mem_label, 5, 6, 3, 4, Gtk::FILL, Gtk::FILL);
-  info_table->attach(this->attr_wil_label, 5, 6, 4, 5, Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->attr_cha_label, 5, 6, 0, 1,
+      Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->attr_int_label, 5, 6, 1, 2,
+      Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->attr_per_label, 5, 6, 2, 3,
+      Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->attr_mem_label, 5, 6, 3, 4,
+      Gtk::FILL, Gtk::FILL);
+  info_table->attach(this->gui->attr_wil_label, 5, 6, 4, 5,
+      Gtk::FILL, Gtk::FILL);
   info_table->attach(*char_buts_hbox, 6, 7, 0, 5,
       Gtk::FILL | Gtk::EXPAND, Gtk::SHRINK | Gtk::FILL);
 
@@ -182,10 +233,12 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
   Gtk::Label* charsheet_info_desc = MK_LABEL("Character sheet:");
   Gtk::Label* trainsheet_info_desc = MK_LABEL("Skill queue:");
   Gtk::Box* charsheet_info_hbox = MK_HBOX(5);
-  charsheet_info_hbox->pack_end(this->charsheet_info_label, false, false, 0);
+  charsheet_info_hbox->pack_end(this->gui->charsheet_info_label,
+      false, false, 0);
   charsheet_info_hbox->pack_end(*charsheet_info_desc, false, false, 0);
   Gtk::Box* trainsheet_info_hbox = MK_HBOX(5);
-  trainsheet_info_hbox->pack_end(this->skillqueue_info_label, false, false, 0);
+  trainsheet_info_hbox->pack_end(this->gui->skillqueue_info_label,
+      false, false, 0);
   trainsheet_info_hbox->pack_end(*trainsheet_info_desc, false, false, 0);
 
   /* Setup training table. */
@@ -206,13 +259,13 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
   train_table->attach(*train_sub_tbl, 0, 1, 0, 2, Gtk::FILL, Gtk::FILL);
   train_table->attach(*finish_eve_desc, 0, 1, 2, 3, Gtk::FILL, Gtk::FILL);
   train_table->attach(*finish_local_desc, 0, 1, 3, 4, Gtk::FILL, Gtk::FILL);
-  train_table->attach(this->training_label, 1, 2, 0, 1, Gtk::FILL);
-  train_table->attach(this->remaining_label, 1, 2, 1, 2, Gtk::FILL);
-  train_table->attach(this->finish_eve_label, 1, 2, 2, 3, Gtk::FILL);
-  train_table->attach(this->finish_local_label, 1, 2, 3, 4, Gtk::FILL);
-  train_table->attach(this->spph_label, 2, 3, 2, 3,
+  train_table->attach(this->gui->training_label, 1, 2, 0, 1, Gtk::FILL);
+  train_table->attach(this->gui->remaining_label, 1, 2, 1, 2, Gtk::FILL);
+  train_table->attach(this->gui->finish_eve_label, 1, 2, 2, 3, Gtk::FILL);
+  train_table->attach(this->gui->finish_local_label, 1, 2, 3, 4, Gtk::FILL);
+  train_table->attach(this->gui->spph_label, 2, 3, 2, 3,
       Gtk::FILL | Gtk::EXPAND, Gtk::SHRINK);
-  train_table->attach(this->live_sp_label, 2, 3, 3, 4,
+  train_table->attach(this->gui->live_sp_label, 2, 3, 3, 4,
       Gtk::FILL | Gtk::EXPAND, Gtk::SHRINK);
   train_table->attach(*charsheet_info_hbox, 2, 3, 0, 1,
       Gtk::FILL | Gtk::EXPAND, Gtk::FILL);
@@ -224,56 +277,53 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
   this->pack_start(*info_table, false, false, 0);
   this->pack_start(*scwin, true, true, 0);
   this->pack_start(*train_table, false, false, 0);
-  this->pack_start(this->info_display, false, false, 0);
+  this->pack_start(this->gui->info_display, false, false, 0);
 
   /* Setup tooltips. */
   close_but->set_tooltip_text("Close the character");
-  this->info_but.set_tooltip_text("Infomation about cached sheets");
-  this->refresh_but.set_tooltip_text("Request API information");
+  this->gui->info_but.set_tooltip_text("Infomation about cached sheets");
+  this->gui->refresh_but.set_tooltip_text("Request API information");
 
   /* Signals. */
   close_but->signal_clicked().connect(sigc::mem_fun
       (*this, &GtkCharPage::on_close_clicked));
   skillqueue_but->signal_clicked().connect(sigc::mem_fun
       (*this, &GtkCharPage::on_skillqueue_clicked));
-  this->refresh_but.signal_clicked().connect(sigc::mem_fun
+  this->gui->refresh_but.signal_clicked().connect(sigc::mem_fun
       (*this, &GtkCharPage::request_documents));
-  this->info_but.signal_clicked().connect(sigc::mem_fun
+  this->gui->info_but.signal_clicked().connect(sigc::mem_fun
       (*this, &GtkCharPage::on_info_clicked));
-  this->skill_view.signal_row_activated().connect(sigc::mem_fun
+  this->gui->skill_view.signal_row_activated().connect(sigc::mem_fun
       (*this, &GtkCharPage::on_skill_activated));
-  this->skill_view.set_has_tooltip(true);
-  this->skill_view.signal_query_tooltip().connect(sigc::mem_fun
+  this->gui->skill_view.set_has_tooltip(true);
+  this->gui->skill_view.signal_query_tooltip().connect(sigc::mem_fun
       (*this, &GtkCharPage::on_query_skillview_tooltip));
 
-  this->character->signal_api_info_changed().connect
-      (sigc::mem_fun(*this, &GtkCharPage::api_info_changed));
-  this->character->signal_skill_completed().connect
-      (sigc::mem_fun(*this, &GtkCharPage::on_skill_completed));
-  this->character->signal_request_error().connect(sigc::bind
-      (sigc::mem_fun(*this, &GtkCharPage::on_api_error), false));
-  this->character->signal_cached_warning().connect(sigc::bind
-      (sigc::mem_fun(*this, &GtkCharPage::on_api_error), true));
-  this->character->signal_training_changed().connect
-      (sigc::mem_fun(*this, &GtkCharPage::update_training_details));
-
-  Glib::signal_timeout().connect(sigc::mem_fun(*this,
-      &GtkCharPage::on_live_sp_value_update), CHARPAGE_LIVE_SP_LABEL_UPDATE);
-  Glib::signal_timeout().connect(sigc::mem_fun(*this,
-      &GtkCharPage::on_live_sp_image_update), CHARPAGE_LIVE_SP_IMAGE_UPDATE);
-  Glib::signal_timeout().connect(sigc::mem_fun(*this,
-      &GtkCharPage::check_expired_sheets), CHARPAGE_CHECK_EXPIRED_SHEETS);
-  Glib::signal_timeout().connect(sigc::mem_fun(*this,
-      &GtkCharPage::update_cached_duration), CHARPAGE_UPDATE_CACHED_DURATION);
-
-  /* Request data update and update GUI. */
-  this->request_documents();
-  this->char_image.set(this->character->get_char_id());
+  this->gui->char_image.set(this->character->get_char_id());
   this->update_charsheet_details();
   this->update_training_details();
+  this->on_live_sp_value_update();
+  this->on_live_sp_image_update();
+
+  /* Show the messages appended before the page was built. */
+  bool show_info = !this->info_log.empty();
+  for (std::size_t i = 0; i < this->info_log.size(); ++i)
+    this->gui->info_display.append(this->info_log[i]);
+  this->info_log.clear();
 
   this->show_all();
-  this->info_display.hide();
+  if (!show_info)
+    this->gui->info_display.hide();
+}
+
+/* ---------------------------------------------------------------- */
+
+GtkCharPage::~GtkCharPage (void)
+{
+  EventScheduler::remove(this->completion_event);
+  EventScheduler::remove(this->expiry_event);
+  EventScheduler::remove(this->duration_event);
+  delete this->gui;
 }
 
 /* ---------------------------------------------------------------- */
@@ -281,30 +331,34 @@ GtkCharPage::GtkCharPage (CharacterPtr character)
 void
 GtkCharPage::update_charsheet_details (void)
 {
+  /* The details are filled in when the page is built. */
+  if (this->gui == 0)
+    return;
+
   ApiCharSheetPtr cs = this->character->cs;
   ApiSkillTreePtr tree = ApiSkillTree::request();
 
-  this->char_name_label.set_text("<b>"
+  this->gui->char_name_label.set_text("<b>"
       + this->character->get_char_name() + "</b>");
-  this->char_name_label.set_use_markup(true);
+  this->gui->char_name_label.set_use_markup(true);
 
   /* Set character information. */
   if (!cs->valid)
   {
-    this->char_info_label.set_text("---");
-    this->corp_label.set_text("---");
-    this->balance_label.set_text("---");
-    this->skill_points_label.set_text("---");
-    this->known_skills_label.set_text("---");
-    this->attr_cha_label.set_text("---");
-    this->attr_int_label.set_text("---");
-    this->attr_per_label.set_text("---");
-    this->attr_mem_label.set_text("---");
-    this->attr_wil_label.set_text("---");
-
-    this->known_skills_label.set_has_tooltip(false);
-    this->skill_points_label.set_has_tooltip(false);
-    this->attr_cha_label.set_has_tooltip(false);
+    this->gui->char_info_label.set_text("---");
+    this->gui->corp_label.set_text("---");
+    this->gui->balance_label.set_text("---");
+    this->gui->skill_points_label.set_text("---");
+    this->gui->known_skills_label.set_text("---");
+    this->gui->attr_cha_label.set_text("---");
+    this->gui->attr_int_label.set_text("---");
+    this->gui->attr_per_label.set_text("---");
+    this->gui->attr_mem_label.set_text("---");
+    this->gui->attr_wil_label.set_text("---");
+
+    this->gui->known_skills_label.set_has_tooltip(false);
+    this->gui->skill_points_label.set_has_tooltip(false);
+    this->gui->attr_cha_label.set_has_tooltip(false);
   }
   else
   {
@@ -313,35 +367,36 @@ GtkCharPage::update_charsheet_details (void)
         ("settings.trunc_corpname");
 
     /* Set character labels. */
-    this->char_info_label.set_text(cs->gender + ", "
+    this->gui->char_info_label.set_text(cs->gender + ", "
         + cs->race + ", " + cs->bloodline);
-    this->balance_label.set_text(Helpers::get_dotted_isk(cs->balance) + " ISK");
+    this->gui->balance_label.set_text(Helpers::get_dotted_isk(cs->balance)
+        + " ISK");
 
     if (trunc_corpname->get_bool())
     {
-      this->corp_label.set_text(Helpers::trunc_string(cs->corp, 25));
-      this->corp_label.set_tooltip_text(cs->corp);
+      this->gui->corp_label.set_text(Helpers::trunc_string(cs->corp, 25));
+      this->gui->corp_label.set_tooltip_text(cs->corp);
     }
     else
-      this->corp_label.set_text(cs->corp);
+      this->gui->corp_label.set_text(cs->corp);
 
-    this->skill_points_label.set_text(Helpers::get_dotted_str_from_uint
+    this->gui->skill_points_label.set_text(Helpers::get_dotted_str_from_uint
         (cs->total_sp));
-    this->known_skills_label.set_text(Helpers::get_string_from_sizet
+    this->gui->known_skills_label.set_text(Helpers::get_string_from_sizet
         (cs->skills.size()) + " known skills ("
         + Helpers::get_string_from_uint(cs->skills_at[5])
         + " at V)");
         // "of " + Helpers::get_string_from_int(tree->count_total_skills()) + " total");
 
-    this->attr_cha_label.set_text(Helpers::get_string_from_double
+    this->gui->attr_cha_label.set_text(Helpers::get_string_from_double
         (cs->total.cha, 2));
-    this->attr_int_label.set_text(Helpers::get_string_from_double
+    this->gui->attr_int_label.set_text(Helpers::get_string_from_double
         (cs->total.intl, 2));
-    this->attr_per_label.set_text(Helpers::get_string_from_double
+    this->gui->attr_per_label.set_text(Helpers::get_string_from_double
         (cs->total.per, 2));
-    this->attr_mem_label.set_text(Helpers::get_string_from_double
+    this->gui->attr_mem_label.set_text(Helpers::get_string_from_double
         (cs->total.mem, 2));
-    this->attr_wil_label.set_text(Helpers::get_string_from_double
+    this->gui->attr_wil_label.set_text(Helpers::get_string_from_double
         (cs->total.wil, 2));
 
     /* Build list of known skills per level (tooltip). */
@@ -390,12 +445,12 @@ GtkCharPage::update_charsheet_details (void)
     attr_wil_tt += Helpers::get_string_from_double(cs->implant.wil, 2);
 
     /* Update some character sheet related skills. */
-    this->known_skills_label.set_tooltip_markup(skills_at_tt);
-    this->attr_cha_label.set_tooltip_markup(attr_cha_tt);
-    this->attr_int_label.set_tooltip_markup(attr_int_tt);
-    this->attr_per_label.set_tooltip_markup(attr_per_tt);
-    this->attr_mem_label.set_tooltip_markup(attr_mem_tt);
-    this->attr_wil_label.set_tooltip_markup(attr_wil_tt);
+    this->gui->known_skills_label.set_tooltip_markup(skills_at_tt);
+    this->gui->attr_cha_label.set_tooltip_markup(attr_cha_tt);
+    this->gui->attr_int_label.set_tooltip_markup(attr_int_tt);
+    this->gui->attr_per_label.set_tooltip_markup(attr_per_tt);
+    this->gui->attr_mem_label.set_tooltip_markup(attr_mem_tt);
+    this->gui->attr_wil_label.set_tooltip_markup(attr_wil_tt);
   }
 
   this->update_skill_list();
@@ -406,19 +461,34 @@ GtkCharPage::update_charsheet_details (void)
 void
 GtkCharPage::update_training_details (void)
 {
+    /* The text is kept for the notifications, even without the page. */
+    if (this->character->is_training())
+        this->training_text = this->character->get_training_text();
+    else if (this->character->valid_training_sheet())
+        this->training_text = "No skill in training!";
+    else
+        this->training_text = "---";
+
+    /* The completion check depends on the skill in training. */
+    this->update_live_timers();
+
+    /* The labels are filled in when the page is built. */
+    if (this->gui == 0)
+        return;
+
+    this->gui->training_label.set_text(this->training_text);
     if (this->character->is_training())
     {
         time_t end_time_t = this->character->training_info.end_time_t;
-        this->training_label.set_text(this->character->get_training_text());
 
         std::string downtime_str;
         if (EveTime::is_in_eve_downtime(end_time_t))
             downtime_str = " <i>(in DT!)</i>";
-        this->finish_eve_label.set_markup(EveTime::get_gm_time_string
+        this->gui->finish_eve_label.set_markup(EveTime::get_gm_time_string
             (end_time_t, false) + downtime_str);
-        this->finish_local_label.set_markup(EveTime::get_local_time_string
+        this->gui->finish_local_label.set_markup(EveTime::get_local_time_string
             (EveTime::adjust_local_time(end_time_t), false) + downtime_str);
-        this->spph_label.set_text(Helpers::get_string_from_uint
+        this->gui->spph_label.set_text(Helpers::get_string_from_uint
             (this->character->training_spph) + " SP per hour");
 
         /* Set SP/h tooltip. */
@@ -431,57 +501,44 @@ GtkCharPage::update_training_details (void)
                 << this->character->cs->get_spph_for_skill
                 (this->character->training_skill) << " SP/h";
         }
-        this->spph_label.set_has_tooltip(true);
-        this->spph_label.set_tooltip_markup(spph_tooltip.str());
+        this->gui->spph_label.set_has_tooltip(true);
+        this->gui->spph_label.set_tooltip_markup(spph_tooltip.str());
     }
     else if (this->character->valid_training_sheet())
     {
-        this->training_label.set_text("No skill in training!");
-        this->remaining_label.set_text("---");
-        this->finish_eve_label.set_text("---");
-        this->finish_local_label.set_text("---");
-        this->spph_label.set_text("0 SP per hour");
-        this->spph_label.set_has_tooltip(false);
-        this->live_sp_label.set_text("---");
+        this->gui->remaining_label.set_text("---");
+        this->gui->finish_eve_label.set_text("---");
+        this->gui->finish_local_label.set_text("---");
+        this->gui->spph_label.set_text("0 SP per hour");
+        this->gui->spph_label.set_has_tooltip(false);
+        this->gui->live_sp_label.set_text("---");
     }
     else
     {
-        this->training_label.set_text("---");
-        this->remaining_label.set_text("---");
-        this->finish_eve_label.set_text("---");
-        this->finish_local_label.set_text("---");
-        this->spph_label.set_text("---");
-        this->spph_label.set_has_tooltip(false);
-        this->live_sp_label.set_text("---");
+        this->gui->remaining_label.set_text("---");
+        this->gui->finish_eve_label.set_text("---");
+        this->gui->finish_local_label.set_text("---");
+        this->gui->spph_label.set_text("---");
+        this->gui->spph_label.set_has_tooltip(false);
+        this->gui->live_sp_label.set_text("---");
     }
 }
 
 /* ---------------------------------------------------------------- */
 
-/* Create a data structure that maps the group ID to the iterator of
- * the group, skill points for that group and the amount of skills.
- * This is needed for building the skill list. */
-struct SkillGroupInfo
-{
-  Gtk::TreeModel::iterator iter;
-  int sp;
-  bool empty;
-  int max;
-
-  SkillGroupInfo (Gtk::TreeModel::iterator iter)
-      : iter(iter), sp(0), empty(true) {}
-};
-typedef std::map<int, SkillGroupInfo> IterMapType;
-
-/* ---------------------------------------------------------------- */
-
 void
 GtkCharPage::update_skill_list (void)
 {
-  this->skill_store->clear();
+  if (this->gui == 0)
+    return;
 
   if (!this->character->cs->valid)
+  {
+    this->gui->skill_store->clear();
+    this->skill_rows.clear();
+    this->group_rows.clear();
     return;
+  }
 
   /* Load the skill tree. */
   ApiSkillTreePtr tree;
@@ -496,126 +553,221 @@ GtkCharPage::update_skill_list (void)
   }
 
   /* Cache skill in training. */
-  ApiSkill skill_training;
-  skill_training.id = -1;
-  skill_training.group = -1;
+  int training_id = -1;
+  int training_group = -1;
   if (this->character->is_training() && this->character->training_skill != 0)
-    skill_training = *this->character->training_skill;
-
-  /* Append all groups to the store. Save their iterators for the children.
-   * Format is <group_id, <model iter, group sp> >. */
-  IterMapType iter_map;
-  for (ApiSkillGroupMap::iterator iter = tree->groups.begin();
-      iter != tree->groups.end(); iter++)
   {
-    std::string name = iter->second.name;
-    if (skill_training.group == iter->first)
-      name += "  <i>(1 in training)</i>";
-
-    Gtk::TreeModel::iterator siter = this->skill_store->append();
-    (*siter)[this->skill_cols.id] = -1;
-    (*siter)[this->skill_cols.skill] = 0;
-    (*siter)[this->skill_cols.name] = name;
-    (*siter)[this->skill_cols.icon] = ImageStore::skillicons[0];
-    iter_map.insert(std::make_pair(iter->first, SkillGroupInfo(siter)));
+    training_id = this->character->training_skill->id;
+    training_group = this->character->training_skill->group;
   }
 
-  /* Compute max points per skill group. */
-  for (ApiSkillMap::iterator iter = tree->skills.begin();
-       iter != tree->skills.end(); iter++)
-  {
-    IterMapType::iterator iiter = iter_map.find(iter->second.group);
-    if (iiter != iter_map.end())
-    {
-      iiter->second.max += ApiCharSheet::calc_dest_sp(4, iter->second.rank);
-    }
-  }
+  /* Rows that are not seen anymore are removed afterwards. */
+  for (GtkCharSkillRowMap::iterator iter = this->skill_rows.begin();
+      iter != this->skill_rows.end(); iter++)
+    iter->second.seen = false;
 
-  /* Append all skills to the skill groups. */
+  /* Reconcile the skills with the rows in the store. */
   std::vector<ApiCharSheetSkill>& skills = this->character->cs->skills;
   for (unsigned int i = 0; i < skills.size(); ++i)
   {
     /* Get skill object. */
     ApiSkill const& skill = *skills[i].details;
+    ApiCharSheetSkill const& cskill = skills[i];
 
-    /* Lookup skill group. */
-    IterMapType::iterator iiter = iter_map.find(skill.group);
-    if (iiter == iter_map.end())
+    /* Lookup the row of the skill or append a new row. */
+    GtkCharSkillRowMap::iterator riter = this->skill_rows.find(skill.id);
+    if (riter == this->skill_rows.end())
     {
-      std::cout << "Error appending skill, unknown group!" << std::endl;
-      continue;
+      GtkCharGroupRow* group = this->get_group_row(tree, skill.group);
+      if (group == 0)
+      {
+        std::cout << "Error appending skill, unknown group!" << std::endl;
+        continue;
+      }
+
+      GtkCharSkillRow row;
+      row.iter = this->gui->skill_store->append(group->iter->children());
+      row.group = skill.group;
+      row.level = -1;
+      row.points = 0;
+      row.points_max = -1;
+      row.partial = false;
+      row.training = (skill.id != training_id);
+
+      (*row.iter)[this->gui->skill_cols.id] = skill.id;
+      (*row.iter)[this->gui->skill_cols.primary]
+          = ApiSkillTree::get_attrib_short_name(skill.primary);
+      (*row.iter)[this->gui->skill_cols.secondary]
+          = ApiSkillTree::get_attrib_short_name(skill.secondary);
+
+      group->skills += 1;
+      riter = this->skill_rows.insert(std::make_pair(skill.id, row)).first;
+    }
+
+    GtkCharSkillRow& row = riter->second;
+    row.seen = true;
+
+    /* Update the name and icon if the state changed. The row of the skill
+     * in training also shows live values, these are reset on changes. */
+    bool training = (skill.id == training_id);
+    bool training_changed = (row.training != training);
+    bool partial = (cskill.points != cskill.points_start);
+    if (training_changed || row.partial != partial
+        || row.level != cskill.level)
+    {
+      std::string skill_name = skill.name + " ("
+          + Helpers::get_string_from_int(skill.rank) + ")";
+
+      if (training)
+      {
+        skill_name += "  <i>(in training)</i>";
+        (*row.iter)[this->gui->skill_cols.icon] = ImageStore::skillicons[2];
+      }
+      else if (partial)
+        (*row.iter)[this->gui->skill_cols.icon] = ImageStore::skillicons[4];
+      else if (cskill.level < 5)
+        (*row.iter)[this->gui->skill_cols.icon] = ImageStore::skillicons[1];
+      else
+        (*row.iter)[this->gui->skill_cols.icon] = ImageStore::skillicons[3];
+
+      if (training_changed)
+        (*row.iter)[this->gui->skill_cols.name] = skill_name;
+
+      row.training = training;
+      row.partial = partial;
+      row.level = cskill.level;
     }
 
-    /* Append a new row. */
-    Gtk::TreeModel::iterator iter = this->skill_store->append
-        (iiter->second.iter->children());
+    /* Update the points and the group SP. */
+    if (row.points != cskill.points || training_changed)
+    {
+      GtkCharGroupRow& group = this->group_rows[row.group];
+      group.sp += cskill.points - row.points;
+      group.sp_changed = true;
 
-    /* Get skill name and set icon. */
-    std::string skill_name = skill.name + " ("
-        + Helpers::get_string_from_int(skill.rank) + ")";
+      row.points = cskill.points;
+      (*row.iter)[this->gui->skill_cols.points]
+          = Helpers::get_dotted_str_from_int(cskill.points);
+    }
 
-    if (skill.id == skill_training.id)
+    if (row.points_max != cskill.points_max)
     {
-      skill_name += "  <i>(in training)</i>";
-      (*iter)[this->skill_cols.icon] = ImageStore::skillicons[2];
+      row.points_max = cskill.points_max;
+      (*row.iter)[this->gui->skill_cols.max_points]
+          = Helpers::get_dotted_str_from_int(cskill.points_max);
+    }
 
-      /* Update of the SkillInTrainingInfo. */
-      this->tree_skill_iter = iter;
+    /* The progress images are shared, compare them directly. */
+    Glib::RefPtr<Gdk::Pixbuf> level_icon = ImageStore::skill_progress
+        (cskill.level, cskill.completed);
+    if (row.level_icon != level_icon || training_changed)
+    {
+      row.level_icon = level_icon;
+      (*row.iter)[this->gui->skill_cols.level] = level_icon;
     }
-    else
+
+    /* Update of the SkillInTrainingInfo. */
+    if (training)
+      this->tree_skill_iter = row.iter;
+  }
+
+  /* Remove rows of skills the character does not know anymore. */
+  for (GtkCharSkillRowMap::iterator iter = this->skill_rows.begin();
+      iter != this->skill_rows.end();)
+  {
+    if (iter->second.seen)
     {
-      if (skills[i].points != skills[i].points_start)
-        (*iter)[this->skill_cols.icon] = ImageStore::skillicons[4];
-      else if (skills[i].level < 5)
-        (*iter)[this->skill_cols.icon] = ImageStore::skillicons[1];
-      else
-        (*iter)[this->skill_cols.icon] = ImageStore::skillicons[3];
+      iter++;
+      continue;
     }
 
-    /* Set skill id, points and name. */
-    (*iter)[this->skill_cols.id] = skill.id;
-    (*iter)[this->skill_cols.skill] = &skills[i];
-    (*iter)[this->skill_cols.points]
-        = Helpers::get_dotted_str_from_int(skills[i].points);
-    (*iter)[this->skill_cols.max_points]
-        = Helpers::get_dotted_str_from_int(skills[i].points_max);
-
-    (*iter)[this->skill_cols.name] = skill_name;
-    (*iter)[this->skill_cols.level] = ImageStore::skill_progress
-        (skills[i].level, skills[i].completed);
-    (*iter)[this->skill_cols.primary] = ApiSkillTree::get_attrib_short_name(skills[i].details->primary);
-    (*iter)[this->skill_cols.secondary] = ApiSkillTree::get_attrib_short_name(skills[i].details->secondary);
-
-    /* Update group info. */
-    iiter->second.sp += skills[i].points;
-    iiter->second.empty = false;
+    GtkCharGroupRow& group = this->group_rows[iter->second.group];
+    group.sp -= iter->second.points;
+    group.sp_changed = true;
+    group.skills -= 1;
+
+    this->gui->skill_store->erase(iter->second.iter);
+    this->skill_rows.erase(iter++);
   }
 
-  /* Update the skillpoints for the groups. */
-  for (IterMapType::iterator iter = iter_map.begin();
-      iter != iter_map.end(); iter++)
+  /* Update the groups, remove groups with no skills. */
+  for (GtkCharGroupRowMap::iterator iter = this->group_rows.begin();
+      iter != this->group_rows.end();)
   {
-    /* Remove group with no skills. */
-    if (iter->second.empty)
+    GtkCharGroupRow& group = iter->second;
+    if (group.skills == 0)
     {
-      this->skill_store->erase(iter->second.iter);
+      this->gui->skill_store->erase(group.iter);
+      this->group_rows.erase(iter++);
       continue;
     }
 
-    (*iter->second.iter)[this->skill_cols.points]
-        = Helpers::get_dotted_str_from_int(iter->second.sp);
+    bool training = (iter->first == training_group);
+    if (group.training != training)
+    {
+      group.sp_changed = true;
+      ApiSkillGroup const* tree_group = tree->get_group_for_id(iter->first);
+      std::string name = (tree_group != 0 ? tree_group->name : "");
+      if (training)
+        name += "  <i>(1 in training)</i>";
+      (*group.iter)[this->gui->skill_cols.name] = name;
+      group.training = training;
+    }
 
-    (*iter->second.iter)[this->skill_cols.max_points]
-        = Helpers::get_dotted_str_from_int(iter->second.max);
+    if (group.sp_changed)
+    {
+      (*group.iter)[this->gui->skill_cols.points]
+          = Helpers::get_dotted_str_from_int(group.sp);
+      group.sp_changed = false;
+    }
 
     /* Update of the SkillInTrainingInfo. */
-    if (iter->first == skill_training.group)
-      this->tree_group_iter = iter->second.iter;
+    if (training)
+      this->tree_group_iter = group.iter;
+
+    iter++;
   }
 }
 
 /* ---------------------------------------------------------------- */
 
+GtkCharGroupRow*
+GtkCharPage::get_group_row (ApiSkillTreePtr tree, int group_id)
+{
+  GtkCharGroupRowMap::iterator iter = this->group_rows.find(group_id);
+  if (iter != this->group_rows.end())
+    return &iter->second;
+
+  ApiSkillGroup const* tree_group = tree->get_group_for_id(group_id);
+  if (tree_group == 0)
+    return 0;
+
+  /* Compute max points for the skill group. */
+  int max_sp = 0;
+  for (ApiSkillMap::iterator iter = tree->skills.begin();
+       iter != tree->skills.end(); iter++)
+    if (iter->second.group == group_id)
+      max_sp += ApiCharSheet::calc_dest_sp(4, iter->second.rank);
+
+  GtkCharGroupRow group;
+  group.iter = this->gui->skill_store->append();
+  group.sp = 0;
+  group.skills = 0;
+  group.sp_changed = true;
+  group.training = false;
+
+  (*group.iter)[this->gui->skill_cols.id] = -1;
+  (*group.iter)[this->gui->skill_cols.name] = tree_group->name;
+  (*group.iter)[this->gui->skill_cols.icon] = ImageStore::skillicons[0];
+  (*group.iter)[this->gui->skill_cols.max_points]
+      = Helpers::get_dotted_str_from_int(max_sp);
+
+  iter = this->group_rows.insert(std::make_pair(group_id, group)).first;
+  return &iter->second;
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 GtkCharPage::request_documents (void)
 {
@@ -674,44 +826,68 @@ GtkCharPage::request_documents (void)
   /* Request the documents. */
   if (update_char)
   {
-    this->charsheet_info_label.set_text("Requesting...");
+    if (this->gui != 0)
+      this->gui->charsheet_info_label.set_text("Requesting...");
     this->character->request_charsheet();
   }
 
   if (update_training)
   {
-    this->skillqueue_info_label.set_text("Requesting...");
+    if (this->gui != 0)
+      this->gui->skillqueue_info_label.set_text("Requesting...");
     this->character->request_skillqueue();
   }
 }
 
 /* ---------------------------------------------------------------- */
 
-bool
+void
 GtkCharPage::check_expired_sheets (void)
 {
+  this->expiry_event = 0;
+
   /* Check if automatic update is enabled. */
   ConfValuePtr value = Config::conf.get_value("settings.auto_update_sheets");
-  if (!value->get_bool())
-    return true;
+  if (value->get_bool())
+  {
+    ApiCharSheetPtr cs = this->character->cs;
+    ApiSkillQueuePtr sq = this->character->sq;
+
+    /* Check which docs to re-request. */
+    time_t evetime = EveTime::get_eve_time();
+    if (!sq->valid || evetime >= sq->get_cached_until_t()
+        || !cs->valid || evetime >= cs->get_cached_until_t())
+      this->request_documents();
+  }
+
+  this->schedule_expiry_check();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::schedule_expiry_check (void)
+{
+  EventScheduler::remove(this->expiry_event);
+  this->expiry_event = 0;
 
   ApiCharSheetPtr cs = this->character->cs;
   ApiSkillQueuePtr sq = this->character->sq;
 
   /* Skip automatic update if both sheets are cached. */
   if (sq->is_locally_cached() && cs->is_locally_cached())
-    return true;
-
-  //std::cout << "Checking for expired sheets..." << std::endl;
+    return;
 
+  /* Wake up when the first sheet expires. If a sheet is invalid or
+   * already expired, the update is pending or failed and is retried. */
   time_t evetime = EveTime::get_eve_time();
+  time_t deadline = evetime + CHARPAGE_CHECK_EXPIRED_SHEETS;
+  if (sq->valid && cs->valid && evetime < sq->get_cached_until_t()
+      && evetime < cs->get_cached_until_t())
+    deadline = std::min(sq->get_cached_until_t(), cs->get_cached_until_t());
 
-  /* Check which docs to re-request. */
-  if (!sq->valid || evetime >= sq->get_cached_until_t()
-      || !cs->valid || evetime >= cs->get_cached_until_t())
-    this->request_documents();
-
-  return true;
+  this->expiry_event = EventScheduler::add(EveTime::adjust_eve_time(deadline),
+      sigc::mem_fun(*this, &GtkCharPage::check_expired_sheets));
 }
 
 /* ---------------------------------------------------------------- */
@@ -722,43 +898,62 @@ GtkCharPage::api_info_changed (void)
   /* Detect some API issues. */
   if (this->character->is_training() && this->character->training_skill == 0)
   {
-    this->info_display.append(INFO_ERROR, "Skill in training is unknown!",
+    this->append_info(InfoItem(INFO_ERROR, "Skill in training is unknown!",
         "The EVE API reported a skill in training that is unknown to "
         "GtkEveMon. This typically happens if the data files are not "
         "up-to-date. If you already have recent data files, "
         "please report this issue! Thanks.\n\n"
         "Error: Skill with ID " + Helpers::get_string_from_int
-        (this->character->training_info.skill_id) + " did not resolve!");
+        (this->character->training_info.skill_id) + " did not resolve!"));
   }
 
   /* Update the char sheet and training sheet info. */
+  this->schedule_expiry_check();
   this->update_cached_duration();
   this->update_charsheet_details();
   this->update_training_details();
+
+  /* The skill list rows exist once the page is built. */
+  if (this->gui == 0)
+    return;
   this->on_live_sp_value_update();
   this->on_live_sp_image_update();
 }
 
 /* ---------------------------------------------------------------- */
 
-bool
+void
 GtkCharPage::update_cached_duration (void)
 {
+  EventScheduler::remove(this->duration_event);
+  this->duration_event = 0;
+
+  /* The labels are filled in when the page is mapped. */
+  if (this->gui == 0)
+    return;
+
   time_t current = EveTime::get_eve_time();
   ApiCharSheetPtr cs = this->character->cs;
   ApiSkillQueuePtr sq = this->character->sq;
 
+  /* The seconds until one of the labels changes, or zero. */
+  time_t next_change = 0;
+
   if (sq->valid)
   {
     time_t cached_until = sq->get_cached_until_t();
 
     if (sq->is_locally_cached())
-      this->skillqueue_info_label.set_text("Locally cached!");
+      this->gui->skillqueue_info_label.set_text("Locally cached!");
     else if (cached_until > current)
-      this->skillqueue_info_label.set_text(EveTime::get_minute_str_for_diff
+    {
+      this->gui->skillqueue_info_label.set_text(EveTime::get_minute_str_for_diff
           (cached_until - current) + " cached");
+      next_change = GtkCharPage::get_next_minute_change
+          (cached_until - current, next_change);
+    }
     else
-      this->skillqueue_info_label.set_text("Ready for update!");
+      this->gui->skillqueue_info_label.set_text("Ready for update!");
   }
 
   if (cs->valid)
@@ -766,15 +961,22 @@ GtkCharPage::update_cached_duration (void)
     time_t cached_until = cs->get_cached_until_t();
 
     if (cs->is_locally_cached())
-      this->charsheet_info_label.set_text("Locally cached!");
+      this->gui->charsheet_info_label.set_text("Locally cached!");
     else if (cached_until > current)
-      this->charsheet_info_label.set_text(EveTime::get_minute_str_for_diff
+    {
+      this->gui->charsheet_info_label.set_text(EveTime::get_minute_str_for_diff
           (cached_until - current) + " cached");
+      next_change = GtkCharPage::get_next_minute_change
+          (cached_until - current, next_change);
+    }
     else
-      this->charsheet_info_label.set_text("Ready for update!");
+      this->gui->charsheet_info_label.set_text("Ready for update!");
   }
 
-  return true;
+  /* The labels only need to tick while they are visible. */
+  if (next_change > 0 && this->page_mapped && this->window_visible)
+    this->duration_event = EventScheduler::add_after(next_change,
+        sigc::mem_fun(*this, &GtkCharPage::update_cached_duration));
 }
 
 /* ---------------------------------------------------------------- */
@@ -787,7 +989,7 @@ GtkCharPage::create_tray_notify (void)
      (*this, &GtkCharPage::remove_tray_notify));
   //this->tray_notify->set_blinking(true);
   this->tray_notify->set_tooltip_text(this->character->get_char_name() + " has "
-      "completed " + this->training_label.get_text() + "!");
+      "completed " + this->training_text + "!");
 }
 
 /* ---------------------------------------------------------------- */
@@ -814,6 +1016,18 @@ GtkCharPage::popup_error_dialog (std::string const& title,
 
 /* ---------------------------------------------------------------- */
 
+void
+GtkCharPage::append_info (InfoItem const& item)
+{
+  /* Messages are kept until the page is built. */
+  if (this->gui == 0)
+    this->info_log.push_back(item);
+  else
+    this->gui->info_display.append(item);
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 GtkCharPage::exec_notification_handler (void)
 {
@@ -851,12 +1065,15 @@ void
 GtkCharPage::on_skill_completed (void)
 {
   /* Set up some GUI elements. */
-  this->remaining_label.set_text("Completed!");
-  this->finish_eve_label.set_text("---");
-  this->finish_local_label.set_text("---");
-  this->spph_label.set_text("0 SP per hour");
-  this->spph_label.set_has_tooltip(false);
-  this->live_sp_label.set_text("---");
+  if (this->gui != 0)
+  {
+    this->gui->remaining_label.set_text("Completed!");
+    this->gui->finish_eve_label.set_text("---");
+    this->gui->finish_local_label.set_text("---");
+    this->gui->spph_label.set_text("0 SP per hour");
+    this->gui->spph_label.set_has_tooltip(false);
+    this->gui->live_sp_label.set_text("---");
+  }
 
   /* Update GUI to reflect changes. */
   this->update_charsheet_details();
@@ -875,8 +1092,8 @@ GtkCharPage::on_skill_completed (void)
     this->create_tray_notify();
 
   if (show_info->get_bool())
-    this->info_display.append(INFO_NOTIFICATION, "Skill training for <b>"
-        + this->training_label.get_text() + "</b> completed!");
+    this->append_info(InfoItem(INFO_NOTIFICATION, "Skill training for <b>"
+        + this->training_text + "</b> completed!"));
 
   if (exec_handler->get_bool())
     this->exec_notification_handler();
@@ -889,7 +1106,7 @@ GtkCharPage::on_skill_completed (void)
     md->set_secondary_text("Congratulations. <b>"
         + this->character->get_char_name()
         + "</b> has just completed the skill training for <b>"
-        + this->training_label.get_text() + "</b>.", true);
+        + this->training_text + "</b>.", true);
     md->set_title("Skill training completed!");
     md->set_transient_for(*this->parent_window);
     md->show_all();
@@ -926,18 +1143,21 @@ GtkCharPage::on_query_skillview_tooltip (int x, int y, bool /*key*/,
 {
   Gtk::TreeModel::Path path;
   Gtk::TreeViewDropPosition pos;
-  bool exists = this->skill_view.get_dest_row_at_pos(x, y, path, pos);
+  bool exists = this->gui->skill_view.get_dest_row_at_pos(x, y, path, pos);
   if (!exists)
     return false;
 
-  Gtk::TreeIter iter = this->skill_store->get_iter(path);
-  int skill_id = (*iter)[this->skill_cols.id];
-  ApiCharSheetSkill* cskill = (*iter)[this->skill_cols.skill];
+  Gtk::TreeIter iter = this->gui->skill_store->get_iter(path);
+  int skill_id = (*iter)[this->gui->skill_cols.id];
+  if (skill_id < 0)
+    return false;
 
-  if (skill_id < 0 || cskill == 0)
+  ApiCharSheetSkill* cskill = this->character->cs->get_skill_for_id(skill_id);
+  if (cskill == 0)
     return false;
 
-  this->skill_view.set_tooltip_row(tooltip, path);  /* Reposition tooltip. */
+  /* Reposition tooltip. */
+  this->gui->skill_view.set_tooltip_row(tooltip, path);
   GtkHelpers::create_tooltip(tooltip, cskill->details, cskill, this->character);
   return true;
 }
@@ -948,8 +1168,8 @@ void
 GtkCharPage::on_skill_activated (Gtk::TreeModel::Path const& path,
     Gtk::TreeViewColumn* /*col*/)
 {
-  Gtk::TreeIter iter = this->skill_store->get_iter(path);
-  int skill_id = (*iter)[this->skill_cols.id];
+  Gtk::TreeIter iter = this->gui->skill_store->get_iter(path);
+  int skill_id = (*iter)[this->gui->skill_cols.id];
 
   if (skill_id >= 0)
   {
@@ -960,10 +1180,10 @@ GtkCharPage::on_skill_activated (Gtk::TreeModel::Path const& path,
   else
   {
     /* It's probably a skill group. Expand/collapse. */
-    if (this->skill_view.row_expanded(path))
-      this->skill_view.collapse_row(path);
+    if (this->gui->skill_view.row_expanded(path))
+      this->gui->skill_view.collapse_row(path);
     else
-      this->skill_view.expand_row(path, true);
+      this->gui->skill_view.expand_row(path, true);
   }
 }
 
@@ -972,16 +1192,20 @@ GtkCharPage::on_skill_activated (Gtk::TreeModel::Path const& path,
 bool
 GtkCharPage::on_live_sp_value_update (void)
 {
-  /* Update the live values. This may trigger skill completed. */
+  /* Update the live values. The completion is left to the scheduled
+   * check, the values of a completed skill are not updated anymore. */
+  if (this->character->training_info.queue_pos >= 0
+      && EveTime::get_eve_time() > this->character->training_info.end_time_t)
+    return true;
   this->character->update_live_info();
 
-  /* Check if the character is training. */
-  if (!this->character->is_training())
+  /* Check if the character is training and the page is built. */
+  if (this->gui == 0 || !this->character->is_training())
     return true;
 
   /* A skill is in training. Fill some values. */
-  this->remaining_label.set_text(this->character->get_remaining_text());
-  this->live_sp_label.set_text(Helpers::get_dotted_str_from_uint
+  this->gui->remaining_label.set_text(this->character->get_remaining_text());
+  this->gui->live_sp_label.set_text(Helpers::get_dotted_str_from_uint
       (this->character->training_level_sp) + " SP ("
       + Helpers::get_string_from_double
       (this->character->training_level_done * 100.0, 2) + "%)");
@@ -991,16 +1215,16 @@ GtkCharPage::on_live_sp_value_update (void)
     return true;
 
   /* Character sheet is also valid. Fill some more values. */
-  this->skill_points_label.set_text(Helpers::get_dotted_str_from_uint
+  this->gui->skill_points_label.set_text(Helpers::get_dotted_str_from_uint
       (this->character->char_live_sp));
 
   /* Don't update character list if skill in training is unknown to char. */
   if (this->character->training_cskill == 0)
     return true;
 
-  (*this->tree_skill_iter)[this->skill_cols.points] =
+  (*this->tree_skill_iter)[this->gui->skill_cols.points] =
       Helpers::get_dotted_str_from_uint(this->character->training_skill_sp);
-  (*this->tree_group_iter)[this->skill_cols.points] =
+  (*this->tree_group_iter)[this->gui->skill_cols.points] =
       Helpers::get_dotted_str_from_uint(this->character->char_group_live_sp);
 
   return true;
@@ -1011,23 +1235,137 @@ GtkCharPage::on_live_sp_value_update (void)
 bool
 GtkCharPage::on_live_sp_image_update (void)
 {
-  if (!this->character->cs->valid || !this->character->is_training())
+  if (this->gui == 0 || !this->character->cs->valid
+      || !this->character->is_training())
     return true;
 
   /* Don't update graphics if skill in training is unknown to char. */
   if (this->character->training_cskill == 0)
     return true;
 
+  /* The images are shared, only update the row if the image changed. */
   Glib::RefPtr<Gdk::Pixbuf> new_icon = ImageStore::skill_progress
       (this->character->training_cskill->level,
       this->character->training_level_done);
-  (*this->tree_skill_iter)[this->skill_cols.level] = new_icon;
+  Glib::RefPtr<Gdk::Pixbuf> old_icon
+      = (*this->tree_skill_iter)[this->gui->skill_cols.level];
+  if (old_icon != new_icon)
+    (*this->tree_skill_iter)[this->gui->skill_cols.level] = new_icon;
 
   return true;
 }
 
 /* ---------------------------------------------------------------- */
 
+void
+GtkCharPage::update_live_timers (void)
+{
+  /* The completion is a scheduled event, whether visible or not. */
+  this->schedule_completion_check();
+
+  if (this->page_mapped && this->window_visible)
+  {
+    if (this->live_sp_value_conn.connected())
+      return;
+
+    this->live_sp_value_conn = Glib::signal_timeout().connect(sigc::mem_fun
+        (*this, &GtkCharPage::on_live_sp_value_update),
+        CHARPAGE_LIVE_SP_LABEL_UPDATE);
+    this->live_sp_image_conn = Glib::signal_timeout().connect(sigc::mem_fun
+        (*this, &GtkCharPage::on_live_sp_image_update),
+        CHARPAGE_LIVE_SP_IMAGE_UPDATE);
+
+    /* Catch up with the live values in one step. */
+    this->on_live_sp_value_update();
+    this->on_live_sp_image_update();
+    this->update_cached_duration();
+    return;
+  }
+
+  this->live_sp_value_conn.disconnect();
+  this->live_sp_image_conn.disconnect();
+  EventScheduler::remove(this->duration_event);
+  this->duration_event = 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::schedule_completion_check (void)
+{
+  EventScheduler::remove(this->completion_event);
+  this->completion_event = 0;
+
+  if (!this->character->is_training())
+    return;
+
+  /* Wake up once when the skill in training completes. */
+  time_t deadline = EveTime::adjust_eve_time
+      (this->character->training_info.end_time_t);
+  this->completion_event = EventScheduler::add(deadline + 1,
+      sigc::mem_fun(*this, &GtkCharPage::on_completion_check));
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::on_completion_check (void)
+{
+  /* Updating may trigger skill completed, which schedules the next
+   * check. Otherwise the clocks differ and the check is repeated. */
+  this->completion_event = 0;
+  this->character->update_live_info();
+  if (this->completion_event == 0)
+    this->schedule_completion_check();
+}
+
+/* ---------------------------------------------------------------- */
+
+time_t
+GtkCharPage::get_next_minute_change (time_t diff, time_t next_change)
+{
+  /* The minutes are rounded up, see EveTime::get_minute_str_for_diff. */
+  time_t change = diff - ((diff + 59) / 60 - 1) * 60;
+  if (next_change == 0 || change < next_change)
+    return change;
+  return next_change;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::on_map (void)
+{
+  this->build_page();
+  this->Gtk::Box::on_map();
+  this->page_mapped = true;
+  this->update_live_timers();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::on_unmap (void)
+{
+  this->Gtk::Box::on_unmap();
+  this->page_mapped = false;
+  this->update_live_timers();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCharPage::set_window_visible (bool visible)
+{
+  if (this->window_visible == visible)
+    return;
+
+  this->window_visible = visible;
+  this->update_live_timers();
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 GtkCharPage::on_api_error (EveApiDocType dt, std::string msg, bool cached)
 {
@@ -1036,11 +1374,13 @@ GtkCharPage::on_api_error (EveApiDocType dt, std::string msg, bool cached)
   {
     case API_DOCTYPE_CHARSHEET:
       doc = "CharacterSheet.xml";
-      this->charsheet_info_label.set_text("Error requesting!");
+      if (this->gui != 0)
+        this->gui->charsheet_info_label.set_text("Error requesting!");
       break;
     case API_DOCTYPE_SKILLQUEUE:
       doc = "SkillQueue.xml";
-      this->skillqueue_info_label.set_text("Error requesting!");
+      if (this->gui != 0)
+        this->gui->skillqueue_info_label.set_text("Error requesting!");
       break;
     default:
       std::cout << "Warning: Received API error for unknown DT!" << std::endl;
@@ -1062,11 +1402,11 @@ GtkCharPage::on_api_error (EveApiDocType dt, std::string msg, bool cached)
     heading = "Error requesting " + doc + "!";
   }
 
-  this->info_display.append(info_type, heading,
+  this->append_info(InfoItem(info_type, heading,
       "There was an error while requesting " + doc + " from the EVE API. "
       "The EVE API is either offline, a network error occurred, or the "
       "requested document is not understood by GtkEveMon. "
-      "The error message is:\n\n" + msg);
+      "The error message is:\n\n" + msg));
 }
 
 /* ---------------------------------------------------------------- */
@@ -1076,12 +1416,12 @@ GtkCharPage::on_skilltree_error (std::string const& e)
 {
   std::cout << "Error requesting skill tree: " << e << std::endl;
 
-  this->info_display.append(INFO_ERROR,
+  this->append_info(InfoItem(INFO_ERROR,
       "Error requesting skill tree!",
       "There was an error while parsing the skill tree. "
       "Reasons might be: The file was not found, the file "
       "is currupted, the file uses a new syntax unknown "
-      "to GtkEveMon. The error message is:\n\n" + e);
+      "to GtkEveMon. The error message is:\n\n" + e));
 }
 
 /* ---------------------------------------------------------------- */
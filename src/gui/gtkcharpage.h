@@ -12,6 +12,8 @@
 #define GTK_CHAR_PAGE_HEADER
 
 #include <string>
+#include <vector>
+#include <map>
 
 #include <gdkmm.h>
 #include <gtkmm.h>
@@ -25,10 +27,9 @@
 #define CHARPAGE_LIVE_SP_LABEL_UPDATE 1000
 /* Update the live SP image every this milli seconds. */
 #define CHARPAGE_LIVE_SP_IMAGE_UPDATE 60000
-/* Check for expired sheets every this milli seconds. */
-#define CHARPAGE_CHECK_EXPIRED_SHEETS 600000
-/* Update the cached duration this milli seconds. */
-#define CHARPAGE_UPDATE_CACHED_DURATION 25000
+/* Check again for expired sheets after this seconds if the sheets
+ * are not valid or the update did not succeed. */
+#define CHARPAGE_CHECK_EXPIRED_SHEETS 600
 
 class GtkCharSkillsCols : public Gtk::TreeModel::ColumnRecord
 {
@@ -36,7 +37,6 @@ class GtkCharSkillsCols : public Gtk::TreeModel::ColumnRecord
     GtkCharSkillsCols (void);
 
     Gtk::TreeModelColumn<int> id;
-    Gtk::TreeModelColumn<ApiCharSheetSkill*> skill;
     Gtk::TreeModelColumn<Glib::ustring> name;
     Gtk::TreeModelColumn<Glib::ustring> points;
     Gtk::TreeModelColumn<Glib::ustring> max_points;
@@ -48,56 +48,119 @@ class GtkCharSkillsCols : public Gtk::TreeModel::ColumnRecord
 
 /* ---------------------------------------------------------------- */
 
+/* State of the rows in the skill list. Rows are only written if
+ * the values shown for the skill or the group changed. */
+struct GtkCharSkillRow
+{
+  Gtk::TreeModel::iterator iter;
+  int group;
+  int level;
+  int points;
+  int points_max;
+  bool partial;
+  bool training;
+  bool seen;
+  Glib::RefPtr<Gdk::Pixbuf> level_icon;
+};
+
+struct GtkCharGroupRow
+{
+  Gtk::TreeModel::iterator iter;
+  int sp;
+  int skills;
+  bool sp_changed;
+  bool training;
+};
+
+typedef std::map<int, GtkCharSkillRow> GtkCharSkillRowMap;
+typedef std::map<int, GtkCharGroupRow> GtkCharGroupRowMap;
+
+/* ---------------------------------------------------------------- */
+
+/* The widgets of a character page, see GtkCharPage::build_page(). */
+struct GtkCharPageWidgets
+{
+  Gtk::Label char_name_label;
+  Gtk::Label char_info_label;
+  Gtk::Label corp_label;
+  Gtk::Label balance_label;
+  Gtk::Label skill_points_label;
+  Gtk::Label known_skills_label;
+  Gtk::Label attr_cha_label;
+  Gtk::Label attr_int_label;
+  Gtk::Label attr_per_label;
+  Gtk::Label attr_mem_label;
+  Gtk::Label attr_wil_label;
+  Gtk::Label training_label;
+  Gtk::Label remaining_label;
+  Gtk::Label finish_eve_label;
+  Gtk::Label finish_local_label;
+  Gtk::Label spph_label;
+  Gtk::Label live_sp_label;
+  Gtk::Label charsheet_info_label;
+  Gtk::Label skillqueue_info_label;
+  Gtk::Button refresh_but;
+  Gtk::Button info_but;
+  GtkPortrait char_image;
+  GtkInfoDisplay info_display;
+
+  GtkCharSkillsCols skill_cols;
+  Glib::RefPtr<Gtk::TreeStore> skill_store;
+  Gtk::TreeView skill_view;
+
+  GtkCharPageWidgets (void);
+};
+
+/* ---------------------------------------------------------------- */
+
 class GtkCharPage : public Gtk::Box
 {
   private:
     /* Character to be monitored. */
     CharacterPtr character;
 
-    /* GUI stuff. */
+    /* GUI stuff. The widgets are built when the page is mapped the
+     * first time, until then only the tray and notification state is
+     * kept. Messages appended before are shown once the page is built. */
     Gtk::Window* parent_window;
-    Gtk::Label char_name_label;
-    Gtk::Label char_info_label;
-    Gtk::Label corp_label;
-    Gtk::Label balance_label;
-    Gtk::Label skill_points_label;
-    Gtk::Label known_skills_label;
-    Gtk::Label attr_cha_label;
-    Gtk::Label attr_int_label;
-    Gtk::Label attr_per_label;
-    Gtk::Label attr_mem_label;
-    Gtk::Label attr_wil_label;
-    Gtk::Label training_label;
-    Gtk::Label remaining_label;
-    Gtk::Label finish_eve_label;
-    Gtk::Label finish_local_label;
-    Gtk::Label spph_label;
-    Gtk::Label live_sp_label;
-    Gtk::Label charsheet_info_label;
-    Gtk::Label skillqueue_info_label;
-    Gtk::Button refresh_but;
-    Gtk::Button info_but;
-    GtkPortrait char_image;
-    GtkInfoDisplay info_display;
-
-    GtkCharSkillsCols skill_cols;
-    Glib::RefPtr<Gtk::TreeStore> skill_store;
-    Gtk::TreeView skill_view;
+    GtkCharPageWidgets* gui;
+    std::vector<InfoItem> info_log;
+    std::string training_text;
     Glib::RefPtr<Gtk::StatusIcon> tray_notify;
 
     /* Cached tree iterators for fast skill and group update. */
     Gtk::TreeIter tree_skill_iter;
     Gtk::TreeIter tree_group_iter;
 
+    /* Rows in the skill list by skill and group ID. */
+    GtkCharSkillRowMap skill_rows;
+    GtkCharGroupRowMap group_rows;
+
+    /* The live values are only updated while the page is visible.
+     * A scheduled event checks for the skill completion, whether the page
+     * is visible or not. Sheet expiry and cached durations are scheduled
+     * events, too. */
+    sigc::connection live_sp_value_conn;
+    sigc::connection live_sp_image_conn;
+    unsigned int completion_event;
+    unsigned int expiry_event;
+    unsigned int duration_event;
+    bool page_mapped;
+    bool window_visible;
+
     /* Helpers, signal handlers, etc. */
+    void build_page (void);
     void update_charsheet_details (void);
     void update_training_details (void);
     void update_skill_list (void);
+    GtkCharGroupRow* get_group_row (ApiSkillTreePtr tree, int group_id);
     void delete_skill_completed_dialog (int response, Gtk::Widget* widget);
+    void append_info (InfoItem const& item);
 
     /* Request and process EVE API documents. */
     void request_documents (void);
-    bool check_expired_sheets (void);
+    void check_expired_sheets (void);
+    void schedule_expiry_check (void);
 
     /* Error dialogs. */
     void on_skilltree_error (std::string const& e);
@@ -107,7 +170,8 @@ class GtkCharPage : public Gtk::Box
 
     /* Misc GUI stuff. */
     bool update_remaining (void);
-    bool update_cached_duration (void);
+    void update_cached_duration (void);
+    static time_t get_next_minute_change (time_t diff, time_t next_change);
     void api_info_changed (void);
     void remove_tray_notify (void);
     void create_tray_notify (void);
@@ -123,12 +187,22 @@ class GtkCharPage : public Gtk::Box
 
     bool on_live_sp_value_update (void);
     bool on_live_sp_image_update (void);
+    void update_live_timers (void);
+    void schedule_completion_check (void);
+    void on_completion_check (void);
+
+  protected:
+    void on_map (void);
+    void on_unmap (void);
 
   public:
     GtkCharPage (CharacterPtr character);
+    ~GtkCharPage (void);
 
     CharacterPtr get_character (void) const;
     void set_parent_window (Gtk::Window* parent);
+    /* Suspends the live updates while the main window is hidden. */
+    void set_window_visible (bool visible);
 };
 
 /* ---------------------------------------------------------------- */
@@ -137,7 +211,6 @@ inline
 GtkCharSkillsCols::GtkCharSkillsCols (void)
 {
   this->add(this->id);
-  this->add(this->skill);
   this->add(this->name);
   this->add(this->points);
   this->add(this->max_points);
@@ -147,6 +220,12 @@ GtkCharSkillsCols::GtkCharSkillsCols (void)
   this->add(this->secondary);
 }
 
+inline
+GtkCharPageWidgets::GtkCharPageWidgets (void)
+  : info_display(INFO_STYLE_TOP_HSEP)
+{
+}
+
 inline void
 GtkCharPage::set_parent_window (Gtk::Window* parent)
 {
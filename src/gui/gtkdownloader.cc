@@ -8,6 +8,7 @@
 // You should have received a copy of the GNU General Public License
 // along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <gtkmm.h>
 
 #include "util/helpers.h"
@@ -72,6 +73,10 @@ GtkDownloader::start_next_download (void)
   this->asynchttp->set_host(dli.host);
   this->asynchttp->set_path(dli.path);
   Config::setup_http(this->asynchttp, dli.is_api_call);
+  for (std::size_t i = 0; i < dli.headers.size(); ++i)
+    this->asynchttp->add_header(dli.headers[i]);
+  if (dli.sink.get() != 0)
+    this->asynchttp->set_sink(dli.sink);
 
   this->asynchttp->signal_done().connect(sigc::mem_fun
       (*this, &GtkDownloader::on_download_complete));
@@ -132,21 +137,28 @@ GtkDownloader::on_update_event (void)
   }
 
   size_t bytes_total = this->asynchttp->get_bytes_total();
+  size_t bytes_received = this->asynchttp->get_bytes_received();
   size_t bytes_read = this->asynchttp->get_bytes_read();
 
-  std::string bytes_read_str = Helpers::get_string_from_float
-      ((float)bytes_read / 1024.0f, 0);
+  /* The total size is known on the wire only, the decoded size is
+   * shown in addition if the server compresses the transfer. */
+  std::string size_str = Helpers::get_string_from_float
+      ((float)bytes_received / 1024.0f, 0) + " KB";
+  if (bytes_read > bytes_received)
+    size_str += " (" + Helpers::get_string_from_float
+        ((float)bytes_read / 1024.0f, 0) + " KB decoded)";
 
   if (bytes_total == 0)
   {
-    this->progressbar.set_text(bytes_read_str + " KB");
+    this->progressbar.set_text(size_str);
     this->progressbar.set_fraction(0.0);
   }
   else
   {
-    float percent = 100.0f * (float)bytes_read / (float)bytes_total;
+    float percent = 100.0f * (float)bytes_received / (float)bytes_total;
+    percent = std::min(100.0f, percent);
     std::string percent_str = Helpers::get_string_from_float(percent, 1);
-    this->progressbar.set_text(bytes_read_str + "KB - " + percent_str + "%");
+    this->progressbar.set_text(size_str + " - " + percent_str + "%");
     this->progressbar.set_fraction(percent / 100.0f);
   }
 
@@ -26,6 +26,9 @@ struct DownloadItem
   std::string name;
   std::string host;
   std::string path;
+  std::vector<std::string> headers;
+  /* Receives the body instead of the HTTP data, if set. */
+  HttpSinkPtr sink;
   bool is_api_call;
 
   DownloadItem (void);
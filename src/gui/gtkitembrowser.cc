@@ -9,6 +9,7 @@
 // along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <set>
 
 #include <gtkmm.h>
 
@@ -21,8 +22,11 @@
 
 ItemBrowserBase::ItemBrowserBase (void)
   : store(Gtk::TreeStore::create(cols)),
-    view(store)
+    filter(Gtk::TreeModelFilter::create(store)),
+    view(filter)
 {
+  this->filter->set_visible_column(this->cols.visible);
+
   Gtk::TreeViewColumn* col_name = Gtk::manage(new Gtk::TreeViewColumn);
   col_name->set_title("Name");
   col_name->pack_start(this->cols.icon, false);
@@ -73,7 +77,7 @@ void
 ItemBrowserBase::on_row_activated (Gtk::TreeModel::Path const& path,
     Gtk::TreeViewColumn* /*col*/)
 {
-  Gtk::TreeModel::iterator iter = this->store->get_iter(path);
+  Gtk::TreeModel::iterator iter = this->filter->get_iter(path);
   ApiElement const* elem = (*iter)[this->cols.data];
 
   if (elem != 0)
@@ -148,7 +152,107 @@ ItemBrowserBase::on_query_element_tooltip (int x, int y,
     bool /* key */, Glib::RefPtr<Gtk::Tooltip> const& tooltip)
 {
   return GtkHelpers::create_tooltip_from_view(x, y, tooltip,
-      this->view, this->store, this->cols.data);
+      this->view, this->filter, this->cols.data);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::clear_rows (void)
+{
+  this->store->clear();
+  this->group_rows.clear();
+  this->item_rows.clear();
+}
+
+/* ---------------------------------------------------------------- */
+
+ItemBrowserBase::GroupRow*
+ItemBrowserBase::append_group_row (GroupRow* parent,
+    Glib::ustring const& name, Glib::RefPtr<Gdk::Pixbuf> const& icon)
+{
+  GroupRow group;
+  group.iter = parent == 0 ? this->store->append()
+      : this->store->append(parent->iter->children());
+  group.parent = parent;
+  group.visible_items = 0;
+
+  (*group.iter)[this->cols.name] = name;
+  (*group.iter)[this->cols.icon] = icon;
+  (*group.iter)[this->cols.data] = 0;
+  (*group.iter)[this->cols.visible] = false;
+
+  this->group_rows.push_back(group);
+  return &this->group_rows.back();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::append_item_row (GroupRow* group,
+    Glib::ustring const& name, ApiElement const* elem)
+{
+  ItemRow row;
+  row.iter = this->store->append(group->iter->children());
+  row.group = group;
+  row.elem = elem;
+
+  (*row.iter)[this->cols.name] = name;
+  (*row.iter)[this->cols.data] = elem;
+  (*row.iter)[this->cols.visible] = false;
+
+  this->item_rows.push_back(row);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::reset_group_rows (void)
+{
+  for (GroupRowList::iterator iter = this->group_rows.begin();
+      iter != this->group_rows.end(); iter++)
+    iter->visible_items = 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::update_item_row (ItemRow& row, bool visible,
+    Glib::RefPtr<Gdk::Pixbuf> const& icon)
+{
+  if (row.icon != icon)
+  {
+    row.icon = icon;
+    (*row.iter)[this->cols.icon] = icon;
+  }
+
+  this->set_row_visible(row.iter, visible);
+
+  if (visible)
+    for (GroupRow* group = row.group; group != 0; group = group->parent)
+      group->visible_items += 1;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::update_group_rows (void)
+{
+  for (GroupRowList::iterator iter = this->group_rows.begin();
+      iter != this->group_rows.end(); iter++)
+    this->set_row_visible(iter->iter, iter->visible_items > 0);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+ItemBrowserBase::set_row_visible (Gtk::TreeModel::iterator const& iter,
+    bool visible)
+{
+  /* Only changed rows are inserted into or removed from the view. */
+  bool was_visible = (*iter)[this->cols.visible];
+  if (was_visible != visible)
+    (*iter)[this->cols.visible] = visible;
 }
 
 /* ================================================================ */
@@ -174,7 +278,9 @@ enum ComboBoxSkillFilterAttribute
 };
 
 GtkSkillBrowser::GtkSkillBrowser (void)
-  : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5)
+  : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5),
+    tree_revision(0),
+    only_published(true)
 {
   this->store->set_sort_column(this->cols.name, Gtk::SORT_ASCENDING);
 
@@ -231,13 +337,13 @@ GtkSkillBrowser::GtkSkillBrowser (void)
   this->pack_start(*scwin, true, true, 0);
 
   this->filter_entry.signal_activate().connect(sigc::mem_fun
-      (*this, &GtkSkillBrowser::fill_store));
+      (*this, &GtkSkillBrowser::update_filter));
   this->filter_cb.signal_changed().connect(sigc::mem_fun
-      (*this, &GtkSkillBrowser::fill_store));
+      (*this, &GtkSkillBrowser::update_filter));
   this->primary_cb.signal_changed().connect(sigc::mem_fun
-      (*this, &GtkSkillBrowser::fill_store));
+      (*this, &GtkSkillBrowser::update_filter));
   this->secondary_cb.signal_changed().connect(sigc::mem_fun
-      (*this, &GtkSkillBrowser::fill_store));
+      (*this, &GtkSkillBrowser::update_filter));
   clear_filter_but->signal_clicked().connect(sigc::mem_fun
       (*this, &GtkSkillBrowser::clear_filter));
 }
@@ -247,43 +353,28 @@ GtkSkillBrowser::GtkSkillBrowser (void)
 void
 GtkSkillBrowser::fill_store (void)
 {
-  this->store->clear();
-  Glib::ustring filter = this->filter_entry.get_text();
+  this->clear_rows();
 
   ApiSkillTreePtr tree = ApiSkillTree::request();
   ApiSkillMap& skills = tree->skills;
   ApiSkillGroupMap& groups = tree->groups;
 
-  typedef Gtk::TreeModel::iterator GtkTreeModelIter;
-  typedef std::map<int, std::pair<GtkTreeModelIter, int> > SkillGroupsMap;
-  SkillGroupsMap skill_group_iters;
+  std::string unpublished_cfg("planner.show_unpublished_skills");
+  this->only_published = !Config::conf.get_value(unpublished_cfg)->get_bool();
+  this->tree_revision = tree->revision;
+
+  typedef std::map<int, GroupRow*> SkillGroupsMap;
+  SkillGroupsMap skill_group_rows;
 
   /* Append all skill groups to the store. */
   for (ApiSkillGroupMap::iterator iter = groups.begin();
       iter != groups.end(); iter++)
   {
-    Gtk::TreeModel::iterator siter = this->store->append();
-    (*siter)[this->cols.name] = iter->second.name;
-    (*siter)[this->cols.icon] = ImageStore::skillicons[0];
-    (*siter)[this->cols.data] = 0;
-    skill_group_iters.insert(std::make_pair
-        (iter->first, std::make_pair(siter, 0)));
+    GroupRow* group = this->append_group_row(0, iter->second.name,
+        ImageStore::skillicons[0]);
+    skill_group_rows.insert(std::make_pair(iter->first, group));
   }
 
-  /* Prepare some short hands .*/
-  int active_row_num = this->filter_cb.get_active_row_number();
-  int primary_active_row_num = this->primary_cb.get_active_row_number();
-  int secondary_active_row_num = this->secondary_cb.get_active_row_number();
-  bool only_unknown = (active_row_num == CB_FILTER_SKILL_UNKNOWN);
-  bool only_partial = (active_row_num == CB_FILTER_SKILL_PARTIAL);
-  bool only_enabled = (active_row_num == CB_FILTER_SKILL_ENABLED);
-  bool only_known = (active_row_num == CB_FILTER_SKILL_KNOWN) || (active_row_num == CB_FILTER_SKILL_KNOWN_BUT_V);
-  bool only_known_but_v = (active_row_num == CB_FILTER_SKILL_KNOWN_BUT_V);
-  ApiAttrib primary = primary_active_row_num == CB_FILTER_ATTRIBUTE_ANY ? API_ATTRIB_UNKNOWN : (ApiAttrib)(primary_active_row_num-CB_FILTER_ATTRIBUTE_INTELLIGENCE);
-  ApiAttrib secondary = secondary_active_row_num == CB_FILTER_ATTRIBUTE_ANY ? API_ATTRIB_UNKNOWN : (ApiAttrib)(secondary_active_row_num-CB_FILTER_ATTRIBUTE_INTELLIGENCE);
-  std::string unpublished_cfg("planner.show_unpublished_skills");
-  bool only_published = !Config::conf.get_value(unpublished_cfg)->get_bool();
-
   /* Append all skills to the skill groups. */
   for (ApiSkillMap::iterator iter = skills.begin();
       iter != skills.end(); iter++)
@@ -291,37 +382,82 @@ GtkSkillBrowser::fill_store (void)
     ApiSkill& skill = iter->second;
 
     /* Filter non-public skills if so requested */
-    if (only_published && !skill.published)
-      continue;
-
-    /* Apply string filter. */
-    if (Glib::ustring(skill.name).casefold()
-        .find(filter.casefold()) == Glib::ustring::npos)
+    if (this->only_published && !skill.published)
       continue;
 
-    SkillGroupsMap::iterator giter = skill_group_iters.find(skill.group);
-    if (giter == skill_group_iters.end())
+    SkillGroupsMap::iterator giter = skill_group_rows.find(skill.group);
+    if (giter == skill_group_rows.end())
     {
       std::cout << "Error appending skill, unknown group!" << std::endl;
       continue;
     }
 
+    char const *primary_name = ApiSkillTree::get_attrib_short_name(skill.primary);
+    char const *secondary_name = ApiSkillTree::get_attrib_short_name(skill.secondary);
+    this->append_item_row(giter->second, skill.name + " ("
+        + Helpers::get_string_from_int(skill.rank)
+        + ") <span size=\"small\" foreground=\"grey\">" + primary_name + "/"
+        + secondary_name + "</span>", &skill);
+  }
+
+  this->update_filter();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillBrowser::update_filter (void)
+{
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+
+  /* Recreate the rows if the skills or the setting changed. */
+  std::string unpublished_cfg("planner.show_unpublished_skills");
+  bool only_published = !Config::conf.get_value(unpublished_cfg)->get_bool();
+  if (tree->revision != this->tree_revision
+      || only_published != this->only_published)
+  {
+    this->fill_store();
+    return;
+  }
+
+  /* Look up the skills matching the string filter. */
+  Glib::ustring filter = this->filter_entry.get_text();
+  std::set<int> matches;
+  tree->get_name_index().find(filter, matches);
+
+  /* Prepare some short hands .*/
+  int active_row_num = this->filter_cb.get_active_row_number();
+  int primary_active_row_num = this->primary_cb.get_active_row_number();
+  int secondary_active_row_num = this->secondary_cb.get_active_row_number();
+  bool only_unknown = (active_row_num == CB_FILTER_SKILL_UNKNOWN);
+  bool only_partial = (active_row_num == CB_FILTER_SKILL_PARTIAL);
+  bool only_enabled = (active_row_num == CB_FILTER_SKILL_ENABLED);
+  bool only_known = (active_row_num == CB_FILTER_SKILL_KNOWN) || (active_row_num == CB_FILTER_SKILL_KNOWN_BUT_V);
+  bool only_known_but_v = (active_row_num == CB_FILTER_SKILL_KNOWN_BUT_V);
+  ApiAttrib primary = primary_active_row_num == CB_FILTER_ATTRIBUTE_ANY ? API_ATTRIB_UNKNOWN : (ApiAttrib)(primary_active_row_num-CB_FILTER_ATTRIBUTE_INTELLIGENCE);
+  ApiAttrib secondary = secondary_active_row_num == CB_FILTER_ATTRIBUTE_ANY ? API_ATTRIB_UNKNOWN : (ApiAttrib)(secondary_active_row_num-CB_FILTER_ATTRIBUTE_INTELLIGENCE);
+
+  /* Update status and visibility of all skills. */
+  this->reset_group_rows();
+  for (ItemRowList::iterator iter = this->item_rows.begin();
+      iter != this->item_rows.end(); iter++)
+  {
+    ApiSkill const& skill = *(ApiSkill const*)iter->elem;
     ApiCharSheetSkill* cskill = this->charsheet->get_skill_for_id(skill.id);
+    bool visible = matches.find(skill.id) != matches.end();
     Glib::RefPtr<Gdk::Pixbuf> skill_icon;
 
-    if (cskill == 0)
-    {
-      if (primary!=API_ATTRIB_UNKNOWN)
-        if (skill.primary != primary)
-          continue;
+    if (primary != API_ATTRIB_UNKNOWN && skill.primary != primary)
+      visible = false;
 
-      if (secondary!=API_ATTRIB_UNKNOWN)
-        if (skill.secondary != secondary)
-          continue;
+    if (secondary != API_ATTRIB_UNKNOWN && skill.secondary != secondary)
+      visible = false;
 
+    if (cskill == 0)
+    {
       /* The skill is unknown. */
       if (only_known || only_partial)
-        continue;
+        visible = false;
 
       if (this->have_prerequisites_for_skill(&skill))
       {
@@ -332,32 +468,23 @@ GtkSkillBrowser::fill_store (void)
       {
         /* The skill is unknown and no prequisites. */
         if (only_enabled)
-          continue;
+          visible = false;
         skill_icon = ImageStore::skillstatus[0];
       }
-
     }
     else
     {
-      if (primary!=API_ATTRIB_UNKNOWN)
-        if (skill.primary != primary)
-          continue;
-
-      if (secondary!=API_ATTRIB_UNKNOWN)
-        if (skill.secondary != secondary)
-          continue;
-
       /* The skill is known. */
       if (only_unknown || only_enabled)
-        continue;
+        visible = false;
 
       /* Check if the skill is partially trained. */
       if (only_partial && cskill->points == cskill->points_start)
-        continue;
+        visible = false;
 
       /* The skill is known and already trained to level v */
       if (only_known_but_v && cskill->level == 5)
-        continue;
+        visible = false;
 
       switch (cskill->level)
       {
@@ -371,29 +498,11 @@ GtkSkillBrowser::fill_store (void)
       }
     }
 
-    /* Finally append the skill. */
-    Gtk::TreeModel::iterator siter = this->store->append
-        (giter->second.first->children());
-    char const *primary_name = ApiSkillTree::get_attrib_short_name(skill.primary);
-    char const *secondary_name = ApiSkillTree::get_attrib_short_name(skill.secondary);
-    (*siter)[this->cols.name] = skill.name + " ("
-        + Helpers::get_string_from_int(skill.rank)
-        + ") <span size=\"small\" foreground=\"grey\">" + primary_name + "/"
-        + secondary_name + "</span>";
-    (*siter)[this->cols.data] = &skill;
-
-    (*siter)[this->cols.icon] = skill_icon;
-
-    giter->second.second += 1;
+    this->update_item_row(*iter, visible, skill_icon);
   }
 
-  /* Remove empty groups (due to filtering). */
-  for (SkillGroupsMap::iterator iter = skill_group_iters.begin();
-      iter != skill_group_iters.end(); iter++)
-  {
-    if (iter->second.second == 0)
-      this->store->erase(iter->second.first);
-  }
+  /* Hide empty groups (due to filtering). */
+  this->update_group_rows();
 
   if (!filter.empty() || primary != API_ATTRIB_UNKNOWN
       || secondary != API_ATTRIB_UNKNOWN || active_row_num != 0)
@@ -406,7 +515,7 @@ void
 GtkSkillBrowser::clear_filter (void)
 {
   this->filter_entry.set_text("");
-  this->fill_store();
+  this->update_filter();
 }
 
 /* ---------------------------------------------------------------- */
@@ -415,17 +524,7 @@ bool
 GtkSkillBrowser::have_prerequisites_for_skill (ApiSkill const* skill)
 {
   ApiSkillTreePtr tree = ApiSkillTree::request();
-  for (unsigned int i = 0; i < skill->deps.size(); ++i)
-  {
-    int depskill_id = skill->deps[i].first;
-    int depskill_level = skill->deps[i].second;
-
-    int charlevel = this->charsheet->get_level_for_skill(depskill_id);
-    if (charlevel < depskill_level)
-      return false;
-  }
-
-  return true;
+  return tree->has_prerequisites(skill, this->charsheet->get_known_levels());
 }
 
 /* ================================================================ */
@@ -440,7 +539,8 @@ enum ComboBoxCertFilter
 };
 
 GtkCertBrowser::GtkCertBrowser (void)
-  : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5)
+  : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5),
+    tree_revision(0)
 {
   this->filter_cb.append("Show all certificates");
   this->filter_cb.append("Only show claimed certs");
@@ -469,9 +569,9 @@ GtkCertBrowser::GtkCertBrowser (void)
   this->pack_start(*scwin, true, true, 0);
 
   this->filter_entry.signal_activate().connect(sigc::mem_fun
-      (*this, &GtkCertBrowser::fill_store));
+      (*this, &GtkCertBrowser::update_filter));
   this->filter_cb.signal_changed().connect(sigc::mem_fun
-      (*this, &GtkCertBrowser::fill_store));
+      (*this, &GtkCertBrowser::update_filter));
   clear_filter_but->signal_clicked().connect(sigc::mem_fun
       (*this, &GtkCertBrowser::clear_filter));
 }
@@ -481,107 +581,127 @@ GtkCertBrowser::GtkCertBrowser (void)
 void
 GtkCertBrowser::fill_store (void)
 {
-  this->store->clear();
-  Glib::ustring filter = this->filter_entry.get_text();
+  this->clear_rows();
 
   ApiCertTreePtr tree = ApiCertTree::request();
   ApiCertMap& certs = tree->certificates;
+  this->tree_revision = tree->revision;
 
-  /* Prepare some short hands .*/
-  int active_row_num = this->filter_cb.get_active_row_number();
-  bool only_claimed = (active_row_num == CB_FILTER_CERT_CLAIMED);
-  bool only_claimable = (active_row_num == CB_FILTER_CERT_CLAIMABLE);
-  bool only_partial = (active_row_num == CB_FILTER_CERT_PARTIAL);
-  bool only_unknown = (active_row_num == CB_FILTER_CERT_NOPRE);
-
-  typedef std::pair<int, ApiCert const*> CertShowInfo;
-  typedef std::map<Glib::ustring, CertShowInfo> CertClassMap;
+  typedef std::map<Glib::ustring, ApiCert const*> CertClassMap;
   typedef std::map<int, CertClassMap> CertGradeMap;
   typedef std::map<Glib::ustring, CertGradeMap> CertCatMap;
   CertCatMap show_mapping;
 
-  /* Iterate over all certificates, check character status and add to maps. */
+  /* Sort all certificates by category, grade and class. */
   for (ApiCertMap::iterator iter = certs.begin(); iter != certs.end(); iter++)
   {
     ApiCert const* cert = &iter->second;
     ApiCertClass const* cclass = cert->class_details;
     ApiCertCategory const* cat = cclass->cat_details;
+    show_mapping[cat->name][cert->grade][cclass->name] = cert;
+  }
 
-    /* Check if cert matches the filter. */
-    if (!filter.empty() && Glib::ustring(cclass->name)
-        .casefold().find(filter.casefold()) == Glib::ustring::npos)
-      continue;
+  /* Fill the certificate store. */
+  for (CertCatMap::iterator i = show_mapping.begin();
+      i != show_mapping.end(); i++)
+  {
+    GroupRow* cat_row = this->append_group_row(0, i->first,
+        ImageStore::certificate_small);
+
+    for (CertGradeMap::iterator j = i->second.begin();
+        j != i->second.end(); j++)
+    {
+      int grade_idx = ApiCertTree::get_grade_index(j->first);
+      GroupRow* grade_row = this->append_group_row(cat_row,
+          ApiCertTree::get_name_for_grade(j->first),
+          ImageStore::certgrades[grade_idx]);
+
+      for (CertClassMap::iterator k = j->second.begin();
+          k != j->second.end(); k++)
+        this->append_item_row(grade_row, k->first, k->second);
+    }
+  }
+
+  this->update_filter();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkCertBrowser::update_filter (void)
+{
+  ApiCertTreePtr tree = ApiCertTree::request();
+
+  /* Recreate the rows if the certificates changed. */
+  if (tree->revision != this->tree_revision)
+  {
+    this->fill_store();
+    return;
+  }
+
+  /* Look up the classes matching the string filter. */
+  Glib::ustring filter = this->filter_entry.get_text();
+  std::set<int> matches;
+  tree->get_name_index().find(filter, matches);
+
+  /* Prepare some short hands .*/
+  int active_row_num = this->filter_cb.get_active_row_number();
+  bool only_claimed = (active_row_num == CB_FILTER_CERT_CLAIMED);
+  bool only_claimable = (active_row_num == CB_FILTER_CERT_CLAIMABLE);
+  bool only_partial = (active_row_num == CB_FILTER_CERT_PARTIAL);
+  bool only_unknown = (active_row_num == CB_FILTER_CERT_NOPRE);
+
+  /* Update status and visibility of all certificates. */
+  this->reset_group_rows();
+  for (ItemRowList::iterator iter = this->item_rows.begin();
+      iter != this->item_rows.end(); iter++)
+  {
+    ApiCert const* cert = (ApiCert const*)iter->elem;
+    ApiCertClass const* cclass = cert->class_details;
+    bool visible = matches.find(cclass->id) != matches.end();
+    int status;
 
-    CertShowInfo csi;
-    csi.second = cert;
     int cgrade = this->charsheet->get_grade_for_class(cclass->id);
     if (cgrade < cert->grade)
     {
       if (only_claimed)
-        continue;
+        visible = false;
 
       switch (this->check_prerequisites_for_cert(cert))
       {
         default:
         case CERT_PRE_HAVE_NONE:
           if (only_claimable || only_partial)
-            continue;
-          csi.first = 3;
+            visible = false;
+          status = 3;
           break;
 
         case CERT_PRE_HAVE_SOME:
           if (only_claimable || only_unknown)
-            continue;
-          csi.first = 2;
+            visible = false;
+          status = 2;
           break;
 
         case CERT_PRE_HAVE_ALL:
           if (only_partial || only_unknown)
-            continue;
-          csi.first = 1;
+            visible = false;
+          status = 1;
           break;
       }
     }
     else
     {
       if (only_claimable || only_partial || only_unknown)
-        continue;
+        visible = false;
 
-      csi.first = 0;
+      status = 0;
     }
 
-    /* Certificate matched filters. Add to sets. */
-    show_mapping[cat->name][cert->grade][cclass->name] = csi;
+    this->update_item_row(*iter, visible, ImageStore::certstatus[status]);
   }
 
-  /* Fill the certificate store. */
-  for (CertCatMap::iterator i = show_mapping.begin();
-      i != show_mapping.end(); i++)
-  {
-    Gtk::TreeModel::iterator siter = this->store->append();
-    (*siter)[this->cols.name] = i->first;
-    (*siter)[this->cols.icon] = ImageStore::certificate_small;
-    (*siter)[this->cols.data] = 0;
-
-    for (CertGradeMap::iterator j = i->second.begin();
-        j != i->second.end(); j++)
-    {
-      Gtk::TreeModel::iterator siter2 = this->store->append(siter->children());
-      int grade_idx = ApiCertTree::get_grade_index(j->first);
-      (*siter2)[this->cols.name] = ApiCertTree::get_name_for_grade(j->first);
-      (*siter2)[this->cols.icon] = ImageStore::certgrades[grade_idx];
-      (*siter2)[this->cols.data] = 0;
-
-      for (CertClassMap::iterator k = j->second.begin();
-          k != j->second.end(); k++)
-      {
-        Gtk::TreeModel::iterator row = this->store->append(siter2->children());
-        (*row)[this->cols.name] = k->second.second->class_details->name;
-        (*row)[this->cols.icon] = ImageStore::certstatus[k->second.first];
-        (*row)[this->cols.data] = k->second.second;
-      }
-    }
-  }
+  /* Hide empty categories and grades. */
+  this->update_group_rows();
 
   if (!filter.empty() || active_row_num != 0)
     this->view.expand_all();
@@ -593,7 +713,7 @@ void
 GtkCertBrowser::clear_filter (void)
 {
   this->filter_entry.set_text("");
-  this->fill_store();
+  this->update_filter();
 }
 
 /* ---------------------------------------------------------------- */
@@ -11,6 +11,8 @@
 #ifndef GTK_ITEM_BROWSER_HEADER
 #define GTK_ITEM_BROWSER_HEADER
 
+#include <list>
+#include <vector>
 #include <gtkmm.h>
 
 #include "api/apicharsheet.h"
@@ -23,13 +25,59 @@ class ItemBrowserBase
     SignalApiElementActivated sig_element_activated;
     SignalPlanningRequested sig_planning_requested;
 
+  protected:
+    class ItemBrowserCols : public GuiPlannerElemCols
+    {
+      public:
+        Gtk::TreeModelColumn<bool> visible;
+        ItemBrowserCols (void)
+        { this->add(visible); }
+    };
+
+    /* A group row is visible as long as it has visible items. */
+    struct GroupRow
+    {
+      Gtk::TreeModel::iterator iter;
+      GroupRow* parent;
+      int visible_items;
+    };
+
+    struct ItemRow
+    {
+      Gtk::TreeModel::iterator iter;
+      GroupRow* group;
+      ApiElement const* elem;
+      Glib::RefPtr<Gdk::Pixbuf> icon;
+    };
+
+    typedef std::list<GroupRow> GroupRowList;
+    typedef std::vector<ItemRow> ItemRowList;
+
   protected:
     ApiCharSheetPtr charsheet;
-    GuiPlannerElemCols cols;
+    ItemBrowserCols cols;
     Glib::RefPtr<Gtk::TreeStore> store;
+    Glib::RefPtr<Gtk::TreeModelFilter> filter;
     GtkListViewHelper view;
 
+    /* The rows are created once by fill_store(). Changing the
+     * filter only updates the rows whose visibility changed. */
+    GroupRowList group_rows;
+    ItemRowList item_rows;
+
   protected:
+    /* Row management for fill_store() and the filter updates. */
+    void clear_rows (void);
+    GroupRow* append_group_row (GroupRow* parent, Glib::ustring const& name,
+        Glib::RefPtr<Gdk::Pixbuf> const& icon);
+    void append_item_row (GroupRow* group, Glib::ustring const& name,
+        ApiElement const* elem);
+    void reset_group_rows (void);
+    void update_item_row (ItemRow& row, bool visible,
+        Glib::RefPtr<Gdk::Pixbuf> const& icon);
+    void update_group_rows (void);
+    void set_row_visible (Gtk::TreeModel::iterator const& iter, bool visible);
+
     /* Executed if the item selection changed. */
     void on_selection_changed (void);
     /* Executed if some item is double clicked. */
@@ -64,8 +112,13 @@ class GtkSkillBrowser : public ItemBrowserBase, public Gtk::Box
     Gtk::ComboBoxText primary_cb;
     Gtk::ComboBoxText secondary_cb;
 
+    /* The tree revision and setting the rows were created for. */
+    unsigned int tree_revision;
+    bool only_published;
+
   protected:
     void fill_store (void);
+    void update_filter (void);
     void clear_filter (void);
     bool have_prerequisites_for_skill (ApiSkill const* skill);
 
@@ -89,8 +142,12 @@ class GtkCertBrowser : public ItemBrowserBase, public Gtk::Box
     Gtk::Entry filter_entry;
     Gtk::ComboBoxText filter_cb;
 
+    /* The tree revision the rows were created for. */
+    unsigned int tree_revision;
+
   protected:
     void fill_store (void);
+    void update_filter (void);
     void clear_filter (void);
     CertPrerequisite check_prerequisites_for_cert (ApiCert const* cert);
 
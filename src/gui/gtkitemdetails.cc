@@ -161,6 +161,38 @@ GtkDependencyList::set_cert (ApiCert const* cert)
 
 /* ---------------------------------------------------------------- */
 
+void
+GtkDependencyList::set_enabled_skills (ApiSkill const* skill)
+{
+  this->deps_store->clear();
+
+  /* Group the skills that directly require this skill by level. */
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+  ApiSkillDepList const& enabled = tree->get_enabled_skills(skill);
+  for (int level = 1; level <= 5; ++level)
+  {
+    Gtk::TreeModel::iterator slot;
+    for (std::size_t i = 0; i < enabled.size(); ++i)
+    {
+      if (enabled[i].second != level)
+        continue;
+
+      if (!slot)
+      {
+        slot = this->deps_store->append();
+        this->recurse_append_skill_req(skill, slot, level, false);
+      }
+
+      this->recurse_append_skill_req(enabled[i].first,
+          this->deps_store->append(slot->children()), 1, false);
+    }
+  }
+
+  this->deps_view.expand_all();
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 GtkDependencyList::recurse_append_skill_req (ApiSkill const* skill,
     Gtk::TreeModel::iterator slot, int level, bool recurse)
@@ -183,21 +215,12 @@ GtkDependencyList::recurse_append_skill_req (ApiSkill const* skill,
   if (!recurse)
     return;
 
+  /* The resolved dependencies contain no skills requiring themselves. */
   ApiSkillTreePtr tree = ApiSkillTree::request();
-  for (unsigned int i = 0; i < skill->deps.size(); ++i)
-  {
-    int skill_id = skill->deps[i].first;
-    int newlevel = skill->deps[i].second;
-
-    // Prevent endless recursion
-    bool recurse_this = true;
-    if (skill_id == skill->id)
-        recurse_this = false;
-
-    ApiSkill const* newskill = tree->get_skill_for_id(skill_id);
-    this->recurse_append_skill_req(newskill,
-        this->deps_store->append(slot->children()), newlevel, recurse_this);
-  }
+  ApiSkillDepList const& deps = tree->get_dependencies(skill);
+  for (std::size_t i = 0; i < deps.size(); ++i)
+    this->recurse_append_skill_req(deps[i].first,
+        this->deps_store->append(slot->children()), deps[i].second);
 }
 
 /* ---------------------------------------------------------------- */
@@ -465,7 +488,7 @@ GtkItemDetails::on_element_changed (ApiElement const* elem)
 GtkSkillDetails::GtkSkillDetails (void)
   : Gtk::Box(Gtk::ORIENTATION_VERTICAL, 5),
     desc_buffer(Gtk::TextBuffer::create()),
-    deps(false)
+    deps(false), enabled(false)
 {
   this->skill_primary.set_halign(Gtk::ALIGN_START);
   this->skill_secondary.set_halign(Gtk::ALIGN_START);
@@ -534,11 +557,16 @@ GtkSkillDetails::GtkSkillDetails (void)
   details_table->attach(*text_scwin, 2, 3, 0, 7,
       Gtk::FILL | Gtk::EXPAND, Gtk::FILL | Gtk::EXPAND);
 
+  /* Prerequisites and the reverse lookup in a notebook. */
+  Gtk::Notebook* deps_notebook = Gtk::manage(new Gtk::Notebook);
+  deps_notebook->append_page(this->deps, "Prerequisites");
+  deps_notebook->append_page(this->enabled, "Enables");
+
   /* Pack stuff together, create vpaned window. */
   Gtk::VPaned* vpaned = Gtk::manage(new Gtk::VPaned);
   vpaned->set_position(1);
   vpaned->pack1(*details_table, true, false);
-  vpaned->pack2(this->deps, true, false);
+  vpaned->pack2(*deps_notebook, true, false);
 
   this->pack_start(*vpaned, true, true, 0);
 
@@ -553,6 +581,10 @@ GtkSkillDetails::GtkSkillDetails (void)
       (this->sig_planning_requested, &SignalPlanningRequested::emit));
   this->deps.signal_element_selected().connect(sigc::mem_fun
       (this->sig_element_selected, &SignalApiElementSelected::emit));
+  this->enabled.signal_planning_requested().connect(sigc::mem_fun
+      (this->sig_planning_requested, &SignalPlanningRequested::emit));
+  this->enabled.signal_element_selected().connect(sigc::mem_fun
+      (this->sig_element_selected, &SignalApiElementSelected::emit));
 }
 
 /* ---------------------------------------------------------------- */
@@ -606,6 +638,8 @@ GtkSkillDetails::set_skill (ApiSkill const* skill)
 
   this->deps.set_character(this->character);
   this->deps.set_skill(skill);
+  this->enabled.set_character(this->character);
+  this->enabled.set_enabled_skills(skill);
 }
 
 /* ================================================================ */
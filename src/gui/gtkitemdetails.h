@@ -105,6 +105,8 @@ class GtkDependencyList : public GtkItemDetailsBase, public Gtk::ScrolledWindow
     GtkDependencyList (bool elem_indicator);
     void set_skill (ApiSkill const* skill);
     void set_cert (ApiCert const* cert);
+    /* Lists the skills that require the given skill, by level. */
+    void set_enabled_skills (ApiSkill const* skill);
 };
 
 /* ---------------------------------------------------------------- */
@@ -119,6 +121,7 @@ class GtkSkillDetails : public GtkItemDetailsBase, public Gtk::Box
     Gtk::Label skill_level[5];
     Glib::RefPtr<Gtk::TextBuffer> desc_buffer;
     GtkDependencyList deps;
+    GtkDependencyList enabled;
 
   public:
     GtkSkillDetails (void);
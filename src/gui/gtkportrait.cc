@@ -9,7 +9,6 @@
 // along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
 
 #include <sstream>
-#include <fstream>
 #include <iostream>
 
 #include <gtkmm.h>
@@ -20,6 +19,11 @@
 #include "imagestore.h"
 #include "gtkportrait.h"
 
+namespace {
+  /* Every download gets its own file, requests may overlap. */
+  unsigned int download_counter = 0;
+}
+
 GtkPortrait::GtkPortrait (void)
 {
   this->add(this->image);
@@ -116,16 +120,24 @@ GtkPortrait::request_from_eve_online (void)
   std::cout << "Requesting portrait: " << this->char_id
       << " ..." << std::endl;
 
+  std::string jpg_name = this->get_download_file();
+
   AsyncHttp* http = AsyncHttp::create();;
   //http->set_host("img.eve.is");
   //http->set_path("/serv.asp?s=256&c=" + this->char_id);
   http->set_host("image.eveonline.com");
   http->set_path("/Character/" + this->char_id + "_256.jpg");
+  http->set_sink(HttpFileSink::create(jpg_name));
   Config::setup_http(http, true);
 
+  /* A previous request keeps running, but is not shown anymore. The
+   * download is removed after the handler ran, or if it was disconnected
+   * because the request was superseded or the widget was destroyed. */
   this->http_request.disconnect();
-  this->http_request = http->signal_done().connect(sigc::mem_fun
-      (*this, &GtkPortrait::set_from_eve_online));
+  this->http_request = http->signal_done().connect(sigc::bind(sigc::mem_fun
+      (*this, &GtkPortrait::set_from_eve_online), jpg_name));
+  http->signal_done().connect(sigc::hide(sigc::bind(sigc::ptr_fun
+      (&GtkPortrait::remove_download), jpg_name)));
 
   http->async_request();
 }
@@ -133,7 +145,8 @@ GtkPortrait::request_from_eve_online (void)
 /* ---------------------------------------------------------------- */
 
 void
-GtkPortrait::set_from_eve_online (AsyncHttpData result)
+GtkPortrait::set_from_eve_online (AsyncHttpData result,
+    std::string jpg_name)
 {
   if (result.data.get() == 0)
   {
@@ -147,28 +160,18 @@ GtkPortrait::set_from_eve_online (AsyncHttpData result)
     return;
   }
 
-  /* Generate filenames to store the fetched JPG and the destination PNG. */
-  std::string confdir = Config::get_conf_dir();
-  std::stringstream jpg_name;
-  jpg_name << confdir << "/" << this->char_id << "_256.jpg";
-
+  /* The fetched JPG was streamed to disk and is converted to PNG. */
   try
   {
-    std::ofstream out(jpg_name.str().c_str(), std::ios::binary);
-    out.write(&result.data->data[0], result.data->data.size() - 1);
-    out.close();
-
     Glib::RefPtr<Gdk::Pixbuf> image
-        = GtkPortrait::create_from_file(jpg_name.str())
+        = GtkPortrait::create_from_file(jpg_name)
         ->scale_simple(PORTRAIT_SIZE, PORTRAIT_SIZE, Gdk::INTERP_BILINEAR);
 
     this->cache_portrait(image);
-    OS::unlink(jpg_name.str().c_str());
     this->fetch_from_gtkevemon_cache();
   }
   catch (...)
   {
-    OS::unlink(jpg_name.str().c_str());
     std::cout << "Error saving portrait from EVE Online" << std::endl;
     return;
   }
@@ -249,6 +252,26 @@ GtkPortrait::get_portrait_file (void)
 
 /* ---------------------------------------------------------------- */
 
+std::string
+GtkPortrait::get_download_file (void)
+{
+  std::stringstream filename;
+  filename << Config::get_conf_dir() << "/" << this->char_id
+      << "_256." << download_counter++ << ".jpg";
+  return filename.str();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkPortrait::remove_download (std::string const& fn)
+{
+  if (OS::file_exists(fn.c_str()))
+    OS::unlink(fn.c_str());
+}
+
+/* ---------------------------------------------------------------- */
+
 Glib::RefPtr<Gdk::Pixbuf>
 GtkPortrait::create_from_file (std::string const& fn)
 {
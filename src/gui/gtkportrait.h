@@ -30,14 +30,16 @@ class GtkPortrait : public Gtk::EventBox
 
     bool fetch_from_gtkevemon_cache (void);
     void request_from_eve_online (void);
-    void set_from_eve_online (AsyncHttpData result);
+    void set_from_eve_online (AsyncHttpData result, std::string jpg_name);
     bool on_button_press_myevent (GdkEventButton* event);
     std::string get_portrait_dir (void);
     std::string get_portrait_file (void);
+    std::string get_download_file (void);
 
     void cache_portrait (Glib::RefPtr<Gdk::Pixbuf> portrait);
 
   private:
+    static void remove_download (std::string const& fn);
     static Glib::RefPtr<Gdk::Pixbuf> create_from_file (std::string const& fn);
     static void save_to_file (Glib::RefPtr<Gdk::Pixbuf> pixbuf,
         std::string const& fn);
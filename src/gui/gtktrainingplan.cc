@@ -27,6 +27,17 @@
 GtkSkillList::GtkSkillList (void)
 {
   this->total_plan_sp = 0;
+  this->calc_key.valid = false;
+  this->dirty_from = 0;
+  this->tracked_size = 0;
+  this->calc_time = 0;
+  this->active_index = -1;
+  this->active_base_duration = 0;
+  this->active_base_sp = 0;
+  this->active_shift = 0;
+  this->active_sp_shift = 0;
+  this->index_size = 0;
+  this->index_valid = false;
 }
 
 /* ---------------------------------------------------------------- */
@@ -58,11 +69,9 @@ GtkSkillList::append_skill (ApiSkill const* skill, int level, bool objective)
   {
     ApiSkillTreePtr tree = ApiSkillTree::request();
     /* Append dependencies. */
-    for (unsigned int i = 0; i < skill->deps.size(); ++i)
-    {
-      ApiSkill const* s = tree->get_skill_for_id(skill->deps[i].first);
-      this->append_skill(s, skill->deps[i].second, false);
-    }
+    ApiSkillDepList const& deps = tree->get_dependencies(skill);
+    for (std::size_t i = 0; i < deps.size(); ++i)
+      this->append_skill(deps[i].first, deps[i].second, false);
   }
   else
   {
@@ -70,7 +79,13 @@ GtkSkillList::append_skill (ApiSkill const* skill, int level, bool objective)
     this->append_skill(skill, level - 1, false);
   }
 
+  this->update_index();
+  this->mark_dirty(this->size());
   this->push_back(info);
+  this->tracked_size += 1;
+  this->index_size += 1;
+  this->update_index_positions(this->size() - 1);
+  this->add_dependency_refs(info, 1);
 }
 
 /* ---------------------------------------------------------------- */
@@ -104,9 +119,14 @@ GtkSkillList::append_cert (ApiCert const* cert)
 void
 GtkSkillList::move_skill (unsigned int from, unsigned int to)
 {
-  this->insert_skill(to, GtkSkillInfo());
+  /* The index "from" is relative to the list with the new slot. Moving
+   * does not change the dependency reference counts. */
+  this->update_index();
+  this->insert(this->begin() + to, GtkSkillInfo());
   this->at(to) = this->at(from);
-  this->delete_skill(from);
+  this->erase(this->begin() + from);
+  this->mark_dirty(std::min(from, to));
+  this->update_index_positions(std::min(from, to));
 }
 
 /* ---------------------------------------------------------------- */
@@ -114,7 +134,13 @@ GtkSkillList::move_skill (unsigned int from, unsigned int to)
 void
 GtkSkillList::insert_skill (unsigned int pos, GtkSkillInfo const& info)
 {
+  this->update_index();
   this->insert(this->begin() + pos, info);
+  this->mark_dirty(pos);
+  this->tracked_size += 1;
+  this->index_size += 1;
+  this->update_index_positions(pos);
+  this->add_dependency_refs(info, 1);
 }
 
 /* ---------------------------------------------------------------- */
@@ -122,33 +148,79 @@ GtkSkillList::insert_skill (unsigned int pos, GtkSkillInfo const& info)
 void
 GtkSkillList::delete_skill (unsigned int index)
 {
+  this->update_index();
+  GtkSkillInfo const& info = this->at(index);
+  this->add_dependency_refs(info, -1);
+  if (info.plan_level >= 1 && info.plan_level <= 5)
+    this->plan_index[get_dependency_key(info.skill, info.plan_level)] = -1;
+
   this->erase(this->begin() + index);
+  this->mark_dirty(index);
+  this->tracked_size -= 1;
+  this->index_size -= 1;
+  this->update_index_positions(index);
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-GtkSkillList::release_skill (unsigned int index)
+GtkSkillList::release_skill (unsigned int index,
+    std::vector<std::size_t>& removed)
 {
+  removed.clear();
   this->at(index).is_objective = false;
+  if (this->is_dependency(index))
+    return;
 
-  /* Remove dependencies. */
-  bool items_changed = false;
-  do
+  /* Release the entry and cascade to the entries that are
+   * neither objectives nor required by other entries anymore. */
+  std::vector<bool> released(this->size(), false);
+  std::vector<std::size_t> queue(1, index);
+  std::vector<std::size_t> keys;
+  released[index] = true;
+  while (!queue.empty())
   {
-    items_changed = false;
-    /* Go bottom up and remove unneded skills. */
-    for (int i = (int)this->size() - 1; i >= 0; --i)
+    std::size_t pos = queue.back();
+    queue.pop_back();
+
+    keys.clear();
+    this->get_dependency_keys(this->at(pos), keys);
+    for (std::size_t i = 0; i < keys.size(); ++i)
     {
-      GtkSkillInfo& info = this->at(i);
-      if (!info.is_objective && !this->is_dependency(i))
-      {
-        this->delete_skill(i);
-        items_changed = true;
-      }
+      this->dep_refs[keys[i]] -= 1;
+      int dep_pos = this->plan_index[keys[i]];
+      if (this->dep_refs[keys[i]] > 0 || dep_pos < 0
+          || released[dep_pos] || this->at(dep_pos).is_objective)
+        continue;
+
+      released[dep_pos] = true;
+      queue.push_back((std::size_t)dep_pos);
     }
   }
-  while (items_changed);
+
+  /* Remove all released entries in one pass. */
+  std::size_t dest = 0;
+  for (std::size_t i = 0; i < this->size(); ++i)
+  {
+    if (released[i])
+    {
+      removed.push_back(i);
+      GtkSkillInfo const& info = this->at(i);
+      if (info.plan_level >= 1 && info.plan_level <= 5)
+        this->plan_index[get_dependency_key(info.skill, info.plan_level)] = -1;
+      continue;
+    }
+    if (dest != i)
+      this->at(dest) = this->at(i);
+    dest += 1;
+  }
+
+  std::size_t first = removed.front();
+  this->mark_dirty(first);
+  this->resize(dest);
+  this->tracked_size -= removed.size();
+  this->index_size -= removed.size();
+  this->update_index_positions(first);
 }
 
 /* ---------------------------------------------------------------- */
@@ -173,22 +245,95 @@ GtkSkillList::calc_details (ApiCharAttribs& attribs, bool use_active_spph)
 
   int train_skill = -1;
   int train_level = -1;
+  unsigned int train_spph = 0;
   if (this->character->is_training())
   {
     train_skill = this->character->training_info.skill_id;
     train_level = this->character->training_info.to_level;
+    train_spph = this->character->training_spph;
   }
 
+  /* If any input of the calculation changed, everything is recalculated. */
+  GtkSkillCalcKey key;
+  key.valid = true;
+  key.use_active_spph = use_active_spph;
+  key.attribs = attribs;
+  key.sheet_revision = cs->revision;
+  key.train_skill = train_skill;
+  key.train_level = train_level;
+  key.train_spph = train_spph;
+
+  if (!this->calc_key.valid
+      || key.use_active_spph != this->calc_key.use_active_spph
+      || key.attribs != this->calc_key.attribs
+      || key.sheet_revision != this->calc_key.sheet_revision
+      || key.train_skill != this->calc_key.train_skill
+      || key.train_level != this->calc_key.train_level
+      || key.train_spph != this->calc_key.train_spph)
+    this->dirty_from = 0;
+  this->calc_key = key;
+
+  /* The vector has been modified without the bookkeeping. */
+  if (this->size() != this->tracked_size)
+    this->dirty_from = 0;
+
   /* Cached values for time calculations. */
   time_t now = EveTime::get_local_time();
   time_t now_eve = EveTime::get_eve_time();
+
+  /* Entries before the first modified entry are still valid except
+   * the skill in training, which is updated for the new time. */
+  std::size_t first = std::min(this->dirty_from, this->size());
+  if (first > 0)
+    this->calc_time_shift(attribs, now, now_eve);
+  if (this->active_index >= (int)first)
+    this->active_index = -1;
+
+  /* Entries after the skill in training are stored without the shift. */
   time_t duration = 0;
+  unsigned int plan_sp = 0;
+  if (first > 0 && first < this->size())
+  {
+    if ((int)first - 1 == this->active_index)
+    {
+      duration = this->active_base_duration;
+      plan_sp = this->active_base_sp;
+    }
+    else
+    {
+      duration = this->at(first - 1).train_duration;
+      plan_sp = this->at(first - 1).train_sp;
+    }
+  }
+
+  /* The highest level of every skill known by the character and the
+   * highest level available before the current entry. The latter is
+   * seeded with the entries that are not recalculated. */
+  std::vector<int> char_levels;
+  std::vector<int> plan_levels;
+  if (first < this->size())
+  {
+    ApiSkillTreePtr tree = ApiSkillTree::request();
+    char_levels.resize(tree->get_skill_amount(), 0);
+    for (std::size_t i = 0; i < cs->skills.size(); ++i)
+    {
+      ApiSkill const* skill = tree->get_skill_for_id(cs->skills[i].id);
+      if (skill != 0)
+        char_levels[skill->index] = cs->skills[i].level;
+    }
+
+    plan_levels = char_levels;
+    for (std::size_t i = 0; i < first; ++i)
+    {
+      int& level = plan_levels[this->at(i).skill->index];
+      level = std::max(level, this->at(i).plan_level);
+    }
+  }
 
   /* Go through list and do mighty things. Caching the cskill variable
    * will greatly reduce relookup of the charsheet skill. */
   ApiCharSheetSkill* cskill = 0;
-  this->total_plan_sp = 0;
-  for (unsigned int i = 0; i < this->size(); ++i)
+  for (std::size_t i = first; i < this->size(); ++i)
   {
     GtkSkillInfo& info = this->at(i);
     ApiSkill const* skill = info.skill;
@@ -197,138 +342,178 @@ GtkSkillList::calc_details (ApiCharAttribs& attribs, bool use_active_spph)
     if (cskill == 0 || skill->id != cskill->id)
       cskill = cs->get_skill_for_id(skill->id);
 
-    /* Update the skill icon. */
-    if (skill->id == train_skill && info.plan_level == train_level)
-      this->at(i).skill_icon = SKILL_STATUS_TRAINING;
-    else if (this->has_char_skill(skill, info.plan_level))
-      this->at(i).skill_icon = SKILL_STATUS_TRAINED;
-    else if (this->has_char_dep_skills(skill, info.plan_level))
-      this->at(i).skill_icon = SKILL_STATUS_TRAINABLE;
-    else if (this->has_plan_dep_skills(i))
-      this->at(i).skill_icon = SKILL_STATUS_UNTRAINABLE;
-    else
-      this->at(i).skill_icon = SKILL_STATUS_MISSING_DEPS;
-
     /* Cache if the current skill is in training. */
     bool active = (skill->id == train_skill && info.plan_level == train_level);
 
-    /* SP per second and per hour. */
-    unsigned int spph;
-    if (active && use_active_spph)
-      spph = this->character->training_spph;
+    /* Update the skill icon. */
+    if (active)
+      info.skill_icon = SKILL_STATUS_TRAINING;
+    else if (char_levels[skill->index] >= info.plan_level)
+      info.skill_icon = SKILL_STATUS_TRAINED;
+    else if (this->has_dep_levels(skill, info.plan_level, char_levels))
+      info.skill_icon = SKILL_STATUS_TRAINABLE;
+    else if (this->has_dep_levels(skill, info.plan_level, plan_levels))
+      info.skill_icon = SKILL_STATUS_UNTRAINABLE;
     else
-      spph = cs->get_spph_for_skill(skill, attribs);
-    double spps = spph / 3600.0;
+      info.skill_icon = SKILL_STATUS_MISSING_DEPS;
 
-    /* Start SP, dest SP and current SP. */
-    int ssp = cs->calc_start_sp(info.plan_level - 1, skill->rank);
-    int dsp = cs->calc_dest_sp(info.plan_level - 1, skill->rank);
-    int csp = ssp;
+    int& plan_level = plan_levels[skill->index];
+    plan_level = std::max(plan_level, info.plan_level);
 
-    /* Set current SP only if in training or previous char level available. */
-    if (active)
-    {
-      double live_spps = this->character->training_spph / 3600.0;
-      time_t diff_time = this->character->training_info.end_time_t - now_eve;
-      csp = dsp - (int)((double)diff_time * live_spps);
-    }
-    else if (cskill != 0)
+    this->calc_skill(info, cskill, attribs, active, use_active_spph, now_eve);
+
+    duration += info.skill_duration;
+    plan_sp += info.dest_sp - info.start_sp;
+    info.train_duration = duration;
+    info.train_sp = plan_sp;
+
+    if (active && this->active_index < 0)
     {
-      if (cskill->level + 1 == info.plan_level)
-        csp = cskill->points;
-      else if (cskill->level >= info.plan_level)
-        csp = dsp;
+      this->active_index = (int)i;
+      this->active_base_duration = duration;
+      this->active_base_sp = plan_sp;
+      this->active_shift = 0;
+      this->active_sp_shift = 0;
     }
-
-    time_t timediff = (time_t)((double)(dsp - csp) / spps);
-    info.start_sp = csp;
-    info.dest_sp = dsp;
-    info.start_time = now + duration;
-    info.finish_time = now + duration + timediff;
-    info.train_duration = duration + timediff;
-    info.skill_duration = timediff;
-    info.completed = (double)(csp - ssp) / (double)(dsp - ssp);
-    info.spph = spph;
-
-    duration += timediff;
-    this->total_plan_sp += info.dest_sp - info.start_sp;
   }
+
+  this->dirty_from = this->size();
+  this->tracked_size = this->size();
+  this->calc_time = now;
+  this->total_plan_sp = this->empty() ? 0 : this->get_train_sp(this->size() - 1);
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-GtkSkillList::cleanup_skills (void)
+GtkSkillList::calc_skill (GtkSkillInfo& info, ApiCharSheetSkill* cskill,
+    ApiCharAttribs const& attribs, bool active, bool use_active_spph,
+    time_t now_eve)
 {
-  for (int i = (int)this->size() - 1; i >= 0; --i)
-    if (this->has_char_skill(this->at(i).skill, this->at(i).plan_level))
-      this->delete_skill(i);
+  ApiSkill const* skill = info.skill;
+
+  /* SP per second and per hour. */
+  unsigned int spph;
+  if (active && use_active_spph)
+    spph = this->character->training_spph;
+  else
+    spph = this->character->cs->get_spph_for_skill(skill, attribs);
+  double spps = spph / 3600.0;
+
+  /* Start SP, dest SP and current SP. */
+  int ssp = ApiCharSheet::calc_start_sp(info.plan_level - 1, skill->rank);
+  int dsp = ApiCharSheet::calc_dest_sp(info.plan_level - 1, skill->rank);
+  int csp = ssp;
+
+  /* Set current SP only if in training or previous char level available. */
+  if (active)
+  {
+    double live_spps = this->character->training_spph / 3600.0;
+    time_t diff_time = this->character->training_info.end_time_t - now_eve;
+    csp = dsp - (int)((double)diff_time * live_spps);
+  }
+  else if (cskill != 0)
+  {
+    if (cskill->level + 1 == info.plan_level)
+      csp = cskill->points;
+    else if (cskill->level >= info.plan_level)
+      csp = dsp;
+  }
+
+  info.start_sp = csp;
+  info.dest_sp = dsp;
+  info.skill_duration = (time_t)((double)(dsp - csp) / spps);
+  info.completed = (double)(csp - ssp) / (double)(dsp - ssp);
+  info.spph = spph;
 }
 
 /* ---------------------------------------------------------------- */
 
-bool
-GtkSkillList::has_plan_dep_skills (unsigned int index)
+void
+GtkSkillList::calc_time_shift (ApiCharAttribs const& attribs, time_t now,
+    time_t now_eve)
 {
-  ApiSkill const* skill = this->at(index).skill;
-  int plan_level = this->at(index).plan_level;
+  /* All relative times refer to the new time. Only the skill in training
+   * changes, the following entries are shifted by the difference. */
+  this->calc_time = now;
+
+  std::size_t valid = std::min(this->dirty_from, this->size());
+  if (this->active_index < 0 || this->active_index >= (int)valid)
+    return;
+
+  std::size_t index = (std::size_t)this->active_index;
+  GtkSkillInfo& info = this->at(index);
+  ApiCharSheetSkill* cskill
+      = this->character->cs->get_skill_for_id(info.skill->id);
 
-  /* Check for previous level for level > 1. */
-  if (plan_level > 1)
+  this->calc_skill(info, cskill, attribs, true,
+      this->calc_key.use_active_spph, now_eve);
+
+  info.train_duration = info.skill_duration;
+  info.train_sp = info.dest_sp - info.start_sp;
+  if (index > 0)
   {
-    for (int j = (int)index - 1; j >= 0; --j)
-      if (this->at(j).skill == skill
-          && this->at(j).plan_level == plan_level - 1)
-        return true;
-    return false;
+    info.train_duration += this->at(index - 1).train_duration;
+    info.train_sp += this->at(index - 1).train_sp;
   }
 
-  /* Check for skill deps in the list. */
-  for (int i = 0; i < (int)skill->deps.size(); ++i)
+  this->active_shift = info.train_duration - this->active_base_duration;
+  this->active_sp_shift = (int)info.train_sp - (int)this->active_base_sp;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillList::cleanup_skills (std::vector<std::size_t>& removed)
+{
+  removed.clear();
+  this->update_index();
+
+  /* Remove all trained entries in one pass. */
+  std::size_t dest = 0;
+  for (std::size_t i = 0; i < this->size(); ++i)
   {
-    bool has_this_dep = false;
-    for (int j = (int)index - 1; j >= 0 && !has_this_dep; --j)
+    GtkSkillInfo const& info = this->at(i);
+    if (this->has_char_skill(info.skill, info.plan_level))
     {
-      if (this->at(j).skill->id == skill->deps[i].first
-          && this->at(j).plan_level >= skill->deps[i].second)
-        has_this_dep = true;
-
-      if (this->character->cs->get_level_for_skill
-          (skill->deps[i].first) >= skill->deps[i].second)
-        has_this_dep = true;
+      removed.push_back(i);
+      this->add_dependency_refs(info, -1);
+      if (info.plan_level >= 1 && info.plan_level <= 5)
+        this->plan_index[get_dependency_key(info.skill, info.plan_level)] = -1;
+      continue;
     }
-
-    if (!has_this_dep)
-      return false;
+    if (dest != i)
+      this->at(dest) = this->at(i);
+    dest += 1;
   }
 
-  return true;
+  if (removed.empty())
+    return;
+
+  std::size_t first = removed.front();
+  this->mark_dirty(first);
+  this->resize(dest);
+  this->tracked_size -= removed.size();
+  this->index_size -= removed.size();
+  this->update_index_positions(first);
 }
 
 /* ---------------------------------------------------------------- */
 
 bool
-GtkSkillList::has_char_dep_skills (ApiSkill const* skill, int level)
+GtkSkillList::has_dep_levels (ApiSkill const* skill, int level,
+    std::vector<int> const& levels) const
 {
-  int char_level = this->character->cs->get_level_for_skill(skill->id);
-
-  /* Check if previous level of skill is available. */
+  /* Check for the previous level for level > 1. */
   if (level > 1)
-  {
-    if (char_level >= level - 1)
-      return true;
-    else
-      return false;
-  }
+    return levels[skill->index] >= level - 1;
 
-  /* Check if deps are available. */
-  for (unsigned int i = 0; i < skill->deps.size(); ++i)
-  {
-    int dep_level = this->character->cs->get_level_for_skill
-        (skill->deps[i].first);
-    if (dep_level < skill->deps[i].second)
+  /* Check for the skill dependencies. */
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+  ApiSkillDepList const& deps = tree->get_dependencies(skill);
+  for (std::size_t i = 0; i < deps.size(); ++i)
+    if (levels[deps[i].first->index] < deps[i].second)
       return false;
-  }
 
   return true;
 }
@@ -350,16 +535,18 @@ bool
 GtkSkillList::has_plan_skill (ApiSkill const* skill, int level,
     bool make_objective)
 {
-  for (unsigned int i = 0; i < this->size(); ++i)
-    if (this->at(i).skill == skill && this->at(i).plan_level == level)
-    {
-      if (make_objective)
-        this->at(i).is_objective = true;
+  if (level < 1 || level > 5)
+    return false;
 
-      return true;
-    }
+  this->update_index();
+  int pos = this->plan_index[get_dependency_key(skill, level)];
+  if (pos < 0)
+    return false;
 
-  return false;
+  if (make_objective)
+    this->at(pos).is_objective = true;
+
+  return true;
 }
 
 /* ---------------------------------------------------------------- */
@@ -367,24 +554,95 @@ GtkSkillList::has_plan_skill (ApiSkill const* skill, int level,
 bool
 GtkSkillList::is_dependency (unsigned int index)
 {
-  for (unsigned int i = 0; i < this->size(); ++i)
+  this->update_index();
+
+  GtkSkillInfo const& info = this->at(index);
+  if (info.plan_level < 1 || info.plan_level > 5)
+    return false;
+
+  return this->dep_refs[get_dependency_key(info.skill, info.plan_level)] > 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillList::update_index (void)
+{
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+  if (this->index_valid && this->index_size == this->size()
+      && this->dep_refs.size() == tree->get_skill_amount() * 5)
+    return;
+
+  /* The list has been modified without the bookkeeping. */
+  this->plan_index.clear();
+  this->plan_index.resize(tree->get_skill_amount() * 5, -1);
+  this->dep_refs.clear();
+  this->dep_refs.resize(tree->get_skill_amount() * 5, 0);
+  for (std::size_t i = 0; i < this->size(); ++i)
+    this->add_dependency_refs(this->at(i), 1);
+  this->index_size = this->size();
+  this->index_valid = true;
+  this->update_index_positions(0);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillList::update_index_positions (std::size_t begin)
+{
+  /* Entries starting at "begin" have moved. */
+  for (std::size_t i = begin; i < this->size(); ++i)
   {
-    if (i == index)
-      continue;
+    GtkSkillInfo const& info = this->at(i);
+    if (info.plan_level >= 1 && info.plan_level <= 5)
+      this->plan_index[get_dependency_key(info.skill, info.plan_level)]
+          = (int)i;
+  }
+}
 
-    if (this->at(i).skill == this->at(index).skill
-        && this->at(i).plan_level - 1 == this->at(index).plan_level)
-      return true;
+/* ---------------------------------------------------------------- */
 
-    for (unsigned int j = 0; j < this->at(i).skill->deps.size(); ++j)
-    {
-      if (this->at(i).skill->deps[j].first == this->at(index).skill->id
-          && this->at(i).skill->deps[j].second == this->at(index).plan_level)
-        return true;
-    }
+void
+GtkSkillList::add_dependency_refs (GtkSkillInfo const& info, int delta)
+{
+  std::vector<std::size_t> keys;
+  this->get_dependency_keys(info, keys);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    this->dep_refs[keys[i]] += delta;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillList::get_dependency_keys (GtkSkillInfo const& info,
+    std::vector<std::size_t>& keys) const
+{
+  if (info.plan_level > 1 && info.plan_level <= 5)
+  {
+    keys.push_back(get_dependency_key(info.skill, info.plan_level - 1));
+    return;
   }
 
-  return false;
+  if (info.plan_level != 1)
+    return;
+
+  ApiSkillTreePtr tree = ApiSkillTree::request();
+  ApiSkillDepList const& deps = tree->get_dependencies(info.skill);
+  for (std::size_t i = 0; i < deps.size(); ++i)
+    if (deps[i].second >= 1 && deps[i].second <= 5)
+      keys.push_back(get_dependency_key(deps[i].first, deps[i].second));
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkSkillList::add_to_optimizer (AttribOptimizer& optimizer) const
+{
+  for (std::size_t i = 0; i < this->size(); ++i)
+  {
+    GtkSkillInfo const& info = this->at(i);
+    optimizer.add_skill(info.skill, info.dest_sp - info.start_sp);
+  }
 }
 
 /* ---------------------------------------------------------------- */
@@ -392,100 +650,24 @@ GtkSkillList::is_dependency (unsigned int index)
 OptimalData
 GtkSkillList::get_optimal_data (void) const
 {
-  GtkSkillList plan = *this;
-
   /* Fetch the character from the plan. */
   ApiCharSheetPtr charsheet = this->get_character()->cs;
 
-  /* Fetch base and implant attribute points. */
-  ApiCharAttribs base_atts = charsheet->base;
-  ApiCharAttribs implant_atts = charsheet->implant;
-  ApiCharAttribs total_atts = charsheet->total;
-
-    /* Use the current total time and base attributes as base. */
-  ApiCharAttribs cur_base_atts = base_atts;
-  ApiCharAttribs cur_total_atts = total_atts;
-  ApiCharAttribs best_base_atts = base_atts;
-  ApiCharAttribs best_total_atts = total_atts;
-
-    /* Calculate the maximum number of points that can be assigned to each
-   * attribute. */
-  int max_points_per_att = MAXIMUM_VALUE_PER_ATTRIB
-      - MINIMUM_VALUE_PER_ATTRIB;
-
-  /* Calculate the total number of base attribute points to distribute if it
-   * changes in the future. */
-  int total_base_atts = (int)cur_base_atts.cha + (int)cur_base_atts.intl
-      + (int)cur_base_atts.mem + (int)cur_base_atts.per
-      + (int)cur_base_atts.wil - (MINIMUM_VALUE_PER_ATTRIB * 5);
-
-  plan.calc_details(cur_total_atts, false);
-
-  time_t orig_total_time = plan.back().train_duration;
-  time_t cur_total_time = orig_total_time;
-  time_t best_total_time = orig_total_time;
-
-  /* Go through all combinations and compare the runtime.
-   * This algorithm has been found in EVEMon.
-   *
-   * This is O(scary), but seems quick enough in practice.
-   */
-  for (int intl = 0; intl <= max_points_per_att; intl++)
-  {
-    int max_mem = total_base_atts - intl;
-    for (int mem = 0; mem <= max_points_per_att && mem <= max_mem; mem++)
-    {
-      int max_cha = max_mem - mem;
-      for (int cha = 0; cha <= max_points_per_att && cha <= max_cha; cha++)
-      {
-        int max_per = max_cha - cha;
-        for (int per = 0; per <= max_points_per_att && per <= max_per; per++)
-        {
-          int wil = max_per - per;
-          if (wil <= max_points_per_att)
-          {
-            /* Calculate the base attributes based on the current
-             * values. */
-            cur_base_atts.intl = intl + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.mem = mem + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.cha = cha + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.per = per + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.wil = wil + MINIMUM_VALUE_PER_ATTRIB;
-
-            /* Calculate the total attributes based on the
-             * current base attributes and the fetched learning skills
-             * and implants. */
-            cur_total_atts = cur_base_atts + implant_atts;
-
-            ApiCharAttribs cur_total_atts_copy = cur_total_atts;
-            plan.calc_details(cur_total_atts_copy, false);
-            cur_total_time = plan.back().train_duration;
-
-            if (cur_total_time < best_total_time)
-            {
-              best_total_time = cur_total_time;
-              best_base_atts = cur_base_atts;
-              best_total_atts = cur_total_atts;
-            }
-          }
-        }
-      }
-    }
-  }
+  /* The remaining SP of the calculated plan is used as is,
+   * the optimizer only searches the attributes. */
+  AttribOptimizer optimizer;
+  this->add_to_optimizer(optimizer);
+  AttribOptResult best = optimizer.optimize(charsheet->base,
+      charsheet->implant);
 
-  /* Calculate the details for the new list with the best attributes. */
-  {
-    ApiCharAttribs best_total_atts_copy = best_total_atts;
-    plan.calc_details(best_total_atts_copy, false);
-  }
   OptimalData result;
-  result.optimal_time = plan.back().train_duration;
-  result.spph = plan.get_spph();
-  result.intelligence = best_total_atts.intl;
-  result.memory = best_total_atts.mem;
-  result.perception = best_total_atts.per;
-  result.willpower = best_total_atts.wil;
-  result.charisma = best_total_atts.cha;
+  result.optimal_time = best.best_time;
+  result.spph = this->get_total_plan_sp() * 3600.0 / (double)best.best_time;
+  result.intelligence = best.total.intl;
+  result.memory = best.total.mem;
+  result.perception = best.total.per;
+  result.willpower = best.total.wil;
+  result.charisma = best.total.cha;
   return result;
 }
 
@@ -613,7 +795,6 @@ GtkTrainingPlan::GtkTrainingPlan (void)
 
   this->reorder_new_index = -1;
   //this->clean_plan_but.set_label("Clean up");
-  this->currently_editing = -1;
 
   /* Setup treeview. */
   // check this out: http://kevinmehall.net/2010/pygtk_multi_select_drag_drop
@@ -720,10 +901,6 @@ GtkTrainingPlan::GtkTrainingPlan (void)
       (this->viewcols, &GtkColumnsBase::toggle_edit_context));
   this->viewcols.signal_user_notes_changed().connect(sigc::mem_fun
       (this, &GtkTrainingPlan::on_user_notes_edited));
-  this->viewcols.signal_editing_started().connect(sigc::mem_fun
-      (this, &GtkTrainingPlan::on_user_notes_editing));
-  this->viewcols.signal_editing_canceled().connect(sigc::mem_fun
-      (this, &GtkTrainingPlan::on_user_notes_editing_canceled));
   dynamic_cast<Gtk::CellRendererToggle*>(this->viewcols.objective
       .get_first_cell())->signal_toggled().connect(sigc::mem_fun
       (*this, &GtkTrainingPlan::on_objective_toggled));
@@ -731,8 +908,28 @@ GtkTrainingPlan::GtkTrainingPlan (void)
       (*this, &GtkTrainingPlan::on_query_skillview_tooltip));
   this->treeview.set_has_tooltip(true);
 
-  Glib::signal_timeout().connect(sigc::mem_fun(*this,
-      &GtkTrainingPlan::on_update_skill_time), PLANNER_SKILL_TIME_UPDATE);
+  std::vector<Gtk::CellRenderer*> name_cells
+      = this->viewcols.skill_name.get_cells();
+  this->set_cell_data_func(this->viewcols.skill_name,
+      name_cells[0], PLAN_CELL_SKILL_ICON);
+  this->set_cell_data_func(this->viewcols.skill_name,
+      name_cells[1], PLAN_CELL_SKILL_NAME);
+  this->set_cell_data_func(this->viewcols.train_duration,
+      this->viewcols.train_duration.get_first_cell(),
+      PLAN_CELL_TRAIN_DURATION);
+  this->set_cell_data_func(this->viewcols.skill_duration,
+      this->viewcols.skill_duration.get_first_cell(),
+      PLAN_CELL_SKILL_DURATION);
+  this->set_cell_data_func(this->viewcols.completed,
+      this->viewcols.completed.get_first_cell(), PLAN_CELL_COMPLETED);
+  this->set_cell_data_func(this->viewcols.attributes,
+      this->viewcols.attributes.get_first_cell(), PLAN_CELL_ATTRIBUTES);
+  this->set_cell_data_func(this->viewcols.est_start,
+      this->viewcols.est_start.get_first_cell(), PLAN_CELL_EST_START);
+  this->set_cell_data_func(this->viewcols.est_finish,
+      this->viewcols.est_finish.get_first_cell(), PLAN_CELL_EST_FINISH);
+  this->set_cell_data_func(this->viewcols.spph,
+      this->viewcols.spph.get_first_cell(), PLAN_CELL_SPPH);
 
   this->init_from_config();
   this->viewcols.setup_columns_normal();
@@ -818,7 +1015,7 @@ GtkTrainingPlan::append_element (ApiElement const* element, int level)
       break;
   };
 
-  this->update_plan(true);
+  this->update_plan(PLAN_UPDATE_REBUILD);
 }
 
 /* ---------------------------------------------------------------- */
@@ -830,8 +1027,12 @@ GtkTrainingPlan::on_objective_toggled (Glib::ustring const& path)
   unsigned int index = (*iter)[this->cols.skill_index];
   if (this->skills[index].is_objective)
   {
-    this->skills.release_skill(index);
-    this->update_plan(true);
+    std::vector<std::size_t> removed;
+    this->skills.release_skill(index, removed);
+    if (removed.empty())
+      (*iter)[this->cols.objective] = false;
+    this->remove_rows(removed);
+    this->update_plan(PLAN_UPDATE_ROWS);
   }
   else
   {
@@ -847,120 +1048,54 @@ GtkTrainingPlan::on_user_notes_edited (Glib::ustring const& path,
     Glib::ustring const& value)
 {
     //std::cout << "Path " << path << " edited to " << value << std::endl;
-    this->currently_editing = -1;
     int skill_row = Helpers::get_int_from_string(path);
     this->skills[skill_row].user_notes = value;
     Gtk::TreeModel::iterator iter = this->liststore->get_iter(path);
     (*iter)[this->cols.user_notes] = value;
 }
 
-/* ---------------------------------------------------------------- */
-
-void
-GtkTrainingPlan::on_user_notes_editing (Gtk::CellEditable* /*editable*/,
-    Glib::ustring const& path)
-{
-    this->currently_editing = Helpers::get_int_from_string(path);
-}
-
-/* ---------------------------------------------------------------- */
-
-void
-GtkTrainingPlan::on_user_notes_editing_canceled (void)
-{
-    this->currently_editing = -1;
-}
 
 /* ---------------------------------------------------------------- */
 
 double
 GtkSkillList::get_spph (void) const
 {
-  return total_plan_sp * 3600.0 / (double)this->back().train_duration;
+  return total_plan_sp * 3600.0 / (double)this->get_total_plan_time();
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-GtkTrainingPlan::update_plan (bool rebuild)
+GtkTrainingPlan::update_plan (GtkPlanUpdate update)
 {
   if (this->character.get() == 0 || !this->character->cs->valid)
     return;
 
-  this->updating_liststore = true;
   this->skills.calc_details();
 
-  Gtk::ListStore::iterator iter;
-  if (rebuild)
+  if (update == PLAN_UPDATE_REBUILD)
   {
     /* For a complete rebuild the liststore is cleared and repopulated. */
+    this->updating_liststore = true;
     this->liststore->clear();
-  }
-  else
-  {
-    /* Without rebuilding only iteration is done. */
-    iter = this->liststore->children().begin();
-  }
-
-  //std::cout << "Running update with rebuild = " << rebuild << std::endl;
 
-  for (unsigned int i = 0; i < this->skills.size(); ++i)
-  {
-    GtkSkillInfo& info = this->skills[i];
-    ApiSkill const* skill = info.skill;
-
-    if ((int)i == this->currently_editing && !rebuild)
+    for (unsigned int i = 0; i < this->skills.size(); ++i)
     {
-        iter++;
-        continue;
-    }
-
-    /* In rebuild mode rows are created instread of iterated. */
-    if (rebuild)
-    {
-      iter = this->liststore->append();
-
-      Glib::ustring skillname = skill->name;
-      skillname += " " + Helpers::get_roman_from_int(info.plan_level);
-      skillname += "  (" + Helpers::get_string_from_int(skill->rank) + ")";
-
-      Glib::ustring attribs;
-      attribs += ApiSkillTree::get_attrib_short_name(skill->primary);
-      attribs += " / ";
-      attribs += ApiSkillTree::get_attrib_short_name(skill->secondary);
-
-      (*iter)[this->cols.skill] = skill;
+      GtkSkillInfo& info = this->skills[i];
+      Gtk::ListStore::iterator iter = this->liststore->append();
+      (*iter)[this->cols.skill] = info.skill;
       (*iter)[this->cols.skill_index] = i;
-      (*iter)[this->cols.skill_name] = skillname;
       (*iter)[this->cols.objective] = info.is_objective;
-      (*iter)[this->cols.attributes] = attribs;
       (*iter)[this->cols.user_notes] = info.user_notes;
     }
 
-    /* The following cells are always updated. */
-    Glib::ustring completed = Helpers::get_string_from_double
-        (info.completed * 100.0, info.completed == 1.0 ? 0 : 1) + "%";
-
-    (*iter)[this->cols.skill_icon] = ImageStore::skillplan[info.skill_icon];
-    (*iter)[this->cols.completed] = completed;
-    (*iter)[this->cols.spph] = info.spph;
-    (*iter)[this->cols.train_duration]
-        = EveTime::get_string_for_timediff(info.train_duration, false/*true*/);
-    (*iter)[this->cols.skill_duration]
-        = EveTime::get_string_for_timediff(info.skill_duration, true);
-    (*iter)[this->cols.est_start]
-        = EveTime::get_local_time_string(info.start_time, true);
-    (*iter)[this->cols.est_finish]
-        = EveTime::get_local_time_string(info.finish_time, true);
-
-    /* Advance the iterator if store is not rebuild. */
-    if (!rebuild)
-    {
-      iter++;
-    }
+    this->updating_liststore = false;
+  }
+  else
+  {
+    /* Only the rows on screen are formatted again. */
+    this->treeview.queue_draw();
   }
-
-  this->updating_liststore = false;
 
   /* Update the total time label in the GUI. */
   if (this->skills.empty())
@@ -970,13 +1105,19 @@ GtkTrainingPlan::update_plan (bool rebuild)
   }
   else
   {
-    OptimalData optimal_data = this->skills.get_optimal_data();
     this->total_time.set_text(EveTime::get_string_for_timediff
-        (this->skills.back().train_duration, false)
+        (this->skills.get_total_plan_time(), false)
         + "  (" + Helpers::get_string_from_sizet(this->skills.size())
         + " skills, " + Helpers::get_dotted_str_from_uint
           (this->skills.get_total_plan_sp()) + " SP, "
         + Helpers::get_string_from_double(this->skills.get_spph(),0) + " SP/h)");
+  }
+
+  /* The optimal time is updated with the plan, not while the
+   * clock ticks. */
+  if (update != PLAN_UPDATE_TIME && !this->skills.empty())
+  {
+    OptimalData optimal_data = this->skills.get_optimal_data();
     this->optimal_time.set_text(EveTime::get_string_for_timediff
           (optimal_data.optimal_time, false) + " ("
           + Helpers::get_string_from_double(optimal_data.spph,0) + " SP/h, Int: "
@@ -990,6 +1131,45 @@ GtkTrainingPlan::update_plan (bool rebuild)
 
 /* ---------------------------------------------------------------- */
 
+void
+GtkTrainingPlan::update_row_indices (std::size_t first, std::size_t last)
+{
+  Gtk::TreeModel::Children rows = this->liststore->children();
+  if (rows.empty())
+    return;
+
+  last = std::min(last, (std::size_t)rows.size() - 1);
+  if (first > last)
+    return;
+
+  Gtk::ListStore::iterator iter = rows[first];
+  for (std::size_t i = first; i <= last && iter; ++i, ++iter)
+  {
+    unsigned int index = (*iter)[this->cols.skill_index];
+    if (index != i)
+      (*iter)[this->cols.skill_index] = (unsigned int)i;
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkTrainingPlan::remove_rows (std::vector<std::size_t> const& removed)
+{
+  if (removed.empty())
+    return;
+
+  /* The rows are removed from the back to keep the positions valid. */
+  this->updating_liststore = true;
+  for (std::size_t i = removed.size(); i > 0; --i)
+    this->liststore->erase(this->liststore->children()[removed[i - 1]]);
+  this->updating_liststore = false;
+
+  this->update_row_indices(removed.front(), this->skills.size());
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 GtkTrainingPlan::skill_plan_changed (ConfSectionPtr section)
 {
@@ -1021,7 +1201,7 @@ GtkTrainingPlan::load_current_plan (void)
 
   if (this->plan_section.get() == 0)
   {
-    this->update_plan(true);
+    this->update_plan(PLAN_UPDATE_REBUILD);
     return;
   }
 
@@ -1080,7 +1260,8 @@ GtkTrainingPlan::load_current_plan (void)
     this->skills.push_back(info);
   }
 
-  this->update_plan(true);
+  this->skills.invalidate();
+  this->update_plan(PLAN_UPDATE_REBUILD);
 }
 
 /* ---------------------------------------------------------------- */
@@ -1228,8 +1409,10 @@ GtkTrainingPlan::on_delete_skill_plan (void)
 void
 GtkTrainingPlan::on_cleanup_skill_plan (void)
 {
-  this->skills.cleanup_skills();
-  this->update_plan(true);
+  std::vector<std::size_t> removed;
+  this->skills.cleanup_skills(removed);
+  this->remove_rows(removed);
+  this->update_plan(PLAN_UPDATE_ROWS);
 }
 
 /* ---------------------------------------------------------------- */
@@ -1260,11 +1443,15 @@ GtkTrainingPlan::on_row_deleted (Gtk::TreePath const& path)
   if (this->reorder_new_index < 0)
     return;
 
-  /* Pass old and new position and let the skill list do the work. */
-  this->skills.move_skill(path[0], this->reorder_new_index);
+  /* Pass old and new position and let the skill list do the work.
+   * The store already moved the row, only the positions changed. */
+  std::size_t from = (std::size_t)path[0];
+  std::size_t to = (std::size_t)this->reorder_new_index;
+  this->skills.move_skill(from, to);
   this->reorder_new_index = -1;
 
-  this->update_plan(true);
+  this->update_row_indices(std::min(from, to), std::max(from, to));
+  this->update_plan(PLAN_UPDATE_ROWS);
 }
 
 /* ---------------------------------------------------------------- */
@@ -1284,12 +1471,113 @@ GtkTrainingPlan::on_row_activated (Gtk::TreeModel::Path const& path,
 bool
 GtkTrainingPlan::on_update_skill_time (void)
 {
-  this->update_plan(false);
+  this->update_plan(PLAN_UPDATE_TIME);
   return true;
 }
 
 /* ---------------------------------------------------------------- */
 
+void
+GtkTrainingPlan::set_cell_data_func (Gtk::TreeViewColumn& column,
+    Gtk::CellRenderer* cell, GtkPlanCell type)
+{
+  column.clear_attributes(*cell);
+  column.set_cell_data_func(*cell, sigc::bind(sigc::mem_fun
+      (*this, &GtkTrainingPlan::on_cell_data), type));
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkTrainingPlan::on_cell_data (Gtk::CellRenderer* cell,
+    Gtk::TreeModel::iterator const& iter, GtkPlanCell type)
+{
+  /* Rows may be stale while the store is rebuilt or reordered. */
+  unsigned int index = (*iter)[this->cols.skill_index];
+  if (index >= this->skills.size())
+    return;
+
+  GtkSkillInfo const& info = this->skills[index];
+  ApiSkill const* skill = info.skill;
+  Glib::ustring text;
+
+  switch (type)
+  {
+    case PLAN_CELL_SKILL_ICON:
+      ((Gtk::CellRendererPixbuf*)cell)->property_pixbuf()
+          = ImageStore::skillplan[info.skill_icon];
+      return;
+
+    case PLAN_CELL_SKILL_NAME:
+      text = skill->name;
+      text += " " + Helpers::get_roman_from_int(info.plan_level);
+      text += "  (" + Helpers::get_string_from_int(skill->rank) + ")";
+      break;
+
+    case PLAN_CELL_TRAIN_DURATION:
+      text = EveTime::get_string_for_timediff
+          (this->skills.get_train_duration(index), false/*true*/);
+      break;
+
+    case PLAN_CELL_SKILL_DURATION:
+      text = EveTime::get_string_for_timediff(info.skill_duration, true);
+      break;
+
+    case PLAN_CELL_COMPLETED:
+      text = Helpers::get_string_from_double
+          (info.completed * 100.0, info.completed == 1.0 ? 0 : 1) + "%";
+      break;
+
+    case PLAN_CELL_ATTRIBUTES:
+      text += ApiSkillTree::get_attrib_short_name(skill->primary);
+      text += " / ";
+      text += ApiSkillTree::get_attrib_short_name(skill->secondary);
+      break;
+
+    case PLAN_CELL_EST_START:
+      text = EveTime::get_local_time_string
+          (this->skills.get_start_time(index), true);
+      break;
+
+    case PLAN_CELL_EST_FINISH:
+      text = EveTime::get_local_time_string
+          (this->skills.get_finish_time(index), true);
+      break;
+
+    case PLAN_CELL_SPPH:
+      text = Helpers::get_string_from_int(info.spph);
+      break;
+  }
+
+  ((Gtk::CellRendererText*)cell)->property_text() = text;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkTrainingPlan::on_map (void)
+{
+  this->Gtk::Box::on_map();
+
+  /* Catch up with the time passed while hidden. */
+  this->update_time_conn.disconnect();
+  this->update_time_conn = Glib::signal_timeout().connect(sigc::mem_fun
+      (*this, &GtkTrainingPlan::on_update_skill_time),
+      PLANNER_SKILL_TIME_UPDATE);
+  this->update_plan(PLAN_UPDATE_TIME);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GtkTrainingPlan::on_unmap (void)
+{
+  this->Gtk::Box::on_unmap();
+  this->update_time_conn.disconnect();
+}
+
+/* ---------------------------------------------------------------- */
+
 bool
 GtkTrainingPlan::on_query_skillview_tooltip (int x, int y,
     bool /* key */, Glib::RefPtr<Gtk::Tooltip> const& tooltip)
@@ -1413,7 +1701,7 @@ GtkTrainingPlan::on_import_plan (void)
     this->skills.append_skill(plan[i].skill, plan[i].level);
     this->skills.back().user_notes = plan[i].user_notes;
   }
-  this->update_plan(true);
+  this->update_plan(PLAN_UPDATE_REBUILD);
 }
 
 /* ---------------------------------------------------------------- */
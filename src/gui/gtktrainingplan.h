@@ -11,10 +11,13 @@
 #ifndef GTK_TRAINING_PLAN
 #define GTK_TRAINING_PLAN
 
+#include <algorithm>
+
 #include <gtkmm.h>
 
 #include "bits/config.h"
 #include "bits/character.h"
+#include "bits/attriboptimizer.h"
 #include "gtkportrait.h"
 #include "gtkcolumnsbase.h"
 #include "gtkconfwidgets.h"
@@ -31,8 +34,40 @@ enum GtkSkillIcon
   SKILL_STATUS_MISSING_DEPS
 };
 
+/* The plan cells that are formatted when they are rendered. */
+enum GtkPlanCell
+{
+  PLAN_CELL_SKILL_ICON,
+  PLAN_CELL_SKILL_NAME,
+  PLAN_CELL_TRAIN_DURATION,
+  PLAN_CELL_SKILL_DURATION,
+  PLAN_CELL_COMPLETED,
+  PLAN_CELL_ATTRIBUTES,
+  PLAN_CELL_EST_START,
+  PLAN_CELL_EST_FINISH,
+  PLAN_CELL_SPPH
+};
+
+/* What changed since the last update of the plan view. */
+enum GtkPlanUpdate
+{
+  /* Only the clock advanced. */
+  PLAN_UPDATE_TIME,
+  /* The plan changed and the caller updated the affected rows. */
+  PLAN_UPDATE_ROWS,
+  /* The plan changed and all rows are rebuilt. */
+  PLAN_UPDATE_REBUILD
+};
+
 /* ---------------------------------------------------------------- */
 
+/*
+ * The calculated fields are maintained by GtkSkillList::calc_details.
+ * "train_duration" and "train_sp" are prefix sums over the plan, relative
+ * to the time of the last calculation. Entries after the skill in training
+ * are not updated while the clock ticks; use the GtkSkillList getters
+ * for live values of these fields and the start and finish times.
+ */
 struct GtkSkillInfo
 {
   ApiSkill const* skill;
@@ -42,10 +77,9 @@ struct GtkSkillInfo
 
   int start_sp;
   int dest_sp;
+  unsigned int train_sp;
   time_t train_duration;
   time_t skill_duration;
-  time_t finish_time;
-  time_t start_time;
   double completed;
   int spph;
   GtkSkillIcon skill_icon;
@@ -64,14 +98,72 @@ struct OptimalData
   double charisma;
 };
 
+/* The inputs of the last plan calculation. If any of these change,
+ * the whole plan needs to be recalculated. */
+struct GtkSkillCalcKey
+{
+  bool valid;
+  bool use_active_spph;
+  ApiCharAttribs attribs;
+  unsigned int sheet_revision;
+  int train_skill;
+  int train_level;
+  unsigned int train_spph;
+};
+
+/* ---------------------------------------------------------------- */
+
 class GtkSkillList : public std::vector<GtkSkillInfo>
 {
   private:
     CharacterPtr character;
     unsigned int total_plan_sp;
 
+    /* State for incremental calculation. Entries starting at "dirty_from"
+     * need to be recalculated, "tracked_size" is the plan size known to the
+     * bookkeeping. All relative times are based on "calc_time". */
+    GtkSkillCalcKey calc_key;
+    std::size_t dirty_from;
+    std::size_t tracked_size;
+    time_t calc_time;
+
+    /* The skill in training is the only entry that changes while the clock
+     * ticks. Entries after it are shifted by the change of its duration
+     * and SP since the last full calculation of these entries. */
+    int active_index;
+    time_t active_base_duration;
+    unsigned int active_base_sp;
+    time_t active_shift;
+    int active_sp_shift;
+
+    /* Lookup tables per (skill, level): The position of the entry or -1,
+     * and the dependency reference count, i.e. the number of entries that
+     * require the level. An entry requires the previous level of its skill
+     * or, for level 1, the direct skill dependencies. "index_size" is the
+     * plan size known to the tables. */
+    std::vector<int> plan_index;
+    std::vector<int> dep_refs;
+    std::size_t index_size;
+    bool index_valid;
+
   protected:
     void append_skill (ApiSkill const* skill, int level, bool objective);
+    void mark_dirty (std::size_t index);
+    void update_index (void);
+    void update_index_positions (std::size_t begin);
+    void add_dependency_refs (GtkSkillInfo const& info, int delta);
+    void get_dependency_keys (GtkSkillInfo const& info,
+        std::vector<std::size_t>& keys) const;
+    static std::size_t get_dependency_key (ApiSkill const* skill, int level);
+    /* Checks the previous level or the skill dependencies against the
+     * levels per skill index. */
+    bool has_dep_levels (ApiSkill const* skill, int level,
+        std::vector<int> const& levels) const;
+    void calc_skill (GtkSkillInfo& info, ApiCharSheetSkill* cskill,
+        ApiCharAttribs const& attribs, bool active, bool use_active_spph,
+        time_t now_eve);
+    void calc_time_shift (ApiCharAttribs const& attribs, time_t now,
+        time_t now_eve);
 
   public:
     GtkSkillList (void);
@@ -85,27 +177,51 @@ class GtkSkillList : public std::vector<GtkSkillInfo>
     void move_skill (unsigned int from, unsigned int to);
     //void fix_skill (unsigned int index);
     void insert_skill (unsigned int pos, GtkSkillInfo const& info);
-    void release_skill (unsigned int index);
+    /* Releases the objective and removes the entry and the entries it
+     * required if nothing else requires them. The positions of the
+     * removed entries are returned in ascending order. */
+    void release_skill (unsigned int index,
+        std::vector<std::size_t>& removed);
     void delete_skill (unsigned int index);
-    void cleanup_skills (void);
-    bool has_plan_dep_skills (unsigned int index);
-    bool has_char_dep_skills (ApiSkill const* skill, int level);
+    /* Removes the entries the character already trained. The positions
+     * of the removed entries are returned in ascending order. */
+    void cleanup_skills (std::vector<std::size_t>& removed);
     bool has_char_skill (ApiSkill const* skill, int level);
     bool has_plan_skill (ApiSkill const* skill, int level,
         bool make_objective = false);
+    /* Checks if other entries require the entry. This is cheap. */
     bool is_dependency (unsigned int index);
 
-    /* Returns the total SP in the plan. */
+    /* Marks entries starting at "index" for recalculation. This is
+     * required after modifying skills or levels without the methods above,
+     * and also rebuilds the lookup tables on next use. */
+    void invalidate (std::size_t index = 0);
+
+    /* Returns the total SP and training time in the plan. */
     unsigned int get_total_plan_sp (void) const;
+    time_t get_total_plan_time (void) const;
+
+    /* Live values for the entry at "index", see GtkSkillInfo. */
+    time_t get_train_duration (std::size_t index) const;
+    unsigned int get_train_sp (std::size_t index) const;
+    time_t get_start_time (std::size_t index) const;
+    time_t get_finish_time (std::size_t index) const;
 
     /* Calculate all details for the skill plan. If attributes and
      * the learning level are specified, these are used instead
      * of the character ones. "use_active_spph" specifies if the SP/h
-     * for the skill in training is taken from the training sheet. */
+     * for the skill in training is taken from the training sheet.
+     * Only entries starting at the first modified entry are recalculated.
+     * If nothing changed but the clock, only the skill in training is. */
     void calc_details (bool use_active_spph = true);
     void calc_details (ApiCharAttribs& attribs, bool use_active_spph = true);
     //void simulate_select (unsigned int index);
 
+    /* Adds the remaining SP of all skills to the optimizer. The plan
+     * needs to be calculated. The remaining SP does not depend on the
+     * attributes or the SP/h of the skill in training. */
+    void add_to_optimizer (AttribOptimizer& optimizer) const;
+    /* Optimizes the attributes for the calculated plan. */
     OptimalData get_optimal_data (void) const;
 
     double get_spph(void) const;
@@ -141,9 +257,6 @@ class GtkTreeViewColumns : public GtkColumnsBase
   public:
     typedef Glib::SignalProxy2<void, const Glib::ustring&,
         const Glib::ustring&> CellEditedSignal;
-    typedef Glib::SignalProxy2<void, Gtk::CellEditable*,
-        const Glib::ustring&> CellStartEditingSignal;
-    typedef Glib::SignalProxy0<void> CellEditCanceledSignal;
 
   public:
     Gtk::TreeView::Column objective;
@@ -160,8 +273,6 @@ class GtkTreeViewColumns : public GtkColumnsBase
   public:
     GtkTreeViewColumns (Gtk::TreeView* view, GtkTreeModelColumns* cols);
     CellEditedSignal signal_user_notes_changed (void);
-    CellStartEditingSignal signal_editing_started (void);
-    CellEditCanceledSignal signal_editing_canceled (void);
 };
 
 /* ---------------------------------------------------------------- */
@@ -187,18 +298,24 @@ class GtkTrainingPlan : public Gtk::Box
     Gtk::Label total_time;
     Gtk::Label optimal_time;
 
+    /* The rows only refer to the plan entries. All other cells
+     * are formatted from the plan when GTK renders them. */
     GtkTreeModelColumns cols;
     Glib::RefPtr<Gtk::ListStore> liststore;
     Gtk::TreeView treeview;
     GtkTreeViewColumns viewcols;
     bool updating_liststore;
     int reorder_new_index;
-    int currently_editing;
+    /* The skill times are only updated while the plan is visible. */
+    sigc::connection update_time_conn;
 
     sigc::signal<void, ApiSkill const*> sig_skill_activated;
 
   protected:
-    void update_plan (bool rebuild);
+    void update_plan (GtkPlanUpdate update);
+    /* Updates the entry positions of the rows "first" to "last". */
+    void update_row_indices (std::size_t first, std::size_t last);
+    void remove_rows (std::vector<std::size_t> const& removed);
 
     void init_from_config (void);
     void store_to_config (void);
@@ -212,9 +329,6 @@ class GtkTrainingPlan : public Gtk::Box
     void on_objective_toggled (Glib::ustring const& path);
     void on_user_notes_edited (Glib::ustring const& path,
         Glib::ustring const& value);
-    void on_user_notes_editing (Gtk::CellEditable* editable,
-        const Glib::ustring& path);
-    void on_user_notes_editing_canceled (void);
     void on_export_plan (void);
     void on_import_plan (void);
     void on_optimize_att (void);
@@ -225,8 +339,14 @@ class GtkTrainingPlan : public Gtk::Box
     void on_row_activated (Gtk::TreeModel::Path const& path,
         Gtk::TreeViewColumn* column);
     bool on_update_skill_time (void);
+    void set_cell_data_func (Gtk::TreeViewColumn& column,
+        Gtk::CellRenderer* cell, GtkPlanCell type);
+    void on_cell_data (Gtk::CellRenderer* cell,
+        Gtk::TreeModel::iterator const& iter, GtkPlanCell type);
     bool on_query_skillview_tooltip (int x, int y, bool key,
         Glib::RefPtr<Gtk::Tooltip> const& tooltip);
+    void on_map (void);
+    void on_unmap (void);
 
   public:
     GtkTrainingPlan (void);
@@ -245,6 +365,7 @@ inline void
 GtkSkillList::set_character (CharacterPtr character)
 {
   this->character = character;
+  this->calc_key.valid = false;
 }
 
 inline CharacterPtr
@@ -265,23 +386,65 @@ GtkSkillList::get_total_plan_sp (void) const
   return this->total_plan_sp;
 }
 
-inline GtkTreeViewColumns::CellEditedSignal
-GtkTreeViewColumns::signal_user_notes_changed (void)
+inline time_t
+GtkSkillList::get_total_plan_time (void) const
 {
-  return ((Gtk::CellRendererText*)this->user_notes
-      .get_first_cell())->signal_edited();
+  return this->empty() ? 0 : this->get_train_duration(this->size() - 1);
+}
+
+inline void
+GtkSkillList::mark_dirty (std::size_t index)
+{
+  this->dirty_from = std::min(this->dirty_from, index);
+}
+
+inline void
+GtkSkillList::invalidate (std::size_t index)
+{
+  this->mark_dirty(index);
+  this->index_valid = false;
+}
+
+inline std::size_t
+GtkSkillList::get_dependency_key (ApiSkill const* skill, int level)
+{
+  return (std::size_t)skill->index * 5 + (std::size_t)(level - 1);
+}
+
+inline time_t
+GtkSkillList::get_train_duration (std::size_t index) const
+{
+  if (this->active_index >= 0 && index > (std::size_t)this->active_index)
+    return this->at(index).train_duration + this->active_shift;
+  return this->at(index).train_duration;
 }
 
-inline GtkTreeViewColumns::CellStartEditingSignal
-GtkTreeViewColumns::signal_editing_started (void)
+inline unsigned int
+GtkSkillList::get_train_sp (std::size_t index) const
+{
+  if (this->active_index >= 0 && index > (std::size_t)this->active_index)
+    return this->at(index).train_sp + this->active_sp_shift;
+  return this->at(index).train_sp;
+}
+
+inline time_t
+GtkSkillList::get_start_time (std::size_t index) const
 {
-  return this->user_notes.get_first_cell()->signal_editing_started();
+  return this->calc_time + this->get_train_duration(index)
+      - this->at(index).skill_duration;
 }
 
-inline GtkTreeViewColumns::CellEditCanceledSignal
-GtkTreeViewColumns::signal_editing_canceled (void)
+inline time_t
+GtkSkillList::get_finish_time (std::size_t index) const
 {
-  return this->user_notes.get_first_cell()->signal_editing_canceled();
+  return this->calc_time + this->get_train_duration(index);
+}
+
+inline GtkTreeViewColumns::CellEditedSignal
+GtkTreeViewColumns::signal_user_notes_changed (void)
+{
+  return ((Gtk::CellRendererText*)this->user_notes
+      .get_first_cell())->signal_edited();
 }
 
 inline sigc::signal<void, ApiSkill const*>&
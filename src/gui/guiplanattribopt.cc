@@ -20,6 +20,7 @@
 GtkTreeModelColumnsOptimizer::GtkTreeModelColumnsOptimizer (void)
 {
   this->add(this->difference);
+  this->add(this->stop_here);
 }
 
 /* ---------------------------------------------------------------- */
@@ -27,9 +28,11 @@ GtkTreeModelColumnsOptimizer::GtkTreeModelColumnsOptimizer (void)
 GtkTreeViewColumnsOptimizer::GtkTreeViewColumnsOptimizer(Gtk::TreeView* view,
     GtkTreeModelColumnsOptimizer* cols)
   : GtkTreeViewColumns(view, cols),
-    difference("Difference", cols->difference)
+    difference("Difference", cols->difference),
+    stop_here("Best remap if you stop here", cols->stop_here)
 {
   this->append_column(&this->difference, GtkColumnOptions(true, true, true));
+  this->append_column(&this->stop_here, GtkColumnOptions(true, true, true));
 }
 
 /* ---------------------------------------------------------------- */
@@ -40,6 +43,7 @@ GuiPlanAttribOpt::GuiPlanAttribOpt (void)
     viewcols(&treeview, &cols)
 {
   this->plan_offset = 0;
+  this->optimizer_job = 0;
 
   Gtk::Widget* config_page = this->create_config_page();
   Gtk::Widget* attrib_page = this->create_attrib_page();
@@ -73,6 +77,15 @@ GuiPlanAttribOpt::GuiPlanAttribOpt (void)
 
 /* ---------------------------------------------------------------- */
 
+GuiPlanAttribOpt::~GuiPlanAttribOpt (void)
+{
+  /* The job cleans up itself once the workers noticed the cancelation. */
+  if (this->optimizer_job != 0)
+    this->optimizer_job->cancel();
+}
+
+/* ---------------------------------------------------------------- */
+
 Gtk::Widget*
 GuiPlanAttribOpt::create_config_page (void)
 {
@@ -81,7 +94,8 @@ GuiPlanAttribOpt::create_config_page (void)
   info_image->set_from_icon_name("dialog-question", Gtk::ICON_SIZE_DIALOG);
   Gtk::Label* info_label = MK_LABEL("Do you want to optimize the whole plan?\n"
       "Please select whether you want to optimize\n"
-      "the whole skill plan or just a part of it.");
+      "the whole skill plan, just a part of it or\n"
+      "the whole plan with remaps along the way.");
   info_label->set_line_wrap(true);
   info_label->set_justify(Gtk::JUSTIFY_LEFT);
   info_label->set_halign(Gtk::ALIGN_START);
@@ -95,26 +109,50 @@ GuiPlanAttribOpt::create_config_page (void)
   /* Create the config widgets. */
   this->rb_whole_plan.set_label("Optimize the whole plan");
   this->rb_partial_plan.set_label("Optimize plan starting with skill");
+  this->rb_remap_plan.set_label("Optimize the whole plan with remaps");
   Gtk::RadioButtonGroup rbg;
   this->rb_whole_plan.set_group(rbg);
   this->rb_partial_plan.set_group(rbg);
+  this->rb_remap_plan.set_group(rbg);
+
+  /* The amount of remaps includes the first one, which is placed
+   * before the plan or deferred until the yearly remap is available. */
+  this->remap_amount.set_range(2, 10);
+  this->remap_amount.set_increments(1, 1);
+  this->remap_amount.set_value(3);
   this->set_selection_sensitivity(false);
 
+  Gtk::Box* remap_box = MK_HBOX(5);
+  remap_box->pack_start(*MK_LABEL("Maximum remaps:"), false, false, 0);
+  remap_box->pack_start(this->remap_amount, false, false, 0);
+  remap_box->pack_start(this->bonus_remaps_label, false, false, 0);
+
   /* Create a table and add the widgets to it. */
   Gtk::Box* dialog_vbox = MK_VBOX(5);
   dialog_vbox->pack_start(this->rb_whole_plan, false, false, 0);
   dialog_vbox->pack_start(this->rb_partial_plan, false, false, 0);
   dialog_vbox->pack_start(this->skill_selection, false, false, 0);
+  dialog_vbox->pack_start(this->rb_remap_plan, false, false, 0);
+  dialog_vbox->pack_start(*remap_box, false, false, 0);
 
   /* Create the button for the next page. */
-  Gtk::Button* calculate_but = MK_BUT0;
-  calculate_but->set_image_from_icon_name("media-playback-start",
+  this->calculate_but.set_image_from_icon_name("media-playback-start",
       Gtk::ICON_SIZE_BUTTON);
-  calculate_but->set_label("Optimize attributes");
+  this->calculate_but.set_label("Optimize attributes");
+
+  /* The progress is only visible while calculating. */
+  this->cancel_but.set_image_from_icon_name("process-stop",
+      Gtk::ICON_SIZE_BUTTON);
+  this->cancel_but.set_label("Cancel");
+  this->cancel_but.set_no_show_all(true);
+  this->progressbar.set_show_text(true);
+  this->progressbar.set_no_show_all(true);
 
   /* The button box. */
   Gtk::Box* button_box = MK_HBOX(5);
-  button_box->pack_end(*calculate_but, false, false, 0);
+  button_box->pack_start(this->progressbar, true, true, 0);
+  button_box->pack_end(this->calculate_but, false, false, 0);
+  button_box->pack_end(this->cancel_but, false, false, 0);
 
   /* The main box. */
   Gtk::Box* main_box = MK_VBOX(5);
@@ -129,8 +167,12 @@ GuiPlanAttribOpt::create_config_page (void)
       (*this, &GuiPlanAttribOpt::set_selection_sensitivity), false));
   this->rb_partial_plan.signal_clicked().connect(sigc::bind(sigc::mem_fun
       (*this, &GuiPlanAttribOpt::set_selection_sensitivity), true));
-  calculate_but->signal_clicked().connect(sigc::mem_fun
+  this->rb_remap_plan.signal_clicked().connect(sigc::bind(sigc::mem_fun
+      (*this, &GuiPlanAttribOpt::set_selection_sensitivity), false));
+  this->calculate_but.signal_clicked().connect(sigc::mem_fun
       (*this, &GuiPlanAttribOpt::on_calculate_clicked));
+  this->cancel_but.signal_clicked().connect(sigc::mem_fun
+      (*this, &GuiPlanAttribOpt::on_cancel_clicked));
 
   return main_box;
 }
@@ -151,6 +193,7 @@ GuiPlanAttribOpt::create_attrib_page (void)
   Gtk::Label* best_time_name_label = MK_LABEL("Best time:");
   Gtk::Label* original_time_name_label = MK_LABEL("Original time:");
   Gtk::Label* difference_time_name_label = MK_LABEL("Improvement:");
+  Gtk::Label* remaps_name_label = MK_LABEL("Remaps:");
 
   /* Create info and warning box. */
   Gtk::Image* info_image = MK_IMG0;
@@ -208,10 +251,12 @@ GuiPlanAttribOpt::create_attrib_page (void)
   best_time_name_label->set_halign(Gtk::ALIGN_START);
   original_time_name_label->set_halign(Gtk::ALIGN_START);
   difference_time_name_label->set_halign(Gtk::ALIGN_START);
+  remaps_name_label->set_halign(Gtk::ALIGN_START);
 
   this->best_time_label.set_halign(Gtk::ALIGN_END);
   this->original_time_label.set_halign(Gtk::ALIGN_END);
   this->difference_time_label.set_halign(Gtk::ALIGN_END);
+  this->remaps_label.set_halign(Gtk::ALIGN_END);
 
   /* Configure the table and add fill it with content. */
   Gtk::Label* base_attr_label = MK_LABEL("Base");
@@ -219,7 +264,7 @@ GuiPlanAttribOpt::create_attrib_page (void)
   Gtk::Label* total_attr_label = MK_LABEL("Total");
   total_attr_label->set_halign(Gtk::ALIGN_END);
 
-  Gtk::Table* attribute_table = MK_TABLE(9, 3);
+  Gtk::Table* attribute_table = MK_TABLE(10, 3);
   attribute_table->set_col_spacings(10);
   attribute_table->set_row_spacing(5, 10);
 
@@ -247,6 +292,8 @@ GuiPlanAttribOpt::create_attrib_page (void)
   attribute_table->attach(this->best_time_label, 1, 3, 7, 8, Gtk::FILL);
   attribute_table->attach(*difference_time_name_label, 0, 1, 8, 9, Gtk::FILL);
   attribute_table->attach(this->difference_time_label, 1, 3, 8, 9, Gtk::FILL);
+  attribute_table->attach(*remaps_name_label, 0, 1, 9, 10, Gtk::FILL);
+  attribute_table->attach(this->remaps_label, 1, 3, 9, 10, Gtk::FILL);
 
   /* Configure some buttons. */
   Gtk::Button* view_plan_but = MK_BUT0;
@@ -298,6 +345,7 @@ void
 GuiPlanAttribOpt::set_plan (GtkSkillList const& plan)
 {
   this->plan = plan;
+  this->suffix_results.clear();
 
   /* Fill the skill selection. */
   for (unsigned int i = 0; i < this->plan.size(); i++)
@@ -308,6 +356,9 @@ GuiPlanAttribOpt::set_plan (GtkSkillList const& plan)
     this->skill_selection.append(skillname);
   }
   this->skill_selection.set_active(0);
+
+  this->bonus_remaps_label.set_text("(" + Helpers::get_string_from_uint
+      (this->plan.get_character()->cs->free_respecs) + " bonus available)");
 }
 
 /* ---------------------------------------------------------------- */
@@ -315,7 +366,6 @@ GuiPlanAttribOpt::set_plan (GtkSkillList const& plan)
 void
 GuiPlanAttribOpt::on_calculate_clicked (void)
 {
-  this->notebook.set_current_page(1);
   if (this->rb_partial_plan.get_active())
   {
     this->plan_offset = this->skill_selection.get_active_row_number();
@@ -324,7 +374,13 @@ GuiPlanAttribOpt::on_calculate_clicked (void)
   {
     this->plan_offset = 0;
   }
-  this->optimize_plan();
+
+  if (this->rb_remap_plan.get_active())
+    this->optimize_remaps();
+  else if (this->rb_partial_plan.get_active())
+    this->optimize_partial_plan();
+  else
+    this->optimize_plan();
 }
 
 /* ---------------------------------------------------------------- */
@@ -333,112 +389,218 @@ void
 GuiPlanAttribOpt::set_selection_sensitivity (bool sensitive)
 {
   this->skill_selection.set_sensitive(sensitive);
+  this->remap_amount.set_sensitive(this->rb_remap_plan.get_active());
 }
 
 /* ---------------------------------------------------------------- */
 
 void
-GuiPlanAttribOpt::optimize_plan (void)
+GuiPlanAttribOpt::on_cancel_clicked (void)
+{
+  if (this->optimizer_job == 0)
+    return;
+
+  this->optimizer_job->cancel();
+  this->optimizer_job = 0;
+  this->set_calculating(false);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::set_calculating (bool calculating)
+{
+  this->calculate_but.set_sensitive(!calculating);
+  this->rb_whole_plan.set_sensitive(!calculating);
+  this->rb_partial_plan.set_sensitive(!calculating);
+  this->rb_remap_plan.set_sensitive(!calculating);
+  this->skill_selection.set_sensitive(!calculating
+      && this->rb_partial_plan.get_active());
+  this->remap_amount.set_sensitive(!calculating
+      && this->rb_remap_plan.get_active());
+
+  if (calculating)
+  {
+    this->progressbar.set_fraction(0.0);
+    this->progressbar.set_text("0%");
+    this->progressbar.show();
+    this->cancel_but.show();
+  }
+  else
+  {
+    this->progressbar.hide();
+    this->cancel_but.hide();
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+GtkSkillList
+GuiPlanAttribOpt::get_plan_part (void) const
 {
   /* Copy the original plan because it may be altered later. */
   GtkSkillList plan_part = this->plan;
+  if (this->plan_offset > 0)
+  {
+    plan_part.erase(plan_part.begin(), plan_part.begin() + this->plan_offset);
+    plan_part.invalidate();
+  }
+
+  return plan_part;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::optimize_plan (void)
+{
+  if (this->optimizer_job != 0)
+    return;
 
   /* Fetch the character from the plan. */
   ApiCharSheetPtr charsheet = this->plan.get_character()->cs;
 
-  /* Fetch base and implant attribute points. */
-  ApiCharAttribs base_atts = charsheet->base;
-  ApiCharAttribs implant_atts = charsheet->implant;
+  /* Calculate the plan with the original attribues. */
+  GtkSkillList plan_orig = this->get_plan_part();
   ApiCharAttribs total_atts = charsheet->total;
+  plan_orig.calc_details(total_atts, false);
+
+  /* The remaining SP of the skills does not depend on the attributes.
+   * Let the optimizer search all attribute combinations on them in the
+   * background, the result is delivered to on_optimize_done(). */
+  AttribOptimizer optimizer;
+  plan_orig.add_to_optimizer(optimizer);
+
+  this->optimizer_job = AsyncAttribOpt::create(optimizer,
+      charsheet->base, charsheet->implant);
+  this->optimizer_job->signal_progress().connect(sigc::mem_fun
+      (*this, &GuiPlanAttribOpt::on_optimize_progress));
+  this->optimizer_job->signal_done().connect(sigc::mem_fun
+      (*this, &GuiPlanAttribOpt::on_optimize_done));
+
+  this->set_calculating(true);
+  this->optimizer_job->start();
+}
 
-  if (this->plan_offset > 0)
-    plan_part.erase(plan_part.begin(), plan_part.begin() + this->plan_offset);
+/* ---------------------------------------------------------------- */
 
-  /* Copy the possibly cleaned plan to have an original one for comparison. */
-  GtkSkillList plan_orig = plan_part;
+void
+GuiPlanAttribOpt::on_optimize_progress (double fraction)
+{
+  this->progressbar.set_fraction(fraction);
+  this->progressbar.set_text(Helpers::get_string_from_double
+      (fraction * 100.0, 0) + "%");
+}
 
-  /* Use the current total time and base attributes as base. */
-  ApiCharAttribs cur_base_atts = base_atts;
-  ApiCharAttribs cur_total_atts = total_atts;
-  ApiCharAttribs best_base_atts = base_atts;
-  ApiCharAttribs best_total_atts = total_atts;
-
-  /* Calculate the original plan with the original attribues. */
-  plan_orig.calc_details(cur_total_atts, false);
-  cur_total_atts = total_atts;
-
-  time_t orig_total_time = plan_orig.back().train_duration;
-  time_t cur_total_time = orig_total_time;
-  time_t best_total_time = orig_total_time;
-
-  /* Calculate the maximum number of points that can be assigned to each
-   * attribute. */
-  int max_points_per_att = MAXIMUM_VALUE_PER_ATTRIB
-      - MINIMUM_VALUE_PER_ATTRIB;
-
-  /* Calculate the total number of base attribute points to distribute if it
-   * changes in the future. */
-  int total_base_atts = (int)cur_base_atts.cha + (int)cur_base_atts.intl
-      + (int)cur_base_atts.mem + (int)cur_base_atts.per
-      + (int)cur_base_atts.wil - (MINIMUM_VALUE_PER_ATTRIB * 5);
-
-
-  /* Go through all combinations and compare the runtime.
-   * This algorithm has been found in EVEMon.
-   *
-   * This is O(scary), but seems quick enough in practice.
-   */
-  for (int intl = 0; intl <= max_points_per_att; intl++)
-  {
-    int max_mem = total_base_atts - intl;
-    for (int mem = 0; mem <= max_points_per_att && mem <= max_mem; mem++)
-    {
-      int max_cha = max_mem - mem;
-      for (int cha = 0; cha <= max_points_per_att && cha <= max_cha; cha++)
-      {
-        int max_per = max_cha - cha;
-        for (int per = 0; per <= max_points_per_att && per <= max_per; per++)
-        {
-          int wil = max_per - per;
-          if (wil <= max_points_per_att)
-          {
-            /* Calculate the base attributes based on the current
-             * values. */
-            cur_base_atts.intl = intl + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.mem = mem + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.cha = cha + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.per = per + MINIMUM_VALUE_PER_ATTRIB;
-            cur_base_atts.wil = wil + MINIMUM_VALUE_PER_ATTRIB;
-
-            /* Calculate the total attributes based on the
-             * current base attributes and the fetched learning skills
-             * and implants. */
-            cur_total_atts = cur_base_atts + implant_atts;
-
-            ApiCharAttribs cur_total_atts_copy = cur_total_atts;
-            plan_part.calc_details(cur_total_atts_copy, false);
-            cur_total_time = plan_part.back().train_duration;
-
-            if (cur_total_time < best_total_time)
-            {
-              best_total_time = cur_total_time;
-              best_base_atts = cur_base_atts;
-              best_total_atts = cur_total_atts;
-            }
-          }
-        }
-      }
-    }
-  }
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::on_optimize_done (AttribOptResult best)
+{
+  /* The job deletes itself after delivering the result. */
+  this->optimizer_job = 0;
+  this->set_calculating(false);
+  this->show_result(best);
+}
+
+/* ---------------------------------------------------------------- */
 
-  /* Calculate the details for the new list with the best attributes. */
+void
+GuiPlanAttribOpt::show_result (AttribOptResult const& best)
+{
+  AttribRemapPoint remap;
+  remap.position = 0;
+  remap.base = best.base;
+  remap.total = best.total;
+  remap.duration = best.best_time;
+  remap.bonus = false;
+  remap.remap = true;
+
+  AttribRemapResult result;
+  result.remaps.push_back(remap);
+  result.orig_time = best.orig_time;
+  result.best_time = best.best_time;
+  this->show_result(result, false);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::optimize_partial_plan (void)
+{
+  /* The optimum for all possible starting skills is calculated in a
+   * single pass, selecting another skill later is instant. */
+  if (this->suffix_results.empty())
   {
-    ApiCharAttribs best_total_atts_copy = best_total_atts;
-    plan_part.calc_details(best_total_atts_copy, false);
+    ApiCharSheetPtr charsheet = this->plan.get_character()->cs;
+
+    GtkSkillList plan_orig = this->plan;
+    ApiCharAttribs total_atts = charsheet->total;
+    plan_orig.calc_details(total_atts, false);
+
+    AttribOptimizer optimizer;
+    plan_orig.add_to_optimizer(optimizer);
+    optimizer.optimize_suffixes(charsheet->base, charsheet->implant,
+        this->suffix_results);
   }
 
+  if (this->plan_offset >= this->suffix_results.size())
+    return;
+
+  this->show_result(this->suffix_results[this->plan_offset]);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::optimize_remaps (void)
+{
+  ApiCharSheetPtr charsheet = this->plan.get_character()->cs;
+
+  GtkSkillList plan_orig = this->get_plan_part();
+  ApiCharAttribs total_atts = charsheet->total;
+  plan_orig.calc_details(total_atts, false);
+
+  /* The search over all remap points works on SP aggregates per plan
+   * block and is fast enough to run without a worker thread. */
+  AttribOptimizer optimizer;
+  plan_orig.add_to_optimizer(optimizer);
+
+  /* Without a known timed remap, the yearly remap is available. */
+  time_t since_remap = REMAP_INTERVAL;
+  time_t last_remap = EveTime::get_time_for_string
+      (charsheet->last_timed_respec);
+  if (last_remap > 0)
+    since_remap = EveTime::get_eve_time() - last_remap;
+
+  AttribRemapResult result = optimizer.optimize_remaps(charsheet->base,
+      charsheet->implant, (unsigned int)this->remap_amount.get_value_as_int(),
+      charsheet->free_respecs, since_remap);
+
+  this->show_result(result, true);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+GuiPlanAttribOpt::show_result (AttribRemapResult const& result,
+    bool remap_rows)
+{
+  this->notebook.set_current_page(1);
+
+  /* Calculate the original plan again for the breakdown comparison. */
+  ApiCharAttribs total_atts = this->plan.get_character()->cs->total;
+  GtkSkillList plan_part = this->get_plan_part();
+  GtkSkillList plan_orig = plan_part;
+  plan_orig.calc_details(total_atts, false);
+
+  time_t orig_total_time = result.orig_time;
+  time_t best_total_time = result.best_time;
+  ApiCharAttribs best_base_atts = result.remaps[0].base;
+  ApiCharAttribs best_total_atts = result.remaps[0].total;
+
   /* Warn the user if the optimized time is below one year. */
-  if (best_total_time < (365 * 24 * 60 * 60))
+  if (!remap_rows && best_total_time < (365 * 24 * 60 * 60))
     this->warning_box.show();
   else
     this->warning_box.hide();
@@ -473,37 +635,102 @@ GuiPlanAttribOpt::optimize_plan (void)
   difference_time_label.set_text(EveTime::get_string_for_timediff
       (orig_total_time - best_total_time, false));
 
+  /* Summarize the remaps, the first one is shown above. */
+  unsigned int remaps = 0;
+  unsigned int bonus_remaps = 0;
+  for (std::size_t i = 0; i < result.remaps.size(); ++i)
+  {
+    if (result.remaps[i].remap)
+      remaps += 1;
+    if (result.remaps[i].bonus)
+      bonus_remaps += 1;
+  }
+  Glib::ustring remaps_str = Helpers::get_string_from_uint(remaps);
+  if (bonus_remaps > 0)
+    remaps_str += " (" + Helpers::get_string_from_uint(bonus_remaps)
+        + " bonus)";
+  this->remaps_label.set_text(remaps_str);
+
+  /* The best attributes if the plan would end with a certain skill. */
+  std::vector<AttribOptResult> prefix_results;
+  {
+    AttribOptimizer optimizer;
+    plan_orig.add_to_optimizer(optimizer);
+    optimizer.optimize_prefixes(this->plan.get_character()->cs->base,
+        this->plan.get_character()->cs->implant, prefix_results);
+  }
+
   /* Fill the skill list with data. Comment out those that aren't needed. */
   this->liststore->clear();
-  for (unsigned int i = 0; i < plan_part.size(); ++i)
+  for (std::size_t r = 0; r < result.remaps.size(); ++r)
   {
-    GtkSkillInfo& info = plan_part[i];
-    ApiSkill const* skill = info.skill;
+    AttribRemapPoint const& remap = result.remaps[r];
+    std::size_t end = (r + 1 < result.remaps.size()
+        ? result.remaps[r + 1].position : plan_part.size());
 
-    Gtk::ListStore::iterator iter = this->liststore->append();
+    /* The skills between two remaps are trained with their attributes. */
+    GtkSkillList plan_remap = plan_part;
+    ApiCharAttribs remap_atts = remap.total;
+    plan_remap.calc_details(remap_atts, false);
 
-    Glib::ustring skillname = skill->name;
-    skillname += " " + Helpers::get_roman_from_int(info.plan_level);
-    skillname += "  (" + Helpers::get_string_from_int(skill->rank) + ")";
-
-    (*iter)[this->cols.skill_index] = i;
-    (*iter)[this->cols.skill_name] = skillname;
-    (*iter)[this->cols.skill_icon] = ImageStore::skillplan[info.skill_icon];
-    (*iter)[this->cols.skill_duration]
-        = EveTime::get_string_for_timediff(info.skill_duration, true);
-
-    /* Calculate the duration difference between the
-     * old attributes and the optimized ones. */
-    time_t difference = info.skill_duration - plan_orig[i].skill_duration;
-    if (difference < 0)
+    if (remap_rows)
     {
-      (*iter)[this->cols.difference]
-          = "- " + EveTime::get_string_for_timediff(-difference, true);
+      Glib::ustring remapname = (remap.remap ? "Remap to " : "Keep ")
+          + Helpers::get_string_from_double(remap.base.intl, 0) + " Int, "
+          + Helpers::get_string_from_double(remap.base.mem, 0) + " Mem, "
+          + Helpers::get_string_from_double(remap.base.cha, 0) + " Cha, "
+          + Helpers::get_string_from_double(remap.base.per, 0) + " Per, "
+          + Helpers::get_string_from_double(remap.base.wil, 0) + " Wil";
+      if (remap.bonus)
+        remapname += " (bonus remap)";
+
+      Gtk::ListStore::iterator iter = this->liststore->append();
+      (*iter)[this->cols.skill_index] = (unsigned int)remap.position;
+      (*iter)[this->cols.skill_name] = remapname;
+      (*iter)[this->cols.skill_duration]
+          = EveTime::get_string_for_timediff(remap.duration, true);
     }
-    else
+
+    for (std::size_t i = remap.position; i < end; ++i)
     {
-      (*iter)[this->cols.difference]
-          = "+ " + EveTime::get_string_for_timediff(difference, true);
+      GtkSkillInfo& info = plan_remap[i];
+      ApiSkill const* skill = info.skill;
+
+      Gtk::ListStore::iterator iter = this->liststore->append();
+
+      Glib::ustring skillname = skill->name;
+      skillname += " " + Helpers::get_roman_from_int(info.plan_level);
+      skillname += "  (" + Helpers::get_string_from_int(skill->rank) + ")";
+
+      (*iter)[this->cols.skill_index] = (unsigned int)i;
+      (*iter)[this->cols.skill_name] = skillname;
+      (*iter)[this->cols.skill_icon] = ImageStore::skillplan[info.skill_icon];
+      (*iter)[this->cols.skill_duration]
+          = EveTime::get_string_for_timediff(info.skill_duration, true);
+
+      /* Calculate the duration difference between the
+       * old attributes and the optimized ones. */
+      time_t difference = info.skill_duration - plan_orig[i].skill_duration;
+      if (difference < 0)
+      {
+        (*iter)[this->cols.difference]
+            = "- " + EveTime::get_string_for_timediff(-difference, true);
+      }
+      else
+      {
+        (*iter)[this->cols.difference]
+            = "+ " + EveTime::get_string_for_timediff(difference, true);
+      }
+
+      AttribOptResult const& stop = prefix_results[i];
+      (*iter)[this->cols.stop_here] = "I"
+          + Helpers::get_string_from_double(stop.base.intl, 0) + " M"
+          + Helpers::get_string_from_double(stop.base.mem, 0) + " C"
+          + Helpers::get_string_from_double(stop.base.cha, 0) + " P"
+          + Helpers::get_string_from_double(stop.base.per, 0) + " W"
+          + Helpers::get_string_from_double(stop.base.wil, 0) + "  (- "
+          + EveTime::get_string_for_timediff
+          (stop.orig_time - stop.best_time, true) + ")";
     }
   }
 }
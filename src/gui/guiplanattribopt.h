@@ -13,18 +13,16 @@
 
 #include <gtkmm.h>
 
+#include "bits/attriboptimizer.h"
+#include "bits/asyncattribopt.h"
 #include "winbase.h"
 #include "gtktrainingplan.h"
 
-/* The minimum number of points that have to be assigned to each attribute. */
-#define MINIMUM_VALUE_PER_ATTRIB 17
-/* The maximum number of points that can be assigned to each attribute. */
-#define MAXIMUM_VALUE_PER_ATTRIB 27
-
 class GtkTreeModelColumnsOptimizer : public GtkTreeModelColumns
 {
   public:
     Gtk::TreeModelColumn<Glib::ustring> difference;
+    Gtk::TreeModelColumn<Glib::ustring> stop_here;
 
     GtkTreeModelColumnsOptimizer(void);
 };
@@ -35,6 +33,7 @@ class GtkTreeViewColumnsOptimizer : public GtkTreeViewColumns
 {
   public:
     Gtk::TreeView::Column difference;
+    Gtk::TreeView::Column stop_here;
 
     GtkTreeViewColumnsOptimizer(Gtk::TreeView* view,
         GtkTreeModelColumnsOptimizer* cols);
@@ -47,11 +46,20 @@ class GuiPlanAttribOpt : public WinBase
   private:
     GtkSkillList plan;
     std::size_t plan_offset;
+    AsyncAttribOpt* optimizer_job;
+    /* The optimum for every plan suffix, calculated on demand. */
+    std::vector<AttribOptResult> suffix_results;
 
     Gtk::Notebook notebook;
     Gtk::RadioButton rb_whole_plan;
     Gtk::RadioButton rb_partial_plan;
+    Gtk::RadioButton rb_remap_plan;
     Gtk::ComboBoxText skill_selection;
+    Gtk::SpinButton remap_amount;
+    Gtk::Label bonus_remaps_label;
+    Gtk::Button calculate_but;
+    Gtk::Button cancel_but;
+    Gtk::ProgressBar progressbar;
 
     Gtk::Label base_cha_label;
     Gtk::Label base_intl_label;
@@ -68,6 +76,7 @@ class GuiPlanAttribOpt : public WinBase
     Gtk::Label original_time_label;
     Gtk::Label best_time_label;
     Gtk::Label difference_time_label;
+    Gtk::Label remaps_label;
     Gtk::Box warning_box;
 
     GtkTreeModelColumnsOptimizer cols;
@@ -81,11 +90,21 @@ class GuiPlanAttribOpt : public WinBase
     Gtk::Widget* create_breakdown_page (void);
 
     void on_calculate_clicked (void);
+    void on_cancel_clicked (void);
     void set_selection_sensitivity (bool sensitive);
+    void set_calculating (bool calculating);
+    GtkSkillList get_plan_part (void) const;
     void optimize_plan (void);
+    void optimize_partial_plan (void);
+    void on_optimize_progress (double fraction);
+    void on_optimize_done (AttribOptResult best);
+    void optimize_remaps (void);
+    void show_result (AttribOptResult const& best);
+    void show_result (AttribRemapResult const& result, bool remap_rows);
 
   public:
     GuiPlanAttribOpt (void);
+    ~GuiPlanAttribOpt (void);
     void set_plan (GtkSkillList const& plan);
 };
 
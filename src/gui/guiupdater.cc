@@ -11,11 +11,11 @@
 #include <cerrno>
 #include <cstring>
 #include <iostream>
-#include <fstream>
 
 #include <gtkmm.h>
 
 #include "api/evetime.h"
+#include "api/xml.h"
 #include "util/helpers.h"
 #include "util/os.h"
 #include "bits/config.h"
@@ -220,6 +220,9 @@ GuiUpdater::on_update_clicked (void)
       dl.name = file.file_name;
       dl.host = file.server_host;
       dl.path = file.server_path;
+      dl.headers = Updater::get_conditional_headers(file);
+      dl.sink = XmlParserSink::create
+          (HttpFileSink::create(file.download_path));
       dl.is_api_call = true;
       this->downloader.append_download(dl);
     }
@@ -250,7 +253,8 @@ void
 GuiUpdater::on_download_done (DownloadItem dl, AsyncHttpData data)
 {
   /* Download successful? */
-  if (data.data.get() == 0 || data.data->http_code != 200)
+  if (data.data.get() == 0 || (data.data->http_code != 200
+      && data.data->http_code != 304))
   {
     std::cout << "Error: The download for " << dl.name
         << " failed: " << data.exception << std::endl;
@@ -289,29 +293,44 @@ GuiUpdater::on_download_done (DownloadItem dl, AsyncHttpData data)
     return;
   }
 
-  /* Check if file changed. */
-  if (Updater::is_same_file(file.local_path, data.data))
+  /* The server confirmed that the local file is up to date. */
+  if (data.data->http_code == 304)
+  {
+    std::cout << "Updater: " << dl.name << ": Not modified" << std::endl;
     return;
+  }
+
+  Updater::print_transfer_size(dl.name, data.data);
+
+  /* Check if file changed. Changed validators mean a changed file,
+   * the contents are only compared without validators. */
+  if ((dl.headers.empty() || !Updater::has_validators(data.data))
+      && Updater::is_same_file(file.local_path, file.download_path))
+  {
+    OS::unlink(file.download_path.c_str());
+    Updater::store_validators(file, data.data);
+    return;
+  }
 
-  /* Write file to disk. */
-  std::ofstream out(file.local_path.c_str());
-  if (!out)
+  /* Replace the local file with the downloaded file. */
+  if (!OS::rename(file.download_path.c_str(), file.local_path.c_str()))
   {
     std::cout << "Error: Cannot write data file to disk." << std::endl;
+    std::string error(::strerror(errno));
+    OS::unlink(file.download_path.c_str());
 
     Gtk::MessageDialog md("Write to disk failed!",
         false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_OK);
     md.set_secondary_text("The download for " + dl.name
         + " succeeded, but the file cannot be written to disk.\n\n"
-        + std::string(::strerror(errno)));
+        + error);
     md.set_transient_for(*this);
     md.run();
 
     this->download_error = true;
     return;
   }
-  out.write(&data.data->data[0], data.data->data.size());
-  out.close();
+  Updater::store_validators(file, data.data);
 
   this->is_updated = true;
   this->rebuild_files_box();
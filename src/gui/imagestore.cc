@@ -49,6 +49,8 @@ Glib::RefPtr<Gdk::Pixbuf> ImageStore::skillplan[5];
 Glib::RefPtr<Gdk::Pixbuf> ImageStore::certgrades[4];
 Glib::RefPtr<Gdk::Pixbuf> ImageStore::certstatus[4];
 Glib::RefPtr<Gdk::Pixbuf> ImageStore::menuicons[3];
+Glib::RefPtr<Gdk::Pixbuf>
+    ImageStore::progress_cache[6][SKILL_PROGRESS_STEPS + 1];
 
 /* ---------------------------------------------------------------- */
 
@@ -154,21 +156,36 @@ ImageStore::init (void)
 Glib::RefPtr<Gdk::Pixbuf>
 ImageStore::skill_progress (unsigned int level, double completed)
 {
-  Glib::RefPtr<Gdk::Pixbuf> ret(Gdk::Pixbuf::create_from_xpm_data
-      (img_skillprogress_xpm));
-
   /* Some safety checks. */
   if (level > 5) level = 5;
   if (completed < 0.0) completed = 0.0;
   if (completed > 1.0) completed = 1.0;
 
+  /* The images are rendered once and shared by all callers. */
+  unsigned int steps = (unsigned int)::round
+      ((double)SKILL_PROGRESS_STEPS * completed);
+  Glib::RefPtr<Gdk::Pixbuf>& ret = ImageStore::progress_cache[level][steps];
+  if (!ret)
+    ret = ImageStore::render_skill_progress(level, steps);
+
+  return ret;
+}
+
+/* ---------------------------------------------------------------- */
+
+Glib::RefPtr<Gdk::Pixbuf>
+ImageStore::render_skill_progress (unsigned int level, unsigned int steps)
+{
+  Glib::RefPtr<Gdk::Pixbuf> ret(Gdk::Pixbuf::create_from_xpm_data
+      (img_skillprogress_xpm));
+
   /* draw level */
   for (unsigned int l = 0; l < level; ++l)
     for (unsigned int x = 0; x < 6; ++x)
       ret->copy_area(0, 0, 1, 5, ret, (l * 7 + x + 2), 2);
 
   /* draw percent */
-  for (unsigned int p = 0; p < (unsigned int)::round(34.0 * completed); ++p)
+  for (unsigned int p = 0; p < steps; ++p)
     ret->copy_area(0, 0, 1, 2, ret, (p + 2), 13);
 
   return ret;
@@ -179,6 +196,9 @@ ImageStore::skill_progress (unsigned int level, double completed)
 void
 ImageStore::unload (void)
 {
+  for (unsigned int l = 0; l < 6; ++l)
+    for (unsigned int p = 0; p <= SKILL_PROGRESS_STEPS; ++p)
+      ImageStore::progress_cache[l][p].reset();
 }
 
 /* ---------------------------------------------------------------- */
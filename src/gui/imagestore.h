@@ -13,10 +13,19 @@
 
 #include <gdkmm.h>
 
+/* The amount of pixels in the completion bar of the skill progress. */
+#define SKILL_PROGRESS_STEPS 34
+
 class ImageStore
 {
   private:
+    /* Rendered skill progress images per level and completion step. */
+    static Glib::RefPtr<Gdk::Pixbuf>
+        progress_cache[6][SKILL_PROGRESS_STEPS + 1];
+
     static Glib::RefPtr<Gdk::Pixbuf> create_from_inline (guint8 const* data);
+    static Glib::RefPtr<Gdk::Pixbuf> render_skill_progress
+        (unsigned int level, unsigned int steps);
 
   public:
     static Glib::RefPtr<Gdk::Pixbuf> skill;
@@ -35,6 +44,7 @@ class ImageStore
     static Glib::RefPtr<Gdk::Pixbuf> certstatus[4];
     static Glib::RefPtr<Gdk::Pixbuf> menuicons[3];
 
+    /* Returns a shared image that must not be modified. */
     static Glib::RefPtr<Gdk::Pixbuf> skill_progress
         (unsigned int level, double percent);
 
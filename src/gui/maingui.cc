@@ -20,6 +20,7 @@
 #include "bits/server.h"
 #include "bits/serverlist.h"
 #include "bits/argumentsettings.h"
+#include "bits/eventscheduler.h"
 #include "imagestore.h"
 #include "gtkdefines.h"
 #include "gtkserver.h"
@@ -202,6 +203,8 @@ MainGui::MainGui (void)
       (*this, &MainGui::on_data_files_changed));
   this->updater->signal_files_unchanged().connect(sigc::mem_fun
       (*this, &MainGui::on_data_files_unchanged));
+  this->updater->signal_files_failed().connect(sigc::mem_fun
+      (*this, &MainGui::on_data_files_failed));
 
   /* Connect signals of the character list. */
   CharacterListPtr charlist = CharacterList::request();
@@ -211,9 +214,9 @@ MainGui::MainGui (void)
       (sigc::mem_fun(*this, &MainGui::remove_character));
 
   /* Setup timers for refresh and GUI update for the servers. */
-  Glib::signal_timeout().connect(sigc::mem_fun
-      (*this, &MainGui::refresh_servers), MAINGUI_SERVER_REFRESH);
-  Glib::signal_timeout().connect(sigc::mem_fun
+  EventScheduler::add_after(MAINGUI_SERVER_REFRESH, sigc::mem_fun
+      (*this, &MainGui::refresh_servers));
+  this->time_conn = Glib::signal_timeout().connect(sigc::mem_fun
       (*this, &MainGui::update_time), MAINGUI_TIME_UPDATE);
   Glib::signal_timeout().connect(sigc::mem_fun
       (*this, &MainGui::update_tooltip), MAINGUI_TOOLTIP_UPDATE);
@@ -227,11 +230,12 @@ MainGui::MainGui (void)
 
 /* ---------------------------------------------------------------- */
 
-bool
+void
 MainGui::refresh_servers (void)
 {
   ServerList::refresh();
-  return true;
+  EventScheduler::add_after(MAINGUI_SERVER_REFRESH, sigc::mem_fun
+      (*this, &MainGui::refresh_servers));
 }
 
 /* ---------------------------------------------------------------- */
@@ -269,29 +273,45 @@ MainGui::update_tooltip (void)
 void
 MainGui::init_from_charlist (void)
 {
+  /* Pages are built when they are shown. The notebook is hidden while
+   * the pages are added to only build the page that is shown at last. */
+  this->notebook.hide();
+
   CharacterListPtr clist = CharacterList::request();
   for (std::size_t i = 0; i < clist->chars.size(); ++i)
-    this->add_character(clist->chars[i]);
+    this->append_character(clist->chars[i]);
 
+  this->notebook.set_current_page(-1);
+  this->notebook.show();
   this->check_if_no_pages();
+  this->update_tooltip();
 }
 
 /* ---------------------------------------------------------------- */
 
 void
 MainGui::add_character (CharacterPtr character)
+{
+  this->append_character(character);
+  this->notebook.set_current_page(-1);
+
+  /* Update tray icon tooltips. */
+  this->update_tooltip();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+MainGui::append_character (CharacterPtr character)
 {
   /* Create the new character page for the notebook. */
   GtkCharPage* page = Gtk::manage(new GtkCharPage(character));
   page->set_parent_window(this);
   this->notebook.append_page(*page, character->get_char_name(), false);
-  this->notebook.set_current_page(-1);
+  page->set_window_visible(!this->iconified);
 
   character->signal_name_available().connect(sigc::mem_fun
       (*this, &MainGui::update_char_name));
-
-  /* Update tray icon tooltips. */
-  this->update_tooltip();
 }
 
 /* ---------------------------------------------------------------- */
@@ -454,6 +474,9 @@ MainGui::on_window_state_event (GdkEventWindowState* event)
     //this->show();
   }
 
+  /* Only the tray tooltip and notifications need updates while hidden. */
+  this->update_pages_visibility();
+
   while (Gtk::Main::events_pending())
     Gtk::Main::iteration();
 
@@ -462,6 +485,31 @@ MainGui::on_window_state_event (GdkEventWindowState* event)
 
 /* ---------------------------------------------------------------- */
 
+void
+MainGui::update_pages_visibility (void)
+{
+  bool visible = !this->iconified;
+  if (visible && !this->time_conn.connected())
+  {
+    this->time_conn = Glib::signal_timeout().connect(sigc::mem_fun
+        (*this, &MainGui::update_time), MAINGUI_TIME_UPDATE);
+    this->update_time();
+  }
+  else if (!visible)
+    this->time_conn.disconnect();
+
+  Glib::ListHandle<Gtk::Widget*> childs = this->notebook.get_children();
+  for (Glib::ListHandle<Gtk::Widget*>::iterator iter = childs.begin();
+      iter != childs.end(); iter++)
+  {
+    GtkCharPage* page = dynamic_cast<GtkCharPage*>(*iter);
+    if (page != 0)
+      page->set_window_visible(visible);
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 MainGui::on_tray_icon_clicked (void)
 {
@@ -542,6 +590,29 @@ MainGui::on_data_files_unchanged (void)
 
 /* ---------------------------------------------------------------- */
 
+void
+MainGui::on_data_files_failed (void)
+{
+  /* The trees cannot be used anymore. Report and exit. */
+  std::string error = this->updater->get_error();
+  delete this->updater;
+  std::cout << "XML error: " << error << std::endl;
+  std::cout << "Cannot load the data files. EXIT!" << std::endl;
+
+  Gtk::MessageDialog md("The updated data files cannot be loaded!",
+      false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_OK);
+  md.set_secondary_text("The data files updater downloaded a file that "
+      "cannot be loaded:\n\n" + error + "\n\nGtkEveMon will exit now. "
+      "The data files are downloaded again on the next start.");
+  md.set_title("Data files - GtkEveMon");
+  md.set_transient_for(*this);
+  md.run();
+
+  this->close();
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 MainGui::update_char_name (std::string char_id)
 {
@@ -22,8 +22,8 @@
 #include "gtkinfodisplay.h"
 #include "gtkserver.h"
 
-/* Refresh the list of servers every this milli seconds. */
-#define MAINGUI_SERVER_REFRESH 600000
+/* Refresh the list of servers every this seconds. */
+#define MAINGUI_SERVER_REFRESH 600
 /* Update the EVE time and the local time this milli seconds. */
 #define MAINGUI_TIME_UPDATE 1000
 /* Update the tooltip for the tray icon this milli seconds. */
@@ -46,22 +46,26 @@ class MainGui : public Gtk::Window
     Gtk::Label localtime_label;
     GtkInfoDisplay info_display;
     bool iconified;
+    sigc::connection time_conn;
 
   private:
     /* Misc helpers. */
     void init_from_charlist (void);
     void add_character (CharacterPtr character);
+    void append_character (CharacterPtr character);
     void remove_character (std::string char_id);
 
     void on_pages_changed (Widget* page, guint page_num);
     void on_pages_switched (Widget* page, guint page_num);
     void on_data_files_changed (void);
     void on_data_files_unchanged (void);
+    void on_data_files_failed (void);
     void check_if_no_pages (void);
+    void update_pages_visibility (void);
 
     /* Update handlers. */
     bool update_servers (void);
-    bool refresh_servers (void);
+    void refresh_servers (void);
     bool update_time (void);
     bool update_tooltip (void);
     bool update_windowtitle (void);
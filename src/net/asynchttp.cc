@@ -1,4 +1,3 @@
-#include <cstdlib>
 #include <sstream>
 
 #include "httpstatus.h"
@@ -6,17 +5,33 @@
 
 AsyncHttp::AsyncHttp (void)
 {
-  this->sig_dispatch.connect(sigc::mem_fun(*this, &AsyncHttp::dispatch));
 }
 
 /* ---------------------------------------------------------------- */
 
-void*
-AsyncHttp::run (void)
+CURL*
+AsyncHttp::start (void)
 {
   try
   {
-    HttpDataPtr data = this->request();
+    return this->begin_transfer();
+  }
+  catch (Exception& e)
+  {
+    this->http_result.exception = e;
+    this->http_result.data.reset();
+    return 0;
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+AsyncHttp::finish (CURL* handle, CURLcode code)
+{
+  try
+  {
+    HttpDataPtr data = this->finish_transfer(handle, code);
     this->http_result.data = data;
 
     /* If we receive a HTTP status code other than 200,
@@ -34,13 +49,6 @@ AsyncHttp::run (void)
     this->http_result.exception = e;
     this->http_result.data.reset();
   }
-
-  /* Simulate some lag. */
-  //::srand(::time(0));
-  //::sleep(::rand() % 3 + 1);
-
-  this->sig_dispatch.emit();
-  return 0;
 }
 
 /* ---------------------------------------------------------------- */
@@ -13,11 +13,11 @@
 #ifndef ASYNC_HTTP_HEADER
 #define ASYNC_HTTP_HEADER
 
-#include <glibmm/dispatcher.h>
+#include <sigc++/signal.h>
 
-#include "util/thread.h"
 #include "util/exception.h"
 #include "http.h"
+#include "httploop.h"
 
 /* This is delivered when the request ist done.
  * The data member is NULL if there was an error.
@@ -37,18 +37,23 @@ class AsyncHttpData
  * - Run async_request()
  * - Data will be delivered to all signal subscribers
  * - No need to free, automatic deletion if all signals are processed
+ * The transfer runs on the network thread, see HttpLoop.
  */
-class AsyncHttp : public Thread, public Http
+class AsyncHttp : public Http
 {
+  friend class HttpLoop;
+
   private:
     AsyncHttpData http_result;
-    Glib::Dispatcher sig_dispatch;
     sigc::signal<void, AsyncHttpData> sig_done;
 
   protected:
     AsyncHttp (void);
 
-    void* run (void);
+    /* Executed by the network thread. */
+    CURL* start (void);
+    void finish (CURL* handle, CURLcode code);
+
     void dispatch (void);
 
   public:
@@ -70,7 +75,7 @@ AsyncHttp::create (void)
 inline void
 AsyncHttp::async_request (void)
 {
-  this->pt_create();
+  HttpLoop::enqueue(this);
 }
 
 inline void
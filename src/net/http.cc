@@ -1,12 +1,45 @@
+#include <cctype>
 #include <cstring>
+#include <exception>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <cstdlib>
 
 #include "util/exception.h"
+#include "httppool.h"
 #include "http.h"
 
+std::string
+HttpData::get_header (std::string const& name) const
+{
+  /* Search backwards up to the status line of the final response. */
+  for (std::size_t i = this->headers.size(); i > 0; --i)
+  {
+    std::string const& line = this->headers[i - 1];
+    if (line.compare(0, 5, "HTTP/") == 0)
+      break;
+    if (line.size() <= name.size() || line[name.size()] != ':')
+      continue;
+
+    bool matches = true;
+    for (std::size_t j = 0; matches && j < name.size(); ++j)
+      matches = ::tolower((unsigned char)line[j])
+          == ::tolower((unsigned char)name[j]);
+    if (!matches)
+      continue;
+
+    std::size_t pos = line.find_first_not_of(" \t", name.size() + 1);
+    if (pos == std::string::npos)
+      return std::string();
+    return line.substr(pos);
+  }
+
+  return std::string();
+}
+
+/* ---------------------------------------------------------------- */
+
 void
 HttpData::dump_headers (void)
 {
@@ -54,89 +87,141 @@ Http::initialize_defaults (void)
 
   this->http_state = HTTP_STATE_READY;
   this->bytes_read = 0;
+  this->bytes_received = 0;
   this->bytes_total = 0;
+  this->header_list = NULL;
+  this->active_sink = NULL;
 }
 
 /* ---------------------------------------------------------------- */
 
 HttpDataPtr
 Http::request (void)
+{
+  CURL* handle = this->begin_transfer();
+  CURLcode res = curl_easy_perform(handle);
+  return this->finish_transfer(handle, res);
+}
+
+/* ---------------------------------------------------------------- */
+
+CURL*
+Http::begin_transfer (void)
 {
   // Set up variables
-  HttpDataPtr result = HttpData::create();
   std::stringstream url;
   unsigned int i;
 
+  // The body goes to the user sink or into the HTTP data
+  this->result = HttpData::create();
+  this->memory_sink.set_buffer(&this->result->data);
+  this->active_sink = this->sink.get();
+  if (this->active_sink == NULL)
+    this->active_sink = &this->memory_sink;
+
+  this->bytes_read = 0;
+  this->bytes_received = 0;
+  this->bytes_total = 0;
+
   CURL * curl_handle = NULL;
-  CURLcode res = CURLE_OK;
   try
   {
-    curl_handle = curl_easy_init();
-  
-    if (use_ssl)
-      url << "https://";
-    else
-      url << "http://";
-    url << host;
-    if (port != 443 && port != 80)
-      url << ":" << port;
-    url << path;
-
-    HttpCombo combo;
-    combo.http = this;
-    combo.httpdataptr = &result;
-
-    curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1L);
-    curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 1L);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, Http::data_callback);
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *) &combo);
-    curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, Http::header_callback);
-    curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, (void *) &combo);
-    curl_easy_setopt(curl_handle, CURLOPT_URL, url.str().c_str());
-    curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, agent.c_str());
-  
-    if (proxy.size() > 0) {
-      curl_easy_setopt(curl_handle, CURLOPT_PROXY, proxy.c_str());
-      curl_easy_setopt(curl_handle, CURLOPT_PROXYPORT, (long) proxy_port);
-    }
-  
-    if (data.size() > 0) {
-      curl_easy_setopt(curl_handle, CURLOPT_POST, 1L);
-      curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, data.c_str());
-    }
-  
-    struct curl_slist *list = NULL;
-    if (headers.size() > 0) {
-      for (i = 0; i < headers.size(); i++)
-        list = curl_slist_append(list, headers[i].c_str());
-      curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
-    }
-  
-    http_state = HTTP_STATE_CONNECTING;
-    res = curl_easy_perform(curl_handle);
-    
-    result->data.push_back(0);
-    curl_slist_free_all(list);
-  
-    long lhttp_code;
-    curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &lhttp_code);
-    result->http_code = (HttpStatusCode) lhttp_code;
-  
-    // Error checking
-    if (res == CURLE_OK)
-      http_state = HTTP_STATE_DONE;
-    else
-      throw Exception(curl_easy_strerror(res));
+    this->active_sink->open();
+    curl_handle = HttpHandlePool::acquire();
   }
   catch (Exception & e)
+  {
+    http_state = HTTP_STATE_ERROR;
+    std::cout << "HTTP Failure: " << e << std::endl;
+    this->active_sink->close(false);
+    this->result.reset();
+    throw;
+  }
+
+  if (use_ssl)
+    url << "https://";
+  else
+    url << "http://";
+  url << host;
+  if (port != 443 && port != 80)
+    url << ":" << port;
+  url << path;
+
+  curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+  curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION, Http::progress_callback);
+  curl_easy_setopt(curl_handle, CURLOPT_XFERINFODATA, (void *) this);
+  // Let the server compress, libcurl decodes all encodings it supports
+  curl_easy_setopt(curl_handle, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, Http::data_callback);
+  curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *) this);
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, Http::header_callback);
+  curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, (void *) this);
+  curl_easy_setopt(curl_handle, CURLOPT_URL, url.str().c_str());
+  curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, agent.c_str());
+
+  if (proxy.size() > 0) {
+    curl_easy_setopt(curl_handle, CURLOPT_PROXY, proxy.c_str());
+    curl_easy_setopt(curl_handle, CURLOPT_PROXYPORT, (long) proxy_port);
+  }
+
+  if (data.size() > 0) {
+    curl_easy_setopt(curl_handle, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, data.c_str());
+  }
+
+  this->header_list = NULL;
+  if (headers.size() > 0) {
+    for (i = 0; i < headers.size(); i++)
+      this->header_list = curl_slist_append(this->header_list, headers[i].c_str());
+    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, this->header_list);
+  }
+
+  http_state = HTTP_STATE_CONNECTING;
+  return curl_handle;
+}
+
+/* ---------------------------------------------------------------- */
+
+HttpDataPtr
+Http::finish_transfer (CURL* curl_handle, CURLcode res)
+{
+  HttpDataPtr result = this->result;
+  this->result.reset();
+
+  curl_slist_free_all(this->header_list);
+  this->header_list = NULL;
+
+  long lhttp_code;
+  curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &lhttp_code);
+  result->http_code = (HttpStatusCode) lhttp_code;
+  curl_off_t wire_size = 0;
+  curl_easy_getinfo(curl_handle, CURLINFO_SIZE_DOWNLOAD_T, &wire_size);
+  result->wire_size = (std::size_t) wire_size;
+  result->body_size = this->bytes_read;
+  HttpHandlePool::release(curl_handle);
+
+  // Only complete documents are committed by the sink
+  try
+  {
+    this->active_sink->close(res == CURLE_OK && result->http_code == 200);
+  }
+  catch (Exception & e)
+  {
+    http_state = HTTP_STATE_ERROR;
+    std::cout << "HTTP Failure: " << e << std::endl;
+    throw;
+  }
+
+  // Error checking
+  if (res != CURLE_OK)
   {
     http_state = HTTP_STATE_ERROR;
     std::cout << "HTTP Failure: " << curl_easy_strerror(res) << std::endl;
-    curl_easy_cleanup(curl_handle);
-    throw Exception(e);
+    throw Exception(curl_easy_strerror(res));
   }
 
-  curl_easy_cleanup(curl_handle);
+  http_state = HTTP_STATE_DONE;
   return result;
 }
 
@@ -146,33 +231,45 @@ unsigned int
 Http::get_uint_from_str (std::string const& str)
 {
   std::stringstream ss(str);
-  int ret;
+  int ret = 0;
   ss >> ret;
-  return ret;
+  return ret < 0 ? 0 : (unsigned int)ret;
 }
 
 /* ---------------------------------------------------------------- */
 
 std::size_t
-Http::header_callback(char * buffer, std::size_t size, std::size_t nitems, void * combo)
+Http::header_callback(char * buffer, std::size_t size, std::size_t nitems, void * userp)
 {
   std::size_t buffer_size = size * nitems;
   if (buffer_size > 2) {
-    Http * http = ((HttpCombo *) combo)->http;
-    HttpDataPtr result = *((HttpCombo *) combo)->httpdataptr;
+    Http * http = (Http *) userp;
+    HttpData * result = http->result.get();
 
     http->http_state = HTTP_STATE_RECEIVING;
 
-    std::string header_line;
-    header_line.assign(buffer, buffer_size);
-    while (!header_line.empty() && (*header_line.rbegin() == '\r' || *header_line.rbegin() == '\n'))
-      header_line.resize(header_line.size() - 1);
+    // Exceptions must not pass through libcurl, abort instead
+    try
+    {
+      std::string header_line;
+      header_line.assign(buffer, buffer_size);
+      while (!header_line.empty() && (*header_line.rbegin() == '\r' || *header_line.rbegin() == '\n'))
+        header_line.resize(header_line.size() - 1);
 
 
-    result->headers.push_back(header_line);
+      result->headers.push_back(header_line);
 
-    if (header_line.substr(0, 16) == "Content-Length: ")
-      http->bytes_total = http->get_uint_from_str(header_line.substr(16));
+      // Redirects and interim responses have their own length
+      if (header_line.compare(0, 5, "HTTP/") == 0)
+        http->bytes_total = 0;
+      else if (header_line.substr(0, 16) == "Content-Length: ")
+        http->bytes_total = http->get_uint_from_str(header_line.substr(16));
+    }
+    catch (std::exception& e)
+    {
+      std::cout << "HTTP Failure: " << e.what() << std::endl;
+      return 0;
+    }
   }
   return buffer_size;
 }
@@ -180,16 +277,35 @@ Http::header_callback(char * buffer, std::size_t size, std::size_t nitems, void
 /* ---------------------------------------------------------------- */
 
 std::size_t
-Http::data_callback(char * buffer, std::size_t size, std::size_t nmemb, void * combo)
+Http::data_callback(char * buffer, std::size_t size, std::size_t nmemb, void * userp)
 {
-  Http * http = ((HttpCombo *) combo)->http;
-  HttpDataPtr result = *((HttpCombo *) combo)->httpdataptr;
+  Http * http = (Http *) userp;
 
-  unsigned long previous_size = result->data.size();
-  unsigned long current_size = previous_size + size * nmemb;
-  http->bytes_read = current_size;
-  result->data.resize(current_size);
-  memcpy(&result->data[previous_size], buffer, size * nmemb);
+  // A short count makes libcurl abort the transfer. The body belongs
+  // to the final response, which announced the length last.
+  try
+  {
+    if (http->bytes_read == 0 && http->bytes_total > 0)
+      http->active_sink->reserve(http->bytes_total);
+    if (!http->active_sink->write(buffer, size * nmemb))
+      return 0;
+  }
+  catch (std::exception& e)
+  {
+    std::cout << "HTTP Failure: " << e.what() << std::endl;
+    return 0;
+  }
+  http->bytes_read += size * nmemb;
 
   return size * nmemb;
 }
+
+/* ---------------------------------------------------------------- */
+
+int
+Http::progress_callback(void * userp, curl_off_t /*dltotal*/, curl_off_t dlnow, curl_off_t /*ultotal*/, curl_off_t /*ulnow*/)
+{
+  Http * http = (Http *) userp;
+  http->bytes_received = (std::size_t) dlnow;
+  return 0;
+}
@@ -20,6 +20,7 @@
 
 #include "util/ref_ptr.h"
 #include "httpstatus.h"
+#include "httpsink.h"
 
 enum HttpMethod
 {
@@ -54,10 +55,20 @@ class HttpData
     HttpStatusCode http_code;
     std::vector<std::string> headers;
     std::vector<char> data;
+    /* Size of the body on the wire, which is smaller than the
+     * body if the server compressed the document. */
+    std::size_t wire_size;
+    /* Size of the decoded body. The data is empty if a sink
+     * received the body, otherwise it has a terminating NUL. */
+    std::size_t body_size;
 
   public:
     static HttpDataPtr create (void);
 
+    /* Returns the value of the named header of the final response,
+     * ignoring the case of the name, or an empty string. */
+    std::string get_header (std::string const& name) const;
+
     /* This is for debugging purposes. */
     void dump_headers (void);
     void dump_data (void);
@@ -84,12 +95,29 @@ class Http
     /* Tracking the HTTP state. */
     HttpState http_state;
     std::size_t bytes_read;
+    std::size_t bytes_received;
     std::size_t bytes_total;
 
+    /* The body is passed to the user sink or to the memory sink. */
+    HttpSinkPtr sink;
+    HttpMemorySink memory_sink;
+    HttpSink* active_sink;
+
+    /* The transfer in progress. */
+    HttpDataPtr result;
+    struct curl_slist* header_list;
+
   private:
     void initialize_defaults (void);
     unsigned int get_uint_from_str (std::string const& str);
 
+  protected:
+    /* Sets up a pooled handle for the request. The handle is performed
+     * by the caller and passed to finish_transfer() afterwards, which
+     * returns the handle to the pool and the document or throws. */
+    CURL* begin_transfer (void);
+    HttpDataPtr finish_transfer (CURL* handle, CURLcode code);
+
   public:
     Http (void);
     Http (std::string const& host, std::string const& path);
@@ -110,18 +138,24 @@ class Http
     void set_proxy (std::string const& address, uint16_t port);
     /* Specifies if SSL should be used. */
     void set_use_ssl (bool use_ssl = true);
+    /* Passes the body to the sink instead of the HTTP data. */
+    void set_sink (HttpSinkPtr sink);
 
     /* Returns the path. */
     std::string const& get_path (void) const;
 
     /* Information about the progress. */
     std::size_t get_bytes_read (void) const;
-    /* Information about the total size. This may be zero! */
+    /* Bytes received on the wire. This is less than the bytes
+     * read if the document is transferred compressed. */
+    std::size_t get_bytes_received (void) const;
+    /* Information about the total size on the wire. This may be zero! */
     std::size_t get_bytes_total (void) const;
 
     /* Static callback functions for libcurl */
-    static std::size_t data_callback(char * buffer, std::size_t size, std::size_t nmemb, void * combo);
-    static std::size_t header_callback(char * buffer, std::size_t size, std::size_t nitems, void * combo);
+    static std::size_t data_callback(char * buffer, std::size_t size, std::size_t nmemb, void * userp);
+    static std::size_t header_callback(char * buffer, std::size_t size, std::size_t nitems, void * userp);
+    static int progress_callback(void * userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 
     /* Request the document. This will block until transfer is completed. */
     HttpDataPtr request (void);
@@ -129,16 +163,9 @@ class Http
 
 /* ---------------------------------------------------------------- */
 
-struct HttpCombo // A combo struct to pass to libcurl's C callback functions
-{
-  Http * http;
-  HttpDataPtr * httpdataptr;
-};
-
-/* ---------------------------------------------------------------- */
-
 inline
 HttpData::HttpData (void)
+  : wire_size(0), body_size(0)
 {
 }
 
@@ -198,6 +225,12 @@ Http::set_use_ssl (bool use_ssl)
     this->use_ssl = use_ssl;
 }
 
+inline void
+Http::set_sink (HttpSinkPtr sink)
+{
+  this->sink = sink;
+}
+
 inline std::string const&
 Http::get_path (void) const
 {
@@ -210,6 +243,12 @@ Http::get_bytes_read (void) const
   return this->bytes_read;
 }
 
+inline std::size_t
+Http::get_bytes_received (void) const
+{
+  return this->bytes_received;
+}
+
 inline std::size_t
 Http::get_bytes_total (void) const
 {
@@ -0,0 +1,250 @@
+#include "util/exception.h"
+#include "asynchttp.h"
+#include "httploop.h"
+
+/* Milliseconds to wait for network activity in one loop iteration. */
+#define HTTP_LOOP_POLL_TIMEOUT 100
+
+HttpLoop* HttpLoop::instance = 0;
+
+/* ---------------------------------------------------------------- */
+
+HttpLoop::HttpLoop (void)
+  : queued(0)
+{
+  this->multi = curl_multi_init();
+  this->running = false;
+  this->stopped = false;
+
+  this->sig_dispatch.connect(sigc::mem_fun(*this, &HttpLoop::dispatch));
+}
+
+/* ---------------------------------------------------------------- */
+
+HttpLoop::~HttpLoop (void)
+{
+  /* Requests that did not finish are dropped without signals. */
+  for (std::size_t i = 0; i < this->pending.size(); ++i)
+    delete this->pending[i];
+  for (std::size_t i = 0; i < this->finished.size(); ++i)
+    delete this->finished[i];
+
+  curl_multi_cleanup(this->multi);
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::init (void)
+{
+  if (HttpLoop::instance == 0)
+    HttpLoop::instance = new HttpLoop;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::unload (void)
+{
+  HttpLoop* loop = HttpLoop::instance;
+  if (loop == 0)
+    return;
+
+  loop->mutex.wait();
+  loop->stopped = true;
+  bool running = loop->running;
+  loop->mutex.post();
+
+  if (running)
+  {
+    loop->queued.post();
+    loop->wakeup();
+    loop->pt_join();
+  }
+
+  delete loop;
+  HttpLoop::instance = 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::enqueue (AsyncHttp* http)
+{
+  HttpLoop::init();
+  HttpLoop* loop = HttpLoop::instance;
+
+  loop->mutex.wait();
+  loop->pending.push_back(http);
+  bool start_thread = !loop->running;
+  loop->running = true;
+  loop->mutex.post();
+
+  if (start_thread)
+    loop->pt_create();
+
+  loop->queued.post();
+  loop->wakeup();
+}
+
+/* ---------------------------------------------------------------- */
+
+void*
+HttpLoop::run (void)
+{
+  while (true)
+  {
+    /* Without transfers the thread sleeps until a request is queued. */
+    if (this->active.empty())
+      this->queued.wait();
+
+    this->mutex.wait();
+    bool stopped = this->stopped;
+    this->mutex.post();
+    if (stopped)
+      break;
+
+    this->start_transfers();
+    if (this->active.empty())
+      continue;
+
+    int running_handles = 0;
+    curl_multi_perform(this->multi, &running_handles);
+    this->finish_transfers();
+
+    if (!this->active.empty())
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400
+      curl_multi_poll(this->multi, 0, 0, HTTP_LOOP_POLL_TIMEOUT, 0);
+#else
+      curl_multi_wait(this->multi, 0, 0, HTTP_LOOP_POLL_TIMEOUT, 0);
+#endif
+    }
+  }
+
+  /* Transfers still running are aborted. */
+  for (std::size_t i = 0; i < this->active.size(); ++i)
+  {
+    curl_multi_remove_handle(this->multi, this->handles[i]);
+    this->active[i]->finish(this->handles[i], CURLE_ABORTED_BY_CALLBACK);
+  }
+
+  this->mutex.wait();
+  this->finished.insert(this->finished.end(),
+      this->active.begin(), this->active.end());
+  this->mutex.post();
+
+  this->active.clear();
+  this->handles.clear();
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::start_transfers (void)
+{
+  std::vector<AsyncHttp*> starting;
+
+  this->mutex.wait();
+  while (!this->pending.empty() && this->active.size()
+      + starting.size() < HTTP_LOOP_MAX_TRANSFERS)
+  {
+    starting.push_back(this->pending.front());
+    this->pending.erase(this->pending.begin());
+  }
+  this->mutex.post();
+
+  std::vector<AsyncHttp*> failed;
+  for (std::size_t i = 0; i < starting.size(); ++i)
+  {
+    CURL* handle = starting[i]->start();
+    if (handle == 0)
+    {
+      failed.push_back(starting[i]);
+      continue;
+    }
+
+    curl_multi_add_handle(this->multi, handle);
+    this->active.push_back(starting[i]);
+    this->handles.push_back(handle);
+  }
+
+  if (failed.empty())
+    return;
+
+  this->mutex.wait();
+  this->finished.insert(this->finished.end(), failed.begin(), failed.end());
+  this->mutex.post();
+
+  this->sig_dispatch.emit();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::finish_transfers (void)
+{
+  std::vector<AsyncHttp*> done;
+
+  int queued_messages = 0;
+  CURLMsg* msg;
+  while ((msg = curl_multi_info_read(this->multi, &queued_messages)) != 0)
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    /* The message is invalid after the handle has been removed. */
+    CURL* handle = msg->easy_handle;
+    CURLcode code = msg->data.result;
+
+    for (std::size_t i = 0; i < this->handles.size(); ++i)
+    {
+      if (this->handles[i] != handle)
+        continue;
+
+      curl_multi_remove_handle(this->multi, handle);
+      this->active[i]->finish(handle, code);
+      done.push_back(this->active[i]);
+
+      this->active.erase(this->active.begin() + i);
+      this->handles.erase(this->handles.begin() + i);
+      break;
+    }
+  }
+
+  if (done.empty())
+    return;
+
+  this->mutex.wait();
+  this->finished.insert(this->finished.end(), done.begin(), done.end());
+  this->mutex.post();
+
+  this->sig_dispatch.emit();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::wakeup (void)
+{
+#if LIBCURL_VERSION_NUM >= 0x074400
+  /* Interrupts the wait for network activity to start new requests. */
+  curl_multi_wakeup(this->multi);
+#endif
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpLoop::dispatch (void)
+{
+  std::vector<AsyncHttp*> done;
+  this->mutex.wait();
+  done.swap(this->finished);
+  this->mutex.post();
+
+  for (std::size_t i = 0; i < done.size(); ++i)
+    done[i]->dispatch();
+}
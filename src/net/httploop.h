@@ -0,0 +1,76 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_LOOP_HEADER
+#define HTTP_LOOP_HEADER
+
+#include <vector>
+#include <curl/curl.h>
+#include <glibmm/dispatcher.h>
+
+#include "util/thread.h"
+
+/* The maximum amount of transfers running at the same time. */
+#define HTTP_LOOP_MAX_TRANSFERS 4
+
+class AsyncHttp;
+
+/*
+ * The network thread for asynchronous requests. All transfers run in
+ * a single libcurl multi event loop. Requests are queued and started
+ * as soon as less than HTTP_LOOP_MAX_TRANSFERS transfers are running.
+ * Finished requests are handed back to the main thread through a
+ * single dispatcher. Call init() from the main thread after GTK has
+ * been initialized; the thread is started with the first request.
+ */
+class HttpLoop : public Thread
+{
+  private:
+    static HttpLoop* instance;
+
+  private:
+    CURLM* multi;
+
+    /* Protects the queues and the stop flag. */
+    Semaphore mutex;
+    Semaphore queued;
+    std::vector<AsyncHttp*> pending;
+    std::vector<AsyncHttp*> finished;
+    bool running;
+    bool stopped;
+
+    /* Only accessed by the network thread. */
+    std::vector<AsyncHttp*> active;
+    std::vector<CURL*> handles;
+
+    Glib::Dispatcher sig_dispatch;
+
+  protected:
+    HttpLoop (void);
+    ~HttpLoop (void);
+
+    void* run (void);
+    void start_transfers (void);
+    void finish_transfers (void);
+    void wakeup (void);
+    void dispatch (void);
+
+  public:
+    static void init (void);
+    static void unload (void);
+
+    /* Queues the request. The done signal of the request is emitted
+     * from the main loop once the transfer is finished. */
+    static void enqueue (AsyncHttp* http);
+};
+
+#endif /* HTTP_LOOP_HEADER */
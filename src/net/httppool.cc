@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <iostream>
+
+#include "util/exception.h"
+#include "httppool.h"
+
+Semaphore HttpHandlePool::mutex;
+Semaphore HttpHandlePool::share_locks[CURL_LOCK_DATA_LAST];
+CURLSH* HttpHandlePool::share = 0;
+std::vector<CURL*> HttpHandlePool::idle;
+HttpPoolStats HttpHandlePool::stats;
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpHandlePool::init (void)
+{
+  /* Global initialization of libcurl is not thread safe. */
+  curl_global_init(CURL_GLOBAL_ALL);
+
+  HttpHandlePool::share = curl_share_init();
+  if (HttpHandlePool::share == 0)
+  {
+    std::cout << "Warning: Cannot share HTTP caches" << std::endl;
+    return;
+  }
+
+  curl_share_setopt(HttpHandlePool::share, CURLSHOPT_LOCKFUNC,
+      HttpHandlePool::lock_share);
+  curl_share_setopt(HttpHandlePool::share, CURLSHOPT_UNLOCKFUNC,
+      HttpHandlePool::unlock_share);
+  curl_share_setopt(HttpHandlePool::share, CURLSHOPT_SHARE,
+      CURL_LOCK_DATA_DNS);
+  curl_share_setopt(HttpHandlePool::share, CURLSHOPT_SHARE,
+      CURL_LOCK_DATA_SSL_SESSION);
+
+  /* The connection cache is not shared: libcurl does not support
+   * sharing connections between threads that run transfers at the
+   * same time. Handles keep their own connections, and transfers on
+   * the network thread use the cache of its multi handle. */
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpHandlePool::unload (void)
+{
+  HttpPoolStats stats = HttpHandlePool::get_stats();
+  if (stats.requests > 0)
+  {
+    std::cout << "HTTP: " << stats.requests << " requests, "
+        << (stats.requests - std::min(stats.requests, stats.new_connections))
+        << " on reused connections, " << stats.new_handles
+        << " handles" << std::endl;
+  }
+
+  HttpHandlePool::mutex.wait();
+  for (std::size_t i = 0; i < HttpHandlePool::idle.size(); ++i)
+    curl_easy_cleanup(HttpHandlePool::idle[i]);
+  HttpHandlePool::idle.clear();
+  HttpHandlePool::mutex.post();
+
+  /* Handles of requests that are still running keep using the share. */
+  if (HttpHandlePool::share != 0
+      && curl_share_cleanup(HttpHandlePool::share) == CURLSHE_OK)
+    HttpHandlePool::share = 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+CURL*
+HttpHandlePool::acquire (void)
+{
+  CURL* handle = 0;
+
+  HttpHandlePool::mutex.wait();
+  if (!HttpHandlePool::idle.empty())
+  {
+    handle = HttpHandlePool::idle.back();
+    HttpHandlePool::idle.pop_back();
+  }
+  else
+  {
+    handle = curl_easy_init();
+    if (handle != 0)
+      HttpHandlePool::stats.new_handles += 1;
+  }
+  HttpHandlePool::mutex.post();
+
+  if (handle == 0)
+    throw Exception("Cannot create HTTP handle");
+
+  if (HttpHandlePool::share != 0)
+    curl_easy_setopt(handle, CURLOPT_SHARE, HttpHandlePool::share);
+#if LIBCURL_VERSION_NUM >= 0x071900
+  curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+
+  return handle;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpHandlePool::release (CURL* handle)
+{
+  if (handle == 0)
+    return;
+
+  long new_connections = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+
+  /* Resetting the options keeps the connections of the handle. */
+  curl_easy_reset(handle);
+
+  HttpHandlePool::mutex.wait();
+  HttpHandlePool::stats.requests += 1;
+  HttpHandlePool::stats.new_connections += (std::size_t)new_connections;
+  bool keep = HttpHandlePool::idle.size() < HTTP_POOL_MAX_IDLE;
+  if (keep)
+    HttpHandlePool::idle.push_back(handle);
+  HttpHandlePool::mutex.post();
+
+  if (!keep)
+    curl_easy_cleanup(handle);
+}
+
+/* ---------------------------------------------------------------- */
+
+HttpPoolStats
+HttpHandlePool::get_stats (void)
+{
+  HttpHandlePool::mutex.wait();
+  HttpPoolStats stats = HttpHandlePool::stats;
+  HttpHandlePool::mutex.post();
+  return stats;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpHandlePool::lock_share (CURL* /*handle*/, curl_lock_data data,
+    curl_lock_access /*access*/, void* /*userptr*/)
+{
+  HttpHandlePool::share_locks[data].wait();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpHandlePool::unlock_share (CURL* /*handle*/, curl_lock_data data,
+    void* /*userptr*/)
+{
+  HttpHandlePool::share_locks[data].post();
+}
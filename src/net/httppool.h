@@ -0,0 +1,83 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_POOL_HEADER
+#define HTTP_POOL_HEADER
+
+#include <vector>
+#include <curl/curl.h>
+
+#include "util/thread.h"
+
+/* The maximum amount of idle handles kept for reuse. */
+#define HTTP_POOL_MAX_IDLE 8
+
+/* Counters to see how well connections are reused. */
+struct HttpPoolStats
+{
+  /* Amount of finished requests. */
+  std::size_t requests;
+  /* Amount of easy handles that have been created. */
+  std::size_t new_handles;
+  /* Amount of connections that have been established. */
+  std::size_t new_connections;
+
+  HttpPoolStats (void);
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Pool of reusable libcurl easy handles. Handles are returned to the pool
+ * after a request and keep their connections alive, so a request on a
+ * reused handle skips the TCP and TLS handshakes. All handles use a share
+ * object for the DNS cache and the TLS sessions, which also speeds up
+ * the first connection of a handle. Connections are not shared.
+ * The pool is thread safe. Call init() before any threads are started.
+ */
+class HttpHandlePool
+{
+  private:
+    /* Protects the idle handles and the counters. */
+    static Semaphore mutex;
+    /* One lock for every kind of data in the share. */
+    static Semaphore share_locks[CURL_LOCK_DATA_LAST];
+    static CURLSH* share;
+    static std::vector<CURL*> idle;
+    static HttpPoolStats stats;
+
+    static void lock_share (CURL* handle, curl_lock_data data,
+        curl_lock_access access, void* userptr);
+    static void unlock_share (CURL* handle, curl_lock_data data,
+        void* userptr);
+
+  public:
+    static void init (void);
+    static void unload (void);
+
+    /* Returns a handle with default options that uses the share. */
+    static CURL* acquire (void);
+    /* Returns the handle to the pool after the transfer is done. */
+    static void release (CURL* handle);
+
+    static HttpPoolStats get_stats (void);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline
+HttpPoolStats::HttpPoolStats (void)
+  : requests(0), new_handles(0), new_connections(0)
+{
+}
+
+#endif /* HTTP_POOL_HEADER */
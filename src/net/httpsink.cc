@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "util/os.h"
+#include "util/exception.h"
+#include "httpsink.h"
+
+HttpSink::~HttpSink (void)
+{
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpSink::reserve (std::size_t /*size*/)
+{
+}
+
+/* ================================================================ */
+
+void
+HttpMemorySink::open (void)
+{
+  this->buffer->clear();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpMemorySink::reserve (std::size_t size)
+{
+  size = std::min(size, (std::size_t)HTTP_MEMORY_SINK_MAX_RESERVE);
+  this->buffer->reserve(this->buffer->size() + size + 1);
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+HttpMemorySink::write (char const* data, std::size_t size)
+{
+  this->buffer->insert(this->buffer->end(), data, data + size);
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpMemorySink::close (bool /*success*/)
+{
+  /* Error documents are kept for reporting, too. */
+  this->buffer->push_back('\0');
+}
+
+/* ================================================================ */
+
+void
+HttpFileSink::open (void)
+{
+  this->out.open(this->filename.c_str(), std::ios::binary);
+  if (!this->out)
+    throw FileException(this->filename, ::strerror(errno));
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+HttpFileSink::write (char const* data, std::size_t size)
+{
+  this->out.write(data, (std::streamsize)size);
+  return this->out.good();
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+HttpFileSink::close (bool success)
+{
+  this->out.close();
+  if (success && !this->out.fail())
+    return;
+
+  OS::unlink(this->filename.c_str());
+  if (success)
+    throw FileException(this->filename, "Cannot write file");
+}
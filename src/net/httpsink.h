@@ -0,0 +1,122 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HTTP_SINK_HEADER
+#define HTTP_SINK_HEADER
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "util/ref_ptr.h"
+
+/* The memory sink reserves at most that many bytes in advance. */
+#define HTTP_MEMORY_SINK_MAX_RESERVE (16 * 1024 * 1024)
+
+class HttpSink;
+typedef ref_ptr<HttpSink> HttpSinkPtr;
+
+/*
+ * Receives the body of a HTTP response while it is transferred. The
+ * sink is opened before the transfer and closed afterwards. The close
+ * is successful for complete documents with status 200 only. All
+ * functions are called from the thread that performs the transfer.
+ */
+class HttpSink
+{
+  public:
+    virtual ~HttpSink (void);
+
+    /* Prepares the sink for a new body, or throws. */
+    virtual void open (void) = 0;
+    /* Announces the size of the body, if the server sent it. */
+    virtual void reserve (std::size_t size);
+    /* Stores a chunk of the body. Returning false aborts the transfer. */
+    virtual bool write (char const* data, std::size_t size) = 0;
+    /* Finishes the body. Throws if the body cannot be stored. */
+    virtual void close (bool success) = 0;
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Collects the body in memory. The buffer is reserved from the size
+ * of the body, including the terminating NUL byte appended on close.
+ * If the body is compressed, the size is a lower bound only. Larger
+ * announced sizes are capped, the buffer grows as the body arrives.
+ */
+class HttpMemorySink : public HttpSink
+{
+  private:
+    std::vector<char>* buffer;
+
+  public:
+    HttpMemorySink (void);
+
+    void set_buffer (std::vector<char>* buffer);
+
+    void open (void);
+    void reserve (std::size_t size);
+    bool write (char const* data, std::size_t size);
+    void close (bool success);
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * Streams the body to a file. If the transfer fails, the partial file
+ * is removed. The body is not kept in memory.
+ */
+class HttpFileSink : public HttpSink
+{
+  private:
+    std::string filename;
+    std::ofstream out;
+
+  protected:
+    HttpFileSink (std::string const& filename);
+
+  public:
+    static HttpSinkPtr create (std::string const& filename);
+
+    void open (void);
+    bool write (char const* data, std::size_t size);
+    void close (bool success);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline
+HttpMemorySink::HttpMemorySink (void)
+  : buffer(0)
+{
+}
+
+inline void
+HttpMemorySink::set_buffer (std::vector<char>* buffer)
+{
+  this->buffer = buffer;
+}
+
+inline
+HttpFileSink::HttpFileSink (std::string const& filename)
+  : filename(filename)
+{
+}
+
+inline HttpSinkPtr
+HttpFileSink::create (std::string const& filename)
+{
+  return HttpSinkPtr(new HttpFileSink(filename));
+}
+
+#endif /* HTTP_SINK_HEADER */
@@ -14,6 +14,7 @@
 #define OS_HEADER
 
 #include <climits>
+#include <ctime>
 
 class OS
 {
@@ -31,6 +32,13 @@ public:
   static bool  mkdir(char const* pathname/*, mode_t mode*/);
   static bool  unlink(char const* pathname);
   static std::size_t file_size (char const* pathname);
+  static time_t file_mtime (char const* pathname);
+  /* Replaces the target file if it exists. */
+  static bool  rename (char const* oldpath, char const* newpath);
+
+  /* Maps a file read-only into memory. Returns 0 on failure. */
+  static void* map_file (char const* pathname, std::size_t* size);
+  static void  unmap_file (void* data, std::size_t size);
 
   /* Time interface. */
   static char* strptime (const char *buf, const char *fmt, struct tm *tm);
@@ -38,6 +46,7 @@ public:
 
   /* Misc. */
   static int   execv(char const* path, char* const argv[]);
+  static unsigned int get_num_processors(void);
 
   /* Endian conversions. */
   static short letoh(short x);
@@ -1,9 +1,12 @@
 #include <iostream>
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <pwd.h>
+#include <cstdio>
 #include <cstring>
 #include <ctime>
 
@@ -112,6 +115,62 @@ OS::file_size(char const* pathname)
 
 /* ---------------------------------------------------------------- */
 
+time_t
+OS::file_mtime(char const* pathname)
+{
+  struct stat filestats;
+  if (::stat(pathname, &filestats) < 0)
+    return 0;
+  return filestats.st_mtime;
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+OS::rename(char const* oldpath, char const* newpath)
+{
+  if (::rename(oldpath, newpath) < 0)
+    return false;
+
+  return true;
+}
+
+/* ---------------------------------------------------------------- */
+
+void*
+OS::map_file(char const* pathname, std::size_t* size)
+{
+  int fd = ::open(pathname, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  struct stat filestats;
+  if (::fstat(fd, &filestats) < 0 || filestats.st_size <= 0)
+  {
+    ::close(fd);
+    return 0;
+  }
+
+  *size = static_cast<std::size_t>(filestats.st_size);
+  void* data = ::mmap(0, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+
+  if (data == MAP_FAILED)
+    return 0;
+
+  return data;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+OS::unmap_file(void* data, std::size_t size)
+{
+  ::munmap(data, size);
+}
+
+/* ---------------------------------------------------------------- */
+
 char*
 OS::strptime(const char *buf, const char *fmt, struct tm *tm)
 {
@@ -137,3 +196,14 @@ OS::execv (char const* path, char* const argv[])
 {
     return ::execv(path, argv);
 }
+
+/* ---------------------------------------------------------------- */
+
+unsigned int
+OS::get_num_processors(void)
+{
+  long num = ::sysconf(_SC_NPROCESSORS_ONLN);
+  if (num < 1)
+    return 1;
+  return static_cast<unsigned int>(num);
+}
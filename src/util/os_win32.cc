@@ -112,6 +112,64 @@ OS::file_size(char const* pathname)
 
 /* ---------------------------------------------------------------- */
 
+time_t
+OS::file_mtime(char const* pathname)
+{
+  struct _stat filestats;
+  if (::_stat(pathname, &filestats) < 0)
+    return 0;
+  return filestats.st_mtime;
+}
+
+/* ---------------------------------------------------------------- */
+
+bool
+OS::rename(char const* oldpath, char const* newpath)
+{
+  return ::MoveFileExA(oldpath, newpath, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+void*
+OS::map_file(char const* pathname, std::size_t* size)
+{
+  HANDLE file = ::CreateFileA(pathname, GENERIC_READ, FILE_SHARE_READ
+      | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE)
+    return 0;
+
+  DWORD file_size = ::GetFileSize(file, 0);
+  if (file_size == INVALID_FILE_SIZE || file_size == 0)
+  {
+    ::CloseHandle(file);
+    return 0;
+  }
+
+  HANDLE mapping = ::CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+  ::CloseHandle(file);
+  if (mapping == 0)
+    return 0;
+
+  void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  ::CloseHandle(mapping);
+  if (data == 0)
+    return 0;
+
+  *size = static_cast<std::size_t>(file_size);
+  return data;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+OS::unmap_file(void* data, std::size_t /*size*/)
+{
+  ::UnmapViewOfFile(data);
+}
+
+/* ---------------------------------------------------------------- */
+
 char*
 OS::strptime(const char *buf, const char *fmt, struct tm *tm)
 {
@@ -134,3 +192,14 @@ OS::execv(char const* path, char* const argv[])
     return ::_execv(path, argv);
 }
 
+/* ---------------------------------------------------------------- */
+
+unsigned int
+OS::get_num_processors(void)
+{
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  if (info.dwNumberOfProcessors < 1)
+    return 1;
+  return static_cast<unsigned int>(info.dwNumberOfProcessors);
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <iterator>
+#include <glibmm/ustring.h>
+
+#include "searchindex.h"
+
+/* The longest substrings that are indexed. */
+#define SEARCH_INDEX_MAX_GRAM 3
+
+void
+SearchIndex::clear (void)
+{
+  this->texts.clear();
+  this->ids.clear();
+  this->grams.clear();
+}
+
+/* ---------------------------------------------------------------- */
+
+unsigned int
+SearchIndex::get_gram_key (std::string const& str,
+    std::size_t pos, std::size_t len)
+{
+  /* The length is part of the key to separate short grams. */
+  unsigned int key = (unsigned int)len;
+  for (std::size_t i = 0; i < SEARCH_INDEX_MAX_GRAM; ++i)
+  {
+    key <<= 8;
+    if (i < len)
+      key |= (unsigned int)(unsigned char)str[pos + i];
+  }
+  return key;
+}
+
+/* ---------------------------------------------------------------- */
+
+SearchIndex::PositionList const*
+SearchIndex::get_positions (std::string const& str,
+    std::size_t pos, std::size_t len) const
+{
+  GramMap::const_iterator iter = this->grams.find
+      (SearchIndex::get_gram_key(str, pos, len));
+  if (iter == this->grams.end())
+    return 0;
+  return &iter->second;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+SearchIndex::add (int id, std::string const& text)
+{
+  std::size_t position = this->texts.size();
+  this->texts.push_back(SearchIndex::fold(text));
+  this->ids.push_back(id);
+
+  std::string const& folded = this->texts.back();
+  for (std::size_t i = 0; i < folded.size(); ++i)
+    for (std::size_t len = 1; len <= SEARCH_INDEX_MAX_GRAM
+        && i + len <= folded.size(); ++len)
+    {
+      PositionList& list = this->grams[SearchIndex::get_gram_key
+          (folded, i, len)];
+      if (list.empty() || list.back() != position)
+        list.push_back(position);
+    }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+SearchIndex::find (std::string const& filter, std::set<int>& result) const
+{
+  std::string folded = SearchIndex::fold(filter);
+
+  if (folded.empty())
+  {
+    result.insert(this->ids.begin(), this->ids.end());
+    return;
+  }
+
+  /* Short filters are indexed directly. */
+  if (folded.size() <= SEARCH_INDEX_MAX_GRAM)
+  {
+    PositionList const* list = this->get_positions(folded, 0, folded.size());
+    if (list == 0)
+      return;
+    for (std::size_t i = 0; i < list->size(); ++i)
+      result.insert(this->ids[(*list)[i]]);
+    return;
+  }
+
+  /* Collect the lists for all trigrams, starting with the shortest. */
+  std::vector<PositionList const*> lists;
+  for (std::size_t i = 0; i + SEARCH_INDEX_MAX_GRAM <= folded.size(); ++i)
+  {
+    PositionList const* list = this->get_positions
+        (folded, i, SEARCH_INDEX_MAX_GRAM);
+    if (list == 0)
+      return;
+
+    lists.push_back(list);
+    if (list->size() < lists.front()->size())
+      std::swap(lists.front(), lists.back());
+  }
+
+  PositionList candidates(*lists.front());
+  for (std::size_t i = 1; i < lists.size() && !candidates.empty(); ++i)
+  {
+    PositionList remaining;
+    std::set_intersection(candidates.begin(), candidates.end(),
+        lists[i]->begin(), lists[i]->end(), std::back_inserter(remaining));
+    candidates.swap(remaining);
+  }
+
+  /* The trigrams may appear at other offsets, check the candidates. */
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+    if (this->texts[candidates[i]].find(folded) != std::string::npos)
+      result.insert(this->ids[candidates[i]]);
+}
+
+/* ---------------------------------------------------------------- */
+
+std::string
+SearchIndex::fold (std::string const& str)
+{
+  return Glib::ustring(str).casefold();
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEARCH_INDEX_HEADER
+#define SEARCH_INDEX_HEADER
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+/*
+ * Case insensitive substring search over a fixed set of texts. The texts
+ * are case folded once when they are added. Every substring of up to three
+ * bytes is mapped to the sorted list of texts containing it. Short filters
+ * are answered with a single lookup, longer filters intersect the lists of
+ * their trigrams and only the remaining candidates are compared.
+ */
+class SearchIndex
+{
+  private:
+    typedef std::vector<std::size_t> PositionList;
+    typedef std::map<unsigned int, PositionList> GramMap;
+
+    std::vector<std::string> texts;
+    std::vector<int> ids;
+    GramMap grams;
+
+  protected:
+    static unsigned int get_gram_key (std::string const& str,
+        std::size_t pos, std::size_t len);
+    PositionList const* get_positions (std::string const& str,
+        std::size_t pos, std::size_t len) const;
+
+  public:
+    void clear (void);
+    /* Adds a text that is reported with the given ID. */
+    void add (int id, std::string const& text);
+    std::size_t size (void) const;
+
+    /* Inserts the IDs of all texts that contain the filter. */
+    void find (std::string const& filter, std::set<int>& result) const;
+
+    /* Returns the case folded string as it is used for searching. */
+    static std::string fold (std::string const& str);
+};
+
+/* ---------------------------------------------------------------- */
+
+inline std::size_t
+SearchIndex::size (void) const
+{
+  return this->texts.size();
+}
+
+#endif /* SEARCH_INDEX_HEADER */
@@ -0,0 +1,171 @@
+#include <cstring>
+
+#include "os.h"
+#include "helpers.h"
+#include "exception.h"
+#include "snapshot.h"
+
+/* The first word of every snapshot. Reads "GMSN" in little endian. */
+#define SNAPSHOT_MAGIC 0x4e534d47
+/* Magic, version, source size, source time, sections and pool size. */
+#define SNAPSHOT_HEADER_WORDS 6
+
+void
+SnapshotWriter::add (std::size_t section, uint32_t const* values,
+    std::size_t size)
+{
+  this->sections[section].insert(this->sections[section].end(),
+      values, values + size);
+}
+
+/* ---------------------------------------------------------------- */
+
+uint32_t
+SnapshotWriter::add_string (std::string const& str)
+{
+  uint32_t offset = (uint32_t)this->pool.size();
+  this->pool.append(str.c_str(), str.size() + 1);
+  return offset;
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+SnapshotWriter::write (std::string const& filename,
+    std::string const& source, uint32_t version) const
+{
+  std::vector<uint32_t> words;
+  words.push_back(SNAPSHOT_MAGIC);
+  words.push_back(version);
+  words.push_back((uint32_t)OS::file_size(source.c_str()));
+  words.push_back((uint32_t)OS::file_mtime(source.c_str()));
+  words.push_back((uint32_t)this->sections.size());
+  words.push_back((uint32_t)this->pool.size());
+
+  /* The section table holds the offset and size of every section. */
+  std::size_t offset = words.size() + 2 * this->sections.size();
+  for (std::size_t i = 0; i < this->sections.size(); ++i)
+  {
+    words.push_back((uint32_t)offset);
+    words.push_back((uint32_t)this->sections[i].size());
+    offset += this->sections[i].size();
+  }
+
+  for (std::size_t i = 0; i < this->sections.size(); ++i)
+    words.insert(words.end(), this->sections[i].begin(),
+        this->sections[i].end());
+
+  std::string data;
+  data.reserve(words.size() * sizeof(uint32_t) + this->pool.size());
+  data.append((char const*)&words[0], words.size() * sizeof(uint32_t));
+  data.append(this->pool);
+
+  std::string tmp_filename = filename + ".tmp";
+  Helpers::write_file(tmp_filename, data);
+  if (!OS::rename(tmp_filename.c_str(), filename.c_str()))
+  {
+    OS::unlink(tmp_filename.c_str());
+    throw FileException(filename, "Cannot replace snapshot");
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+Snapshot::open (std::string const& filename, std::string const& source,
+    uint32_t version, std::size_t sections)
+{
+  this->close();
+
+  this->data = OS::map_file(filename.c_str(), &this->size);
+  if (this->data == 0)
+    throw FileException(filename, "Cannot map snapshot");
+
+  try
+  {
+    uint32_t const* words = (uint32_t const*)this->data;
+    std::size_t word_amount = this->size / sizeof(uint32_t);
+    std::size_t table_end = SNAPSHOT_HEADER_WORDS + 2 * sections;
+
+    if (word_amount < table_end || words[0] != SNAPSHOT_MAGIC
+        || words[1] != version || words[4] != sections)
+      throw FileException(filename, "Invalid snapshot version");
+
+    if (words[2] != (uint32_t)OS::file_size(source.c_str())
+        || words[3] != (uint32_t)OS::file_mtime(source.c_str()))
+      throw FileException(filename, "Snapshot is outdated");
+
+    /* Check that the sections and the pool are within the file. */
+    std::size_t offset = table_end;
+    this->table = words + SNAPSHOT_HEADER_WORDS;
+    for (std::size_t i = 0; i < sections; ++i)
+    {
+      if (this->table[2 * i] != offset
+          || this->table[2 * i + 1] > word_amount - offset)
+        throw FileException(filename, "Invalid snapshot section");
+      offset += this->table[2 * i + 1];
+    }
+
+    this->pool = (char const*)(words + offset);
+    this->pool_size = words[5];
+    if (this->pool_size != this->size - offset * sizeof(uint32_t)
+        || (this->pool_size > 0 && this->pool[this->pool_size - 1] != '\0'))
+      throw FileException(filename, "Invalid snapshot string pool");
+
+    this->section_amount = sections;
+  }
+  catch (...)
+  {
+    this->close();
+    throw;
+  }
+}
+
+/* ---------------------------------------------------------------- */
+
+void
+Snapshot::close (void)
+{
+  if (this->data != 0)
+    OS::unmap_file(this->data, this->size);
+
+  this->data = 0;
+  this->size = 0;
+  this->table = 0;
+  this->section_amount = 0;
+  this->pool = 0;
+  this->pool_size = 0;
+}
+
+/* ---------------------------------------------------------------- */
+
+uint32_t const*
+Snapshot::get_section (std::size_t section) const
+{
+  if (section >= this->section_amount)
+    throw Exception("Invalid snapshot section");
+
+  return (uint32_t const*)this->data + this->table[2 * section];
+}
+
+/* ---------------------------------------------------------------- */
+
+std::size_t
+Snapshot::get_section_size (std::size_t section) const
+{
+  if (section >= this->section_amount)
+    throw Exception("Invalid snapshot section");
+
+  return this->table[2 * section + 1];
+}
+
+/* ---------------------------------------------------------------- */
+
+char const*
+Snapshot::get_string (uint32_t offset) const
+{
+  if (offset >= this->pool_size)
+    throw Exception("Invalid snapshot string");
+
+  return this->pool + offset;
+}
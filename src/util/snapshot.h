@@ -0,0 +1,107 @@
+/*
+ * This file is part of GtkEveMon.
+ *
+ * GtkEveMon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GtkEveMon. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_HEADER
+#define SNAPSHOT_HEADER
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+ * Binary snapshots of parsed data files. A snapshot starts with a header
+ * that identifies the format version and the size and modification time
+ * of the source file it was created from. It is followed by sections of
+ * 32 bit words and a pool of NUL terminated strings, which are referenced
+ * by their offset into the pool. Snapshots are written in host byte order
+ * and are only meant as a local cache next to their source files.
+ */
+class SnapshotWriter
+{
+  private:
+    std::vector<std::vector<uint32_t> > sections;
+    std::string pool;
+
+  public:
+    SnapshotWriter (std::size_t section_amount);
+
+    void add (std::size_t section, uint32_t value);
+    void add (std::size_t section, uint32_t const* values, std::size_t size);
+    /* Adds a string to the pool and returns its offset. */
+    uint32_t add_string (std::string const& str);
+
+    /* Writes the snapshot for the given source file. The file is written
+     * to a temporary file first, so readers never see partial files. */
+    void write (std::string const& filename, std::string const& source,
+        uint32_t version) const;
+};
+
+/* ---------------------------------------------------------------- */
+
+/*
+ * A snapshot that is mapped into memory. The sections and strings are
+ * used in place and are valid as long as the snapshot is open.
+ */
+class Snapshot
+{
+  private:
+    void* data;
+    std::size_t size;
+    uint32_t const* table;
+    std::size_t section_amount;
+    char const* pool;
+    std::size_t pool_size;
+
+  public:
+    Snapshot (void);
+    ~Snapshot (void);
+
+    /* Maps the snapshot for the given source file. An exception is thrown
+     * if the snapshot is missing, malformed or was not created from the
+     * current source file with the given version. */
+    void open (std::string const& filename, std::string const& source,
+        uint32_t version, std::size_t sections);
+    void close (void);
+
+    /* Returns the section and its size in words. */
+    uint32_t const* get_section (std::size_t section) const;
+    std::size_t get_section_size (std::size_t section) const;
+    char const* get_string (uint32_t offset) const;
+};
+
+/* ---------------------------------------------------------------- */
+
+inline
+SnapshotWriter::SnapshotWriter (std::size_t section_amount)
+  : sections(section_amount)
+{
+}
+
+inline void
+SnapshotWriter::add (std::size_t section, uint32_t value)
+{
+  this->sections[section].push_back(value);
+}
+
+inline
+Snapshot::Snapshot (void)
+  : data(0), size(0), table(0), section_amount(0), pool(0), pool_size(0)
+{
+}
+
+inline
+Snapshot::~Snapshot (void)
+{
+  this->close();
+}
+
+#endif /* SNAPSHOT_HEADER */